@@ -0,0 +1,496 @@
+// Benchmarks for the scanner, the occurrence lists, gate propagation and the random simulation.
+//
+// Usage: gatekit-bench [--repetitions N] [--size N] [--rounds N] [--threads N] [FILE.cnf ...]
+//
+// Without files, the benchmarks are run on synthetic circuit CNF instances
+// with `--size` gates. Each measurement is printed as a single-line JSON
+// object (JSON Lines), with the median and minimum time over all repetitions.
+// The set of keys and their order are fixed, so results of different versions
+// can be compared with line-based tools.
+
+#include <gatekit/clause_arena.h>
+#include <gatekit/dimacs.h>
+#include <gatekit/flat_gate_structure.h>
+#include <gatekit/random_simulation.h>
+#include <gatekit/scanner.h>
+
+#include <gatekit/detail/bitvector.h>
+#include <gatekit/detail/bitvector_prop.h>
+#include <gatekit/detail/csr_occurrence_list.h>
+#include <gatekit/detail/occurrence_list.h>
+#include <gatekit/detail/simulation_tape.h>
+
+#include "helpers/circuit_generator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef GATEKIT_VERSION
+#define GATEKIT_VERSION "unknown"
+#endif
+
+namespace {
+
+using gatekit::arena_clause;
+using gatekit::clause_arena;
+
+struct bench_config {
+  std::size_t num_repetitions = 5;
+  std::size_t num_gates = 100000;
+  uint64_t num_simulation_rounds = 2048 * 16;
+  std::size_t num_threads = 0; // 0: number of hardware threads
+  std::vector<std::string> files;
+};
+
+struct bench_input {
+  std::string name;
+  clause_arena clauses;
+};
+
+struct measurement {
+  double median_seconds;
+  double min_seconds;
+};
+
+// Written by the benchmarks to keep the compiler from optimizing them away
+uint64_t volatile sink = 0;
+
+
+// Runs `prepare` (untimed) and `benchmark` (timed) `config.num_repetitions` times
+auto measure(bench_config const& config,
+             std::function<void()> const& prepare,
+             std::function<void()> const& benchmark) -> measurement
+{
+  std::vector<double> seconds;
+
+  for (std::size_t rep = 0; rep < config.num_repetitions; ++rep) {
+    prepare();
+
+    auto const start = std::chrono::steady_clock::now();
+    benchmark();
+    auto const stop = std::chrono::steady_clock::now();
+    seconds.push_back(std::chrono::duration<double>(stop - start).count());
+  }
+
+  std::sort(seconds.begin(), seconds.end());
+
+  measurement result;
+  result.median_seconds = seconds[seconds.size() / 2];
+  result.min_seconds = seconds.front();
+  return result;
+}
+
+auto measure(bench_config const& config, std::function<void()> const& benchmark) -> measurement
+{
+  return measure(config, []() {}, benchmark);
+}
+
+auto escape_json(std::string const& str) -> std::string
+{
+  std::string result;
+  for (char chr : str) {
+    if (chr == '"' || chr == '\\') {
+      result += '\\';
+    }
+    result += chr;
+  }
+  return result;
+}
+
+void report(std::string const& benchmark,
+            std::string const& variant,
+            bench_input const& input,
+            measurement const& result,
+            double num_items,
+            std::string const& unit,
+            bench_config const& config)
+{
+  std::cout << "{\"version\": \"" << GATEKIT_VERSION << "\""
+            << ", \"benchmark\": \"" << benchmark << "\""
+            << ", \"variant\": \"" << variant << "\""
+            << ", \"input\": \"" << escape_json(input.name) << "\""
+            << ", \"num_clauses\": " << input.clauses.size()
+            << ", \"repetitions\": " << config.num_repetitions
+            << ", \"median_s\": " << result.median_seconds
+            << ", \"min_s\": " << result.min_seconds
+            << ", \"throughput\": " << num_items / result.median_seconds
+            << ", \"unit\": \"" << unit << "\"}" << std::endl;
+}
+
+
+template <typename OccList>
+void bench_occurrence_list(std::string const& variant,
+                           bench_input const& input,
+                           std::vector<arena_clause> const& handles,
+                           bench_config const& config)
+{
+  using lit = typename OccList::lit;
+
+  measurement const build = measure(config, [&handles]() {
+    OccList occs{handles.begin(), handles.end()};
+    sink = sink + occs.get_max_lit_index();
+  });
+  report("occurrence_list_build",
+         variant,
+         input,
+         build,
+         static_cast<double>(handles.size()),
+         "clauses/s",
+         config);
+
+  // Removing the clauses of every other variable, like the scanner does for
+  // gate outputs, and then accessing all literals to trigger the erasure
+  std::unique_ptr<OccList> occs;
+  measurement const erase = measure(
+      config,
+      [&handles, &occs]() { occs.reset(new OccList{handles.begin(), handles.end()}); },
+      [&occs]() {
+        std::size_t const max_index = occs->get_max_lit_index();
+        for (std::size_t index = 0; index <= max_index; index += 4) {
+          occs->remove_gate_root(gatekit::detail::to_lit<lit>(index / 2, true));
+        }
+
+        std::size_t num_occurrences = 0;
+        for (std::size_t index = 0; index <= max_index; ++index) {
+          num_occurrences +=
+              (*occs)[gatekit::detail::to_lit<lit>(index / 2, index % 2 == 0)].size();
+        }
+        sink = sink + num_occurrences;
+      });
+  report("occurrence_list_erase",
+         variant,
+         input,
+         erase,
+         static_cast<double>(handles.size()),
+         "clauses/s",
+         config);
+}
+
+void bench_scanner(bench_input const& input, bench_config const& config)
+{
+  struct layout_variant {
+    char const* name;
+    gatekit::occurrence_list_layout layout;
+  };
+
+  layout_variant const variants[] = {{"per_literal", gatekit::occurrence_list_layout::per_literal},
+                                     {"compressed", gatekit::occurrence_list_layout::compressed}};
+
+  for (layout_variant const& variant : variants) {
+    gatekit::scan_options options;
+    options.layout = variant.layout;
+
+    measurement const result = measure(config, [&input, &options]() {
+      gatekit::scan_result<arena_clause> const scanned = gatekit::scan_gates<arena_clause>(
+          input.clauses.begin(), input.clauses.end(), options);
+      sink = sink + scanned.structure.gates.size();
+    });
+
+    report("scan_gates",
+           variant.name,
+           input,
+           result,
+           static_cast<double>(input.clauses.size()),
+           "clauses/s",
+           config);
+  }
+}
+
+// random_simulation() simulates rounds in batches of `width`
+auto get_num_simulated_evaluations(std::size_t num_gates,
+                                   bench_config const& config,
+                                   std::size_t width) -> double
+{
+  uint64_t const num_rounds = (config.num_simulation_rounds + width - 1) / width * width;
+  return static_cast<double>(num_gates) * static_cast<double>(num_rounds);
+}
+
+template <std::size_t Width>
+void bench_random_simulation_width(bench_input const& input,
+                                   gatekit::flat_gate_structure<arena_clause> const& structure,
+                                   bench_config const& config)
+{
+  measurement const result = measure(config, [&structure, &config]() {
+    auto const partitions =
+        gatekit::random_simulation<Width>(structure, config.num_simulation_rounds);
+    sink = sink + partitions.backbones.size();
+  });
+
+  report("random_simulation_width",
+         "width_" + std::to_string(Width),
+         input,
+         result,
+         get_num_simulated_evaluations(structure.gates.size(), config, Width),
+         "gate_evaluations/s",
+         config);
+}
+
+// Compares random_simulation_parallel() with different numbers of threads,
+// starting with a single thread. Speedups require at least as many cores as
+// threads, and levels with many gates.
+void bench_random_simulation_threads(bench_input const& input,
+                                     gatekit::flat_gate_structure<arena_clause> const& structure,
+                                     bench_config const& config)
+{
+  double const num_evaluations = get_num_simulated_evaluations(
+      structure.gates.size(), config, gatekit::detail::default_simulation_width);
+
+  for (std::size_t num_threads : {1, 2, 4, 8}) {
+    measurement const result = measure(config, [&structure, &config, num_threads]() {
+      auto const partitions = gatekit::random_simulation_parallel(
+          structure, config.num_simulation_rounds, num_threads);
+      sink = sink + partitions.backbones.size();
+    });
+
+    report("random_simulation_threads",
+           "threads_" + std::to_string(num_threads),
+           input,
+           result,
+           num_evaluations,
+           "gate_evaluations/s",
+           config);
+  }
+}
+
+void bench_random_simulation(bench_input const& input, bench_config const& config)
+{
+  gatekit::gate_structure<arena_clause> const structure =
+      gatekit::scan_gates<arena_clause>(input.clauses.begin(), input.clauses.end());
+
+  gatekit::flat_gate_structure<arena_clause> const flat_structure = gatekit::flatten(structure);
+
+  measurement const result = measure(config, [&structure, &config]() {
+    auto const partitions = gatekit::random_simulation(structure, config.num_simulation_rounds);
+    sink = sink + partitions.backbones.size();
+  });
+
+  measurement const flat_result = measure(config, [&flat_structure, &config]() {
+    auto const partitions =
+        gatekit::random_simulation(flat_structure, config.num_simulation_rounds);
+    sink = sink + partitions.backbones.size();
+  });
+
+  measurement const parallel_result = measure(config, [&flat_structure, &config]() {
+    auto const partitions = gatekit::random_simulation_parallel(
+        flat_structure, config.num_simulation_rounds, config.num_threads);
+    sink = sink + partitions.backbones.size();
+  });
+
+  double const num_evaluations = get_num_simulated_evaluations(
+      structure.gates.size(), config, gatekit::detail::default_simulation_width);
+
+  report("random_simulation",
+         "default",
+         input,
+         result,
+         num_evaluations,
+         "gate_evaluations/s",
+         config);
+  report("random_simulation",
+         "flat",
+         input,
+         flat_result,
+         num_evaluations,
+         "gate_evaluations/s",
+         config);
+  report("random_simulation",
+         "flat_parallel",
+         input,
+         parallel_result,
+         num_evaluations,
+         "gate_evaluations/s",
+         config);
+
+  // Narrow bitvectors keep the assignments of large structures in the caches,
+  // while wide ones amortize the per-gate overhead on small structures
+  bench_random_simulation_width<512>(input, flat_structure, config);
+  bench_random_simulation_width<1024>(input, flat_structure, config);
+  bench_random_simulation_width<2048>(input, flat_structure, config);
+  bench_random_simulation_width<4096>(input, flat_structure, config);
+  bench_random_simulation_width<8192>(input, flat_structure, config);
+
+  bench_random_simulation_threads(input, flat_structure, config);
+}
+
+void bench_propagation(bench_input const& input, bench_config const& config)
+{
+  gatekit::gate_structure<arena_clause> const structure =
+      gatekit::scan_gates<arena_clause>(input.clauses.begin(), input.clauses.end());
+
+  std::size_t const num_rounds = 16;
+  gatekit::detail::bitvector_map assignment{gatekit::max_var_index(structure) + 1};
+
+  measurement const structure_result = measure(config, [&structure, &assignment]() {
+    for (std::size_t round = 0; round < num_rounds; ++round) {
+      gatekit::detail::propagate_structure(assignment, structure);
+    }
+    sink = sink + assignment[0].get_words()[0];
+  });
+
+  std::unique_ptr<gatekit::detail::simulation_tape> tape;
+  measurement const tape_result = measure(
+      config,
+      [&structure, &tape]() { tape.reset(new gatekit::detail::simulation_tape{structure}); },
+      [&tape, &assignment]() {
+        for (std::size_t round = 0; round < num_rounds; ++round) {
+          gatekit::detail::run_tape(assignment, *tape);
+        }
+        sink = sink + assignment[0].get_words()[0];
+      });
+
+  measurement const compile_result = measure(config, [&structure]() {
+    gatekit::detail::simulation_tape const compiled{structure};
+    sink = sink + compiled.num_gates();
+  });
+
+  double const num_evaluations = static_cast<double>(structure.gates.size()) *
+                                 static_cast<double>(num_rounds) *
+                                 gatekit::detail::default_simulation_width;
+
+  report("propagation",
+         "structure",
+         input,
+         structure_result,
+         num_evaluations,
+         "gate_evaluations/s",
+         config);
+  report("propagation", "tape", input, tape_result, num_evaluations, "gate_evaluations/s", config);
+  report("propagation",
+         "tape_compile",
+         input,
+         compile_result,
+         static_cast<double>(structure.gates.size()),
+         "gates/s",
+         config);
+}
+
+void run_benchmarks(bench_input const& input, bench_config const& config)
+{
+  std::vector<arena_clause> const handles = input.clauses.get_handles();
+
+  bench_occurrence_list<gatekit::detail::occurrence_list<arena_clause>>(
+      "per_literal", input, handles, config);
+  bench_occurrence_list<gatekit::detail::csr_occurrence_list<arena_clause>>(
+      "compressed", input, handles, config);
+  bench_scanner(input, config);
+  bench_propagation(input, config);
+  bench_random_simulation(input, config);
+}
+
+
+auto parse_count(char const* arg) -> uint64_t
+{
+  char* end = nullptr;
+  unsigned long long const result = std::strtoull(arg, &end, 10);
+  if (end == arg || *end != '\0' || result == 0) {
+    throw std::invalid_argument{std::string{"invalid count: "} + arg};
+  }
+  return result;
+}
+
+auto parse_config(int argc, char** argv) -> bench_config
+{
+  bench_config result;
+
+  for (int idx = 1; idx < argc; ++idx) {
+    std::string const arg = argv[idx];
+
+    if (arg == "--repetitions" || arg == "--size" || arg == "--rounds" || arg == "--threads") {
+      if (idx + 1 == argc) {
+        throw std::invalid_argument{"missing value for " + arg};
+      }
+
+      uint64_t const value = parse_count(argv[++idx]);
+      if (arg == "--repetitions") {
+        result.num_repetitions = static_cast<std::size_t>(value);
+      }
+      else if (arg == "--size") {
+        result.num_gates = static_cast<std::size_t>(value);
+      }
+      else if (arg == "--threads") {
+        result.num_threads = static_cast<std::size_t>(value);
+      }
+      else {
+        result.num_simulation_rounds = value;
+      }
+    }
+    else if (!arg.empty() && arg[0] == '-') {
+      throw std::invalid_argument{"unknown option: " + arg};
+    }
+    else {
+      result.files.push_back(arg);
+    }
+  }
+
+  return result;
+}
+
+}
+
+
+auto main(int argc, char** argv) -> int
+{
+  bench_config config;
+
+  try {
+    config = parse_config(argc, argv);
+  }
+  catch (std::exception const& error) {
+    std::cerr << "Error: " << error.what() << "\n"
+              << "Usage: " << argv[0]
+              << " [--repetitions N] [--size N] [--rounds N] [--threads N] [FILE.cnf ...]\n";
+    return EXIT_FAILURE;
+  }
+
+  try {
+    if (config.files.empty()) {
+      std::size_t const num_gates = config.num_gates;
+
+      // An n-bit multiplier miter has roughly 16 n^2 gates
+      std::size_t const num_multiplier_bits =
+          std::max<std::size_t>(2, static_cast<std::size_t>(std::sqrt(num_gates / 16.0)));
+
+      bench_input random_aig;
+      random_aig.name = "synthetic:random_aig:" + std::to_string(num_gates);
+      std::size_t const num_aig_inputs = std::max<std::size_t>(num_gates / 8, 2);
+      random_aig.clauses =
+          gatekit::random_aig(num_gates, num_aig_inputs, 1, gatekit::encoding::full).clauses;
+      run_benchmarks(random_aig, config);
+
+      bench_input miter;
+      miter.name = "synthetic:multiplier_miter:" + std::to_string(num_multiplier_bits);
+      miter.clauses =
+          gatekit::multiplier_miter(num_multiplier_bits, gatekit::encoding::full).clauses;
+      run_benchmarks(miter, config);
+
+      bench_input xor_tree;
+      xor_tree.name = "synthetic:xor_tree:" + std::to_string(num_gates + 1);
+      xor_tree.clauses = gatekit::xor_tree(num_gates + 1, gatekit::encoding::full).clauses;
+      run_benchmarks(xor_tree, config);
+    }
+
+    for (std::string const& file : config.files) {
+      bench_input input;
+      input.name = file;
+      input.clauses = gatekit::read_dimacs(file);
+      run_benchmarks(input, config);
+    }
+  }
+  catch (std::exception const& error) {
+    std::cerr << "Error: " << error.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
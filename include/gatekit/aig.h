@@ -0,0 +1,343 @@
+/**
+ * \file
+ *
+ * \brief And-Inverter Graphs with structural hashing, and conversion of gate
+ *        structures to AIGs
+ */
+
+#pragma once
+
+#include <gatekit/flat_gate_structure.h>
+#include <gatekit/gate.h>
+
+#include <gatekit/detail/clause_utils.h>
+#include <gatekit/detail/utils.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gatekit {
+
+/**
+ * Literal of an AIG node. Like in the AIGER format, `2*n` denotes the
+ * node with index `n` and `2*n + 1` its negation. Node 0 is the constant
+ * false node.
+ */
+using aig_lit = uint32_t;
+
+constexpr aig_lit aig_false = 0;
+constexpr aig_lit aig_true = 1;
+
+/**
+ * Placeholder for variables that are not represented in an AIG.
+ */
+constexpr aig_lit aig_undefined = std::numeric_limits<aig_lit>::max();
+
+inline auto aig_negate(aig_lit lit) noexcept -> aig_lit
+{
+  return lit ^ 1;
+}
+
+inline auto aig_node_index(aig_lit lit) noexcept -> std::size_t
+{
+  return lit >> 1;
+}
+
+inline auto aig_is_negated(aig_lit lit) noexcept -> bool
+{
+  return (lit & 1) != 0;
+}
+
+
+/**
+ * \brief And-Inverter Graph with structural hashing
+ *
+ * The graph consists of the constant false node, input nodes and AND nodes.
+ * AND nodes can only be created from existing literals, so the nodes are
+ * always in topological order. Adding an AND node that is equal to an
+ * existing node modulo operand order returns the existing node, and trivial
+ * conjunctions like `x & x`, `x & -x` or `x & true` are simplified.
+ */
+class aig {
+public:
+  struct and_node {
+    aig_lit lhs;
+    aig_lit rhs;
+  };
+
+  aig() { m_nodes.push_back(and_node{aig_false, aig_false}); }
+
+  auto add_input() -> aig_lit
+  {
+    aig_lit const result = next_lit();
+    m_nodes.push_back(and_node{aig_false, aig_false});
+    m_inputs.push_back(result);
+    return result;
+  }
+
+  auto add_and(aig_lit lhs, aig_lit rhs) -> aig_lit
+  {
+    assert(aig_node_index(lhs) < m_nodes.size() && aig_node_index(rhs) < m_nodes.size());
+
+    if (lhs < rhs) {
+      std::swap(lhs, rhs);
+    }
+
+    if (rhs == aig_false || lhs == aig_negate(rhs)) {
+      return aig_false;
+    }
+
+    if (rhs == aig_true || lhs == rhs) {
+      return lhs;
+    }
+
+    uint64_t const key = (static_cast<uint64_t>(lhs) << 32) | rhs;
+    auto const existing = m_strash.find(key);
+    if (existing != m_strash.end()) {
+      return existing->second;
+    }
+
+    aig_lit const result = next_lit();
+    m_nodes.push_back(and_node{lhs, rhs});
+    m_strash.emplace(key, result);
+    ++m_num_ands;
+    return result;
+  }
+
+  auto add_or(aig_lit lhs, aig_lit rhs) -> aig_lit
+  {
+    return aig_negate(add_and(aig_negate(lhs), aig_negate(rhs)));
+  }
+
+  /**
+   * Returns the conjunction of the given literals, or `aig_true` if
+   * `operands` is empty. The operands are sorted and deduplicated, so
+   * conjunctions of the same literals share their nodes.
+   */
+  auto add_and(std::vector<aig_lit>& operands) -> aig_lit
+  {
+    std::sort(operands.begin(), operands.end());
+    operands.erase(std::unique(operands.begin(), operands.end()), operands.end());
+
+    aig_lit result = aig_true;
+    for (aig_lit operand : operands) {
+      result = add_and(result, operand);
+    }
+    return result;
+  }
+
+  void add_output(aig_lit lit)
+  {
+    assert(aig_node_index(lit) < m_nodes.size());
+    m_outputs.push_back(lit);
+  }
+
+  /**
+   * Returns the number of nodes, including the constant node.
+   */
+  auto num_nodes() const noexcept -> std::size_t { return m_nodes.size(); }
+
+  auto num_ands() const noexcept -> std::size_t { return m_num_ands; }
+
+  auto is_and(std::size_t node_index) const noexcept -> bool
+  {
+    // Since trivial conjunctions are simplified, only the constant and input
+    // nodes have equal operands
+    return m_nodes[node_index].lhs != m_nodes[node_index].rhs;
+  }
+
+  /**
+   * Returns the operands of the given AND node, with `lhs >= rhs`.
+   */
+  auto get_and(std::size_t node_index) const noexcept -> and_node const&
+  {
+    assert(is_and(node_index));
+    return m_nodes[node_index];
+  }
+
+  /**
+   * Returns the literals of the input nodes, in the order of creation.
+   */
+  auto get_inputs() const noexcept -> std::vector<aig_lit> const& { return m_inputs; }
+
+  auto get_outputs() const noexcept -> std::vector<aig_lit> const& { return m_outputs; }
+
+private:
+  auto next_lit() const noexcept -> aig_lit
+  {
+    assert(m_nodes.size() < (std::size_t{1} << 31));
+    return static_cast<aig_lit>(2 * m_nodes.size());
+  }
+
+  std::vector<and_node> m_nodes;
+  std::vector<aig_lit> m_inputs;
+  std::vector<aig_lit> m_outputs;
+  std::size_t m_num_ands = 0;
+
+  std::unordered_map<uint64_t, aig_lit> m_strash;
+};
+
+
+/**
+ * \brief AIG representation of a gate structure
+ */
+struct gate_structure_aig {
+  aig graph;
+
+  /**
+   * The AIG literal of each variable, indexed by variable index. Variables not
+   * occurring in the structure are mapped to `aig_undefined`.
+   */
+  std::vector<aig_lit> lits_by_var;
+
+  /**
+   * The index of the variable represented by the i-th input of `graph`.
+   */
+  std::vector<std::size_t> input_vars;
+};
+
+
+namespace detail {
+template <typename Gate>
+auto get_num_lits(Gate const& gate, bool fwd) -> std::size_t
+{
+  auto const begin = fwd ? gate.clauses.begin() : gate.clauses.begin() + gate.num_fwd_clauses;
+  auto const end = fwd ? gate.clauses.begin() + gate.num_fwd_clauses : gate.clauses.end();
+
+  std::size_t result = 0;
+  for (auto iter = begin; iter != end; ++iter) {
+    result += get_size(*iter);
+  }
+  return result;
+}
+
+template <typename Lit>
+auto get_or_add_var_lit(gate_structure_aig& target, Lit lit) -> aig_lit
+{
+  std::size_t const var = to_var_index(lit);
+  if (target.lits_by_var[var] == aig_undefined) {
+    target.lits_by_var[var] = target.graph.add_input();
+    target.input_vars.push_back(var);
+  }
+
+  aig_lit const var_lit = target.lits_by_var[var];
+  return is_positive(lit) ? var_lit : aig_negate(var_lit);
+}
+
+/**
+ * Adds the gate's function to `target.graph` and returns the AIG literal of
+ * the gate's output literal.
+ *
+ * Like propagate_gate(), this uses either the fwd or the bwd clauses, with the
+ * conjunction of the clauses' remaining literals defining the output: if the
+ * fwd clauses (containing the negated output) are used, the output literal is
+ * true iff all of them are satisfied by their other literals. If the bwd
+ * clauses are used, the output literal is false iff all of them are. Since
+ * the clauses define the gate's function, this covers all kinds of gates
+ * recognized by the scanner.
+ */
+template <typename Gate>
+auto add_gate_to_aig(gate_structure_aig& target, Gate const& gate, std::vector<aig_lit>& operands)
+    -> aig_lit
+{
+  std::size_t const out_var = to_var_index(gate.output);
+
+  // Choosing the clauses with fewer literals, since each literal costs at most
+  // one AND node
+  bool const use_fwd = gate.is_nested_monotonically ||
+                       get_num_lits(gate, true) <= get_num_lits(gate, false);
+
+  auto const begin = use_fwd ? gate.clauses.begin() : gate.clauses.begin() + gate.num_fwd_clauses;
+  auto const end = use_fwd ? gate.clauses.begin() + gate.num_fwd_clauses : gate.clauses.end();
+
+  std::vector<aig_lit> clause_lits;
+  for (auto iter = begin; iter != end; ++iter) {
+    operands.clear();
+    for (auto const& lit : iterate(*iter)) {
+      if (to_var_index(lit) != out_var) {
+        operands.push_back(aig_negate(get_or_add_var_lit(target, lit)));
+      }
+    }
+    clause_lits.push_back(aig_negate(target.graph.add_and(operands)));
+  }
+
+  aig_lit const conjunction = target.graph.add_and(clause_lits);
+  return use_fwd ? conjunction : aig_negate(conjunction);
+}
+
+template <typename Structure>
+auto structure_to_aig(Structure const& structure) -> gate_structure_aig
+{
+  using lit = typename Structure::lit;
+
+  std::size_t max_var = max_var_index(structure);
+  for (std::vector<lit> const& root : structure.roots) {
+    for (lit const& root_lit : root) {
+      max_var = std::max(max_var, to_var_index(root_lit));
+    }
+  }
+
+  gate_structure_aig result;
+  result.lits_by_var.assign(max_var + 1, aig_undefined);
+
+  // Creating the inputs of the structure first, in ascending order of their
+  // variables. Variables occurring only in the roots are added on demand.
+  for (std::size_t var : input_var_indices(structure)) {
+    get_or_add_var_lit(result, to_lit<lit>(var, true));
+  }
+
+  // Adding the gates in reverse topological order, so that the inputs of
+  // each gate have been added before
+  auto const& gates = structure.gates;
+  std::vector<aig_lit> operands;
+  for (std::size_t index = gates.size(); index > 0; --index) {
+    auto const& gate = gates[index - 1];
+    aig_lit const output = add_gate_to_aig(result, gate, operands);
+    result.lits_by_var[to_var_index(gate.output)] =
+        is_positive(gate.output) ? output : aig_negate(output);
+  }
+
+  // Each root clause becomes an output, being the disjunction of its literals
+  for (std::vector<lit> const& root : structure.roots) {
+    operands.clear();
+    for (lit const& root_lit : root) {
+      operands.push_back(aig_negate(get_or_add_var_lit(result, root_lit)));
+    }
+    result.graph.add_output(aig_negate(result.graph.add_and(operands)));
+  }
+
+  return result;
+}
+}
+
+
+/**
+ * \brief Converts the given gate structure to an And-Inverter Graph
+ *
+ * The inputs of the AIG are the structure's input variables, and the AIG has
+ * one output per root clause, being the disjunction of the clause's literals.
+ * Structurally equal logic, e.g. gates with the same function of the same
+ * inputs, is represented by a single node.
+ *
+ * Monotonically nested gates are converted like full gates whose output is
+ * defined by their fwd clauses, like for random_simulation().
+ */
+template <typename ClauseHandle>
+auto to_aig(gate_structure<ClauseHandle> const& structure) -> gate_structure_aig
+{
+  return detail::structure_to_aig(structure);
+}
+
+template <typename ClauseHandle>
+auto to_aig(flat_gate_structure<ClauseHandle> const& structure) -> gate_structure_aig
+{
+  return detail::structure_to_aig(structure);
+}
+
+}
@@ -0,0 +1,120 @@
+/**
+ * \file
+ *
+ * \brief Functions for writing And-Inverter Graphs in the binary AIGER format
+ */
+
+#pragma once
+
+#include <gatekit/aig.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gatekit {
+
+namespace detail {
+/**
+ * Writes `value` as an AIGER variable-length integer: 7 bits per byte,
+ * least significant group first, with the high bit set on all but the last
+ * byte.
+ */
+inline void write_aiger_delta(std::ostream& output, uint32_t value)
+{
+  char buffer[5];
+  std::size_t size = 0;
+
+  while (value >= 0x80) {
+    buffer[size++] = static_cast<char>((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  buffer[size++] = static_cast<char>(value);
+
+  output.write(buffer, static_cast<std::streamsize>(size));
+}
+}
+
+
+/**
+ * Writes the given AIG to `output` in the binary AIGER format, without
+ * latches.
+ *
+ * The format requires inputs to precede the AND nodes, so the nodes are
+ * renumbered: the i-th input of `graph` becomes AIGER variable `i + 1`, and
+ * the AND nodes follow in their order in `graph`. The AND nodes are written
+ * to the stream one by one, without buffering the encoded graph.
+ *
+ * \throws std::runtime_error if writing to `output` fails
+ */
+inline void write_aiger(std::ostream& output, aig const& graph)
+{
+  std::size_t const num_inputs = graph.get_inputs().size();
+  std::size_t const num_ands = graph.num_ands();
+
+  std::vector<aig_lit> aiger_lits(graph.num_nodes(), aig_false);
+  aig_lit next_lit = 2;
+  for (aig_lit input : graph.get_inputs()) {
+    aiger_lits[aig_node_index(input)] = next_lit;
+    next_lit += 2;
+  }
+  for (std::size_t node = 1; node < graph.num_nodes(); ++node) {
+    if (graph.is_and(node)) {
+      aiger_lits[node] = next_lit;
+      next_lit += 2;
+    }
+  }
+
+  auto const to_aiger = [&aiger_lits](aig_lit lit) -> aig_lit {
+    return aiger_lits[aig_node_index(lit)] | (lit & 1);
+  };
+
+  output << "aig " << (num_inputs + num_ands) << " " << num_inputs << " 0 "
+         << graph.get_outputs().size() << " " << num_ands << "\n";
+
+  for (aig_lit lit : graph.get_outputs()) {
+    output << to_aiger(lit) << "\n";
+  }
+
+  for (std::size_t node = 1; node < graph.num_nodes(); ++node) {
+    if (!graph.is_and(node)) {
+      continue;
+    }
+
+    aig::and_node const& operands = graph.get_and(node);
+    aig_lit rhs0 = to_aiger(operands.lhs);
+    aig_lit rhs1 = to_aiger(operands.rhs);
+    if (rhs0 < rhs1) {
+      std::swap(rhs0, rhs1);
+    }
+
+    aig_lit const lhs = aiger_lits[node];
+    detail::write_aiger_delta(output, lhs - rhs0);
+    detail::write_aiger_delta(output, rhs0 - rhs1);
+  }
+
+  if (!output) {
+    throw std::runtime_error{"failed to write AIGER output"};
+  }
+}
+
+/**
+ * Writes the given AIG to the file at `path` in the binary AIGER format.
+ *
+ * \throws std::runtime_error if the file cannot be written
+ */
+inline void write_aiger(std::string const& path, aig const& graph)
+{
+  std::ofstream output{path, std::ios::binary};
+  if (!output) {
+    throw std::runtime_error{"could not open " + path};
+  }
+  write_aiger(output, graph);
+}
+
+}
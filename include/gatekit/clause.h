@@ -13,6 +13,7 @@
 #pragma once
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <type_traits>
 #include <utility>
@@ -65,4 +66,89 @@ auto dimacs_to_lit(int dimacs_literal) -> Lit
   assert(dimacs_literal != 0);
   return dimacs_literal;
 }
+
+
+/**
+ * Functions mapping literals to the variable and literal indices used in
+ * gatekit. Variables are indexed from 0, and the literal index of a literal
+ * over variable `v` is `2*v` if the literal is positive, and `2*v + 1`
+ * otherwise.
+ *
+ * The default implementation converts literals via `lit_to_dimacs()` and
+ * `dimacs_to_lit()`. Since these functions are used in all performance-critical
+ * parts of gatekit, clients with literal types that are not DIMACS-style
+ * integers should specialize this struct such that the functions map directly
+ * to native operations. For unsigned `2*v + sign` literals as used e.g. in
+ * MiniSat and CaDiCaL, `unsigned_lit_traits` can be used:
+ *
+ *     namespace gatekit {
+ *     template <>
+ *     struct lit_traits<uint32_t> : unsigned_lit_traits<uint32_t> {
+ *     };
+ *     }
+ *
+ * The specialization must be visible wherever gatekit functions are used with
+ * the literal type.
+ */
+template <typename Lit>
+struct lit_traits {
+  static auto to_index(Lit literal) -> std::size_t
+  {
+    int const dimacs_lit = lit_to_dimacs(literal);
+    if (dimacs_lit > 0) {
+      return 2 * (dimacs_lit - 1);
+    }
+    else {
+      return (-2 * (dimacs_lit + 1)) + 1;
+    }
+  }
+
+  static auto to_var_index(Lit literal) -> std::size_t
+  {
+    int const dimacs_lit = lit_to_dimacs(literal);
+    return (dimacs_lit > 0 ? dimacs_lit : -dimacs_lit) - 1;
+  }
+
+  static auto is_positive(Lit literal) -> bool { return lit_to_dimacs(literal) > 0; }
+
+  static auto negate(Lit literal) -> Lit { return dimacs_to_lit<Lit>(-lit_to_dimacs(literal)); }
+
+  static auto to_lit(std::size_t var_index, bool positive) -> Lit
+  {
+    return dimacs_to_lit<Lit>(static_cast<int>((var_index + 1) * (positive ? 1 : -1)));
+  }
+};
+
+
+/**
+ * Literal traits for unsigned literals encoding variable `v` as `2*v` (positive
+ * literal) and `2*v + 1` (negative literal). For these literals, the literal
+ * index is the literal itself.
+ */
+template <typename UnsignedLit>
+struct unsigned_lit_traits {
+  static_assert(std::is_unsigned<UnsignedLit>::value, "literal type must be unsigned");
+
+  static auto to_index(UnsignedLit literal) noexcept -> std::size_t
+  {
+    return static_cast<std::size_t>(literal);
+  }
+
+  static auto to_var_index(UnsignedLit literal) noexcept -> std::size_t
+  {
+    return static_cast<std::size_t>(literal >> 1);
+  }
+
+  static auto is_positive(UnsignedLit literal) noexcept -> bool { return (literal & 1) == 0; }
+
+  static auto negate(UnsignedLit literal) noexcept -> UnsignedLit
+  {
+    return literal ^ UnsignedLit{1};
+  }
+
+  static auto to_lit(std::size_t var_index, bool positive) noexcept -> UnsignedLit
+  {
+    return static_cast<UnsignedLit>(2 * var_index + (positive ? 0 : 1));
+  }
+};
 }
@@ -0,0 +1,212 @@
+/**
+ * \file
+ *
+ * \brief Contiguous clause storage with a compact clause handle type
+ */
+
+#pragma once
+
+#include <gatekit/clause.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace gatekit {
+
+/**
+ * \brief Handle for clauses stored in a clause_arena
+ *
+ * The handle is a single pointer to the clause in the arena, which stores the
+ * clause size directly followed by the clause's DIMACS-style literals.
+ */
+class arena_clause {
+public:
+  using iterator = int32_t const*;
+
+  arena_clause() = default;
+
+  explicit arena_clause(int32_t const* data) noexcept : m_data(data) {}
+
+  auto size() const noexcept -> std::size_t { return static_cast<std::size_t>(m_data[0]); }
+
+  auto begin() const noexcept -> iterator { return m_data + 1; }
+
+  auto end() const noexcept -> iterator { return m_data + 1 + m_data[0]; }
+
+  auto operator[](std::size_t index) const noexcept -> int32_t
+  {
+    assert(index < size());
+    return m_data[1 + index];
+  }
+
+  auto get_raw() const noexcept -> int32_t const* { return m_data; }
+
+  auto operator==(arena_clause const& rhs) const noexcept -> bool { return m_data == rhs.m_data; }
+
+  auto operator!=(arena_clause const& rhs) const noexcept -> bool { return m_data != rhs.m_data; }
+
+  auto operator<(arena_clause const& rhs) const noexcept -> bool
+  {
+    return std::less<int32_t const*>{}(m_data, rhs.m_data);
+  }
+
+private:
+  int32_t const* m_data = nullptr;
+};
+
+
+template <>
+struct clause_funcs<arena_clause> {
+  using lit = int32_t;
+  using size_type = std::size_t;
+
+  static auto get(arena_clause clause, size_type index) -> lit { return clause[index]; }
+
+  static auto iterate(arena_clause clause) -> arena_clause { return clause; }
+
+  static auto size(arena_clause clause) -> size_type { return clause.size(); }
+};
+
+
+/**
+ * \brief Stores clauses in a single contiguous block of memory
+ *
+ * Iterating over the arena yields `arena_clause` handles, which can be passed
+ * directly to `scan_gates()`. Handles are invalidated when clauses are added
+ * to the arena.
+ */
+class clause_arena {
+public:
+  class iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = arena_clause;
+    using difference_type = std::ptrdiff_t;
+    using pointer = arena_clause const*;
+    using reference = arena_clause;
+
+    iterator() = default;
+
+    explicit iterator(int32_t const* position) noexcept : m_position(position) {}
+
+    auto operator*() const noexcept -> arena_clause { return arena_clause{m_position}; }
+
+    auto operator++() noexcept -> iterator&
+    {
+      m_position += 1 + m_position[0];
+      return *this;
+    }
+
+    auto operator++(int) noexcept -> iterator
+    {
+      iterator result = *this;
+      ++(*this);
+      return result;
+    }
+
+    auto operator==(iterator const& rhs) const noexcept -> bool
+    {
+      return m_position == rhs.m_position;
+    }
+
+    auto operator!=(iterator const& rhs) const noexcept -> bool { return !(*this == rhs); }
+
+  private:
+    int32_t const* m_position = nullptr;
+  };
+
+  clause_arena() = default;
+
+  /**
+   * Creates an arena from memory laid out as the arena's internal representation:
+   * each clause is stored as its size, followed by its literals.
+   */
+  clause_arena(std::vector<int32_t>&& data, std::size_t num_clauses, std::size_t num_vars)
+    : m_data(std::move(data)), m_num_clauses(num_clauses), m_num_vars(num_vars)
+  {
+  }
+
+  template <typename LitIter>
+  void add_clause(LitIter begin, LitIter end)
+  {
+    std::size_t const size_index = m_data.size();
+    m_data.push_back(0);
+
+    for (LitIter lit = begin; lit != end; ++lit) {
+      int32_t const literal = *lit;
+      assert(literal != 0);
+
+      m_data.push_back(literal);
+      std::size_t const var = static_cast<std::size_t>(literal > 0 ? literal : -literal);
+      m_num_vars = var > m_num_vars ? var : m_num_vars;
+    }
+
+    m_data[size_index] = static_cast<int32_t>(m_data.size() - size_index - 1);
+    ++m_num_clauses;
+  }
+
+  void add_clause(std::initializer_list<int32_t> literals)
+  {
+    add_clause(literals.begin(), literals.end());
+  }
+
+  void reserve(std::size_t num_clauses, std::size_t num_literals)
+  {
+    m_data.reserve(num_clauses + num_literals);
+  }
+
+  auto begin() const noexcept -> iterator { return iterator{m_data.data()}; }
+
+  auto end() const noexcept -> iterator { return iterator{m_data.data() + m_data.size()}; }
+
+  /**
+   * Returns the number of clauses in the arena.
+   */
+  auto size() const noexcept -> std::size_t { return m_num_clauses; }
+
+  auto empty() const noexcept -> bool { return m_num_clauses == 0; }
+
+  /**
+   * Returns the maximum variable occurring in the arena, or the number of
+   * variables declared in the DIMACS header if that is larger.
+   */
+  auto get_num_vars() const noexcept -> std::size_t { return m_num_vars; }
+
+  /**
+   * Returns the handles of all clauses in the arena.
+   */
+  auto get_handles() const -> std::vector<arena_clause>
+  {
+    std::vector<arena_clause> result;
+    result.reserve(m_num_clauses);
+
+    for (arena_clause clause : *this) {
+      result.push_back(clause);
+    }
+
+    return result;
+  }
+
+private:
+  std::vector<int32_t> m_data;
+  std::size_t m_num_clauses = 0;
+  std::size_t m_num_vars = 0;
+};
+
+}
+
+namespace std {
+template <>
+struct hash<gatekit::arena_clause> {
+  auto operator()(gatekit::arena_clause const& to_hash) const noexcept -> std::size_t
+  {
+    return std::hash<int32_t const*>{}(to_hash.get_raw());
+  }
+};
+}
@@ -1,24 +1,51 @@
 #pragma once
 
+#include <gatekit/detail/bitvector_kernels.h>
 #include <gatekit/detail/utils.h>
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 
 namespace gatekit {
 namespace detail {
 
-class alignas(64) bitvector {
+/**
+ * Number of bits of the default bitvector type, ie. the number of assignments
+ * simulated at once by default
+ */
+constexpr std::size_t default_simulation_width = 2048;
+
+
+/**
+ * \brief Fixed-size bitvector of `Width` bits
+ *
+ * `Width` must be a positive multiple of 512, since the bitvector kernels
+ * process the words in groups of 8.
+ */
+template <std::size_t Width>
+class alignas(64) basic_bitvector {
 public:
+  static_assert(Width > 0 && Width % 512 == 0, "Width must be a positive multiple of 512");
+
+  static constexpr std::size_t width = Width;
+  static constexpr std::size_t num_words = Width / 64;
+
   using word_t = uint64_t;
-  using words_t = std::array<word_t, 32>;
+  using words_t = std::array<word_t, num_words>;
+
+  basic_bitvector() { fill(0ull); }
 
-  bitvector() { fill(0ull); }
+  // The non-assigning operators are plain loops rather than kernel calls:
+  // the compiler fuses such loops with the copy into the result, which is
+  // twice as fast as copying and calling a kernel. The assigning operators
+  // and invert() use the kernels and should be preferred in hot loops.
 
-  auto operator~() const noexcept -> bitvector
+  auto operator~() const noexcept -> basic_bitvector
   {
-    bitvector result;
+    basic_bitvector result;
     for (std::size_t idx = 0; idx < m_vars.size(); ++idx) {
       result.m_vars[idx] = ~m_vars[idx];
     }
@@ -26,69 +53,65 @@ public:
     return result;
   }
 
-  auto operator|(bitvector const& rhs) const noexcept -> bitvector
+  auto operator|(basic_bitvector const& rhs) const noexcept -> basic_bitvector
   {
-    bitvector result;
+    basic_bitvector result = *this;
     for (std::size_t idx = 0; idx < m_vars.size(); ++idx) {
-      result.m_vars[idx] = m_vars[idx] | rhs.m_vars[idx];
+      result.m_vars[idx] |= rhs.m_vars[idx];
     }
 
     return result;
   }
 
-  auto operator&(bitvector const& rhs) const noexcept -> bitvector
+  auto operator&(basic_bitvector const& rhs) const noexcept -> basic_bitvector
   {
-    bitvector result;
+    basic_bitvector result = *this;
     for (std::size_t idx = 0; idx < m_vars.size(); ++idx) {
-      result.m_vars[idx] = m_vars[idx] & rhs.m_vars[idx];
+      result.m_vars[idx] &= rhs.m_vars[idx];
     }
 
     return result;
   }
 
-  auto operator^(bitvector const& rhs) const noexcept -> bitvector
+  auto operator^(basic_bitvector const& rhs) const noexcept -> basic_bitvector
   {
-    bitvector result;
+    basic_bitvector result = *this;
     for (std::size_t idx = 0; idx < m_vars.size(); ++idx) {
-      result.m_vars[idx] = m_vars[idx] ^ rhs.m_vars[idx];
+      result.m_vars[idx] ^= rhs.m_vars[idx];
     }
 
     return result;
   }
 
-  auto operator|=(bitvector const& rhs) noexcept -> bitvector&
+  auto operator|=(basic_bitvector const& rhs) noexcept -> basic_bitvector&
   {
-    for (std::size_t idx = 0; idx < m_vars.size(); ++idx) {
-      m_vars[idx] |= rhs.m_vars[idx];
-    }
-
+    get_bitvector_kernels<num_words>().or_assign(m_vars.data(), rhs.m_vars.data());
     return *this;
   }
 
-  auto operator&=(bitvector const& rhs) noexcept -> bitvector&
+  auto operator&=(basic_bitvector const& rhs) noexcept -> basic_bitvector&
   {
-    for (std::size_t idx = 0; idx < m_vars.size(); ++idx) {
-      m_vars[idx] &= rhs.m_vars[idx];
-    }
-
+    get_bitvector_kernels<num_words>().and_assign(m_vars.data(), rhs.m_vars.data());
     return *this;
   }
 
-  auto operator^=(bitvector const& rhs) noexcept -> bitvector&
+  auto operator^=(basic_bitvector const& rhs) noexcept -> basic_bitvector&
   {
-    for (std::size_t idx = 0; idx < m_vars.size(); ++idx) {
-      m_vars[idx] ^= rhs.m_vars[idx];
-    }
-
+    get_bitvector_kernels<num_words>().xor_assign(m_vars.data(), rhs.m_vars.data());
     return *this;
   }
 
-  auto operator==(bitvector const& rhs) const noexcept -> bool
+  /**
+   * Inverts all bits in place, without creating a temporary like `~`
+   */
+  void invert() noexcept { get_bitvector_kernels<num_words>().invert(m_vars.data()); }
+
+  auto operator==(basic_bitvector const& rhs) const noexcept -> bool
   {
     return (this == &rhs) || (m_vars == rhs.m_vars);
   }
 
-  auto operator!=(bitvector const& rhs) const noexcept -> bool { return !(*this == rhs); }
+  auto operator!=(basic_bitvector const& rhs) const noexcept -> bool { return !(*this == rhs); }
 
   auto get_words() const noexcept -> words_t const& { return m_vars; }
 
@@ -105,9 +128,12 @@ public:
         m_vars.begin(), m_vars.end(), [](uint64_t x) { return x == ~static_cast<uint64_t>(0); });
   }
 
-  static auto ones() noexcept -> bitvector { return bitvector{~static_cast<uint64_t>(0)}; }
+  static auto ones() noexcept -> basic_bitvector
+  {
+    return basic_bitvector{~static_cast<uint64_t>(0)};
+  }
 
-  static auto zeros() noexcept -> bitvector { return bitvector{0ull}; }
+  static auto zeros() noexcept -> basic_bitvector { return basic_bitvector{0ull}; }
 
   void fill(uint64_t value) noexcept
   {
@@ -116,32 +142,43 @@ public:
     }
   }
 
-  auto operator=(bitvector const&) noexcept -> bitvector& = default;
-  auto operator=(bitvector&&) noexcept -> bitvector& = default;
-  bitvector(bitvector const&) noexcept = default;
-  bitvector(bitvector&&) noexcept = default;
+  auto operator=(basic_bitvector const&) noexcept -> basic_bitvector& = default;
+  auto operator=(basic_bitvector&&) noexcept -> basic_bitvector& = default;
+  basic_bitvector(basic_bitvector const&) noexcept = default;
+  basic_bitvector(basic_bitvector&&) noexcept = default;
 
 private:
-  explicit bitvector(uint64_t value) { fill(value); }
+  explicit basic_bitvector(uint64_t value) { fill(value); }
 
   words_t m_vars;
 };
 
+template <std::size_t Width>
+constexpr std::size_t basic_bitvector<Width>::width;
+
+template <std::size_t Width>
+constexpr std::size_t basic_bitvector<Width>::num_words;
+
+using bitvector = basic_bitvector<default_simulation_width>;
+
 
-class bitvector_map {
+template <std::size_t Width>
+class basic_bitvector_map {
 public:
-  explicit bitvector_map(std::size_t size) : m_size(size)
+  using bitvector_type = basic_bitvector<Width>;
+
+  explicit basic_bitvector_map(std::size_t size) : m_size(size)
   {
-    m_bitvectors = allocate_aligned<bitvector>(size);
+    m_bitvectors = allocate_aligned<bitvector_type>(size);
   }
 
-  auto operator[](std::size_t index) noexcept -> bitvector&
+  auto operator[](std::size_t index) noexcept -> bitvector_type&
   {
     assert(index < m_size);
     return m_bitvectors.get()[index];
   }
 
-  auto operator[](std::size_t index) const noexcept -> bitvector const&
+  auto operator[](std::size_t index) const noexcept -> bitvector_type const&
   {
     assert(index < m_size);
     return m_bitvectors.get()[index];
@@ -150,18 +187,32 @@ public:
   auto size() const noexcept -> std::size_t { return m_size; }
 
 private:
-  unique_aligned_array_ptr<bitvector> m_bitvectors;
+  unique_aligned_array_ptr<bitvector_type> m_bitvectors;
   std::size_t m_size;
 };
 
+using bitvector_map = basic_bitvector_map<default_simulation_width>;
+
 
 class bitvector_hash {
 public:
-  void add(bitvector const& bv)
+  template <std::size_t Width>
+  void add(basic_bitvector<Width> const& bv)
   {
-    for (uint64_t word : bv.get_words()) {
-      m_hash = xorshift_star(m_hash ^ word);
-    }
+    using kernel_bitvector = basic_bitvector<Width>;
+    m_hash = get_bitvector_kernels<kernel_bitvector::num_words>().hash(
+        m_hash, bv.get_words().data(), 0);
+  }
+
+  /**
+   * Equivalent to add(~bv), without computing ~bv
+   */
+  template <std::size_t Width>
+  void add_negated(basic_bitvector<Width> const& bv)
+  {
+    using kernel_bitvector = basic_bitvector<Width>;
+    m_hash = get_bitvector_kernels<kernel_bitvector::num_words>().hash(
+        m_hash, bv.get_words().data(), ~uint64_t{0});
   }
 
   auto operator==(bitvector_hash const& rhs) const noexcept -> bool
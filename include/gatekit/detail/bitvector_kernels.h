@@ -0,0 +1,732 @@
+#pragma once
+
+#include <gatekit/detail/utils.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+// SIMD kernels are compiled via function-level target attributes, so they
+// don't require compiling the library users' code with flags like -mavx2.
+// Defining GATEKIT_NO_SIMD_KERNELS restricts the library to the portable
+// kernels.
+#if !defined(GATEKIT_NO_SIMD_KERNELS) && (defined(__GNUC__) || defined(__clang__)) &&          \
+    (defined(__x86_64__) || defined(__i386__))
+#define GATEKIT_HAS_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace gatekit {
+namespace detail {
+
+enum class simd_isa { portable, sse2, avx2, avx512 };
+
+
+/**
+ * Bitvector operand of a fused kernel: the operand's value is `words[i] ^ flip`
+ * for each word index `i`, with `flip` being either 0 or ~0.
+ */
+struct bitvector_operand {
+  uint64_t const* words;
+  uint64_t flip;
+};
+
+
+/**
+ * Table of kernels operating on bitvectors with a fixed number of words. All
+ * kernels of a table are implemented for the same instruction set, and
+ * the kernels of all tables compute the same results.
+ */
+struct bitvector_kernels {
+  simd_isa isa;
+
+  void (*and_assign)(uint64_t* target, uint64_t const* rhs);
+  void (*or_assign)(uint64_t* target, uint64_t const* rhs);
+  void (*xor_assign)(uint64_t* target, uint64_t const* rhs);
+
+  // target[i] = ~target[i]
+  void (*invert)(uint64_t* target);
+
+  // target &= (operands[0] | ... | operands[num_operands - 1])
+  void (*and_clause)(uint64_t* target, bitvector_operand const* operands, std::size_t num_operands);
+
+  // target |= (operands[0] | ... | operands[num_operands - 1])
+  void (*or_operands)(uint64_t* target,
+                      bitvector_operand const* operands,
+                      std::size_t num_operands);
+
+  // target[i] = xorshift_star(target[i] + additional)
+  void (*randomize)(uint64_t* target, uint64_t additional);
+
+  // target[i] |= xorshift_star(target[i] + additional)
+  void (*thicken)(uint64_t* target, uint64_t additional);
+
+  // Returns the hash of the words, each XORed with `flip`, continuing from `state`
+  uint64_t (*hash)(uint64_t state, uint64_t const* words, uint64_t flip);
+};
+
+
+namespace kernels {
+
+// The hash kernels compute independent xorshift* chains for each of the
+// following lanes, with word i being added to lane i % num_hash_lanes, and
+// finally combine the lanes. Unlike a single chain over all words, this
+// can be computed in parallel.
+constexpr std::size_t num_hash_lanes = 8;
+constexpr uint64_t hash_lane_offset = 0x9e3779b97f4a7c15ull;
+
+inline auto combine_hash_lanes(uint64_t state, uint64_t const* lanes) noexcept -> uint64_t
+{
+  for (std::size_t lane = 0; lane < num_hash_lanes; ++lane) {
+    state = xorshift_star(state ^ lanes[lane]);
+  }
+  return state;
+}
+
+
+template <std::size_t NumWords>
+void and_assign_portable(uint64_t* target, uint64_t const* rhs)
+{
+  for (std::size_t idx = 0; idx < NumWords; ++idx) {
+    target[idx] &= rhs[idx];
+  }
+}
+
+template <std::size_t NumWords>
+void or_assign_portable(uint64_t* target, uint64_t const* rhs)
+{
+  for (std::size_t idx = 0; idx < NumWords; ++idx) {
+    target[idx] |= rhs[idx];
+  }
+}
+
+template <std::size_t NumWords>
+void xor_assign_portable(uint64_t* target, uint64_t const* rhs)
+{
+  for (std::size_t idx = 0; idx < NumWords; ++idx) {
+    target[idx] ^= rhs[idx];
+  }
+}
+
+template <std::size_t NumWords>
+void invert_portable(uint64_t* target)
+{
+  for (std::size_t idx = 0; idx < NumWords; ++idx) {
+    target[idx] = ~target[idx];
+  }
+}
+
+template <std::size_t NumWords>
+void
+or_operands_portable(uint64_t* target, bitvector_operand const* operands, std::size_t num_operands)
+{
+  for (std::size_t idx = 0; idx < NumWords; ++idx) {
+    uint64_t acc = 0;
+    for (std::size_t op = 0; op < num_operands; ++op) {
+      acc |= operands[op].words[idx] ^ operands[op].flip;
+    }
+    target[idx] |= acc;
+  }
+}
+
+template <std::size_t NumWords>
+void
+and_clause_portable(uint64_t* target, bitvector_operand const* operands, std::size_t num_operands)
+{
+  for (std::size_t idx = 0; idx < NumWords; ++idx) {
+    uint64_t acc = 0;
+    for (std::size_t op = 0; op < num_operands; ++op) {
+      acc |= operands[op].words[idx] ^ operands[op].flip;
+    }
+    target[idx] &= acc;
+  }
+}
+
+template <std::size_t NumWords>
+void randomize_portable(uint64_t* target, uint64_t additional)
+{
+  for (std::size_t idx = 0; idx < NumWords; ++idx) {
+    target[idx] = xorshift_star(target[idx] + additional);
+  }
+}
+
+template <std::size_t NumWords>
+void thicken_portable(uint64_t* target, uint64_t additional)
+{
+  for (std::size_t idx = 0; idx < NumWords; ++idx) {
+    target[idx] |= xorshift_star(target[idx] + additional);
+  }
+}
+
+template <std::size_t NumWords>
+auto hash_portable(uint64_t state, uint64_t const* words, uint64_t flip) -> uint64_t
+{
+  uint64_t lanes[num_hash_lanes];
+  for (std::size_t lane = 0; lane < num_hash_lanes; ++lane) {
+    lanes[lane] = state + lane * hash_lane_offset;
+  }
+
+  for (std::size_t idx = 0; idx < NumWords; idx += num_hash_lanes) {
+    for (std::size_t lane = 0; lane < num_hash_lanes; ++lane) {
+      lanes[lane] = xorshift_star(lanes[lane] ^ words[idx + lane] ^ flip);
+    }
+  }
+
+  return combine_hash_lanes(state, lanes);
+}
+
+
+#if defined(GATEKIT_HAS_X86_KERNELS)
+
+#define GATEKIT_TARGET_SSE2 __attribute__((target("sse2")))
+#define GATEKIT_TARGET_AVX2 __attribute__((target("avx2")))
+#define GATEKIT_TARGET_AVX512 __attribute__((target("avx512f,avx512dq")))
+
+// SSE2 kernels. x86 SIMD registers are loaded and stored without alignment
+// requirements, since the operands are not required to be bitvector objects
+
+GATEKIT_TARGET_SSE2 inline auto mul64_sse2(__m128i lhs, __m128i rhs) -> __m128i
+{
+  // SSE2 only has 32x32->64 bit multiplication, so the lower 64 bits of the
+  // product are lo(lhs)*lo(rhs) + ((hi(lhs)*lo(rhs) + lo(lhs)*hi(rhs)) << 32)
+  __m128i const cross = _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(lhs, 32), rhs),
+                                      _mm_mul_epu32(lhs, _mm_srli_epi64(rhs, 32)));
+  return _mm_add_epi64(_mm_mul_epu32(lhs, rhs), _mm_slli_epi64(cross, 32));
+}
+
+GATEKIT_TARGET_SSE2 inline auto xorshift_star_sse2(__m128i state) -> __m128i
+{
+  state = _mm_xor_si128(state, _mm_srli_epi64(state, 12));
+  state = _mm_xor_si128(state, _mm_slli_epi64(state, 25));
+  state = _mm_xor_si128(state, _mm_srli_epi64(state, 27));
+  return mul64_sse2(state, _mm_set1_epi64x(static_cast<long long>(xorshift_star_mult)));
+}
+
+GATEKIT_TARGET_SSE2 inline auto load_sse2(uint64_t const* words) -> __m128i
+{
+  return _mm_loadu_si128(reinterpret_cast<__m128i const*>(words));
+}
+
+GATEKIT_TARGET_SSE2 inline void store_sse2(uint64_t* words, __m128i value)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(words), value);
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_SSE2 void and_assign_sse2(uint64_t* target, uint64_t const* rhs)
+{
+  for (std::size_t idx = 0; idx < NumWords; idx += 2) {
+    store_sse2(target + idx, _mm_and_si128(load_sse2(target + idx), load_sse2(rhs + idx)));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_SSE2 void or_assign_sse2(uint64_t* target, uint64_t const* rhs)
+{
+  for (std::size_t idx = 0; idx < NumWords; idx += 2) {
+    store_sse2(target + idx, _mm_or_si128(load_sse2(target + idx), load_sse2(rhs + idx)));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_SSE2 void xor_assign_sse2(uint64_t* target, uint64_t const* rhs)
+{
+  for (std::size_t idx = 0; idx < NumWords; idx += 2) {
+    store_sse2(target + idx, _mm_xor_si128(load_sse2(target + idx), load_sse2(rhs + idx)));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_SSE2 void invert_sse2(uint64_t* target)
+{
+  __m128i const ones = _mm_set1_epi64x(-1);
+  for (std::size_t idx = 0; idx < NumWords; idx += 2) {
+    store_sse2(target + idx, _mm_xor_si128(load_sse2(target + idx), ones));
+  }
+}
+
+GATEKIT_TARGET_SSE2 inline auto
+or_of_operands_sse2(bitvector_operand const* operands, std::size_t num_operands, std::size_t idx)
+    -> __m128i
+{
+  __m128i acc = _mm_setzero_si128();
+  for (std::size_t op = 0; op < num_operands; ++op) {
+    __m128i const flip = _mm_set1_epi64x(static_cast<long long>(operands[op].flip));
+    acc = _mm_or_si128(acc, _mm_xor_si128(load_sse2(operands[op].words + idx), flip));
+  }
+  return acc;
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_SSE2 void
+or_operands_sse2(uint64_t* target, bitvector_operand const* operands, std::size_t num_operands)
+{
+  for (std::size_t idx = 0; idx < NumWords; idx += 2) {
+    __m128i const acc = or_of_operands_sse2(operands, num_operands, idx);
+    store_sse2(target + idx, _mm_or_si128(load_sse2(target + idx), acc));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_SSE2 void
+and_clause_sse2(uint64_t* target, bitvector_operand const* operands, std::size_t num_operands)
+{
+  for (std::size_t idx = 0; idx < NumWords; idx += 2) {
+    __m128i const acc = or_of_operands_sse2(operands, num_operands, idx);
+    store_sse2(target + idx, _mm_and_si128(load_sse2(target + idx), acc));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_SSE2 void randomize_sse2(uint64_t* target, uint64_t additional)
+{
+  __m128i const add = _mm_set1_epi64x(static_cast<long long>(additional));
+  for (std::size_t idx = 0; idx < NumWords; idx += 2) {
+    store_sse2(target + idx, xorshift_star_sse2(_mm_add_epi64(load_sse2(target + idx), add)));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_SSE2 void thicken_sse2(uint64_t* target, uint64_t additional)
+{
+  __m128i const add = _mm_set1_epi64x(static_cast<long long>(additional));
+  for (std::size_t idx = 0; idx < NumWords; idx += 2) {
+    __m128i const words = load_sse2(target + idx);
+    store_sse2(target + idx,
+               _mm_or_si128(words, xorshift_star_sse2(_mm_add_epi64(words, add))));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_SSE2 auto hash_sse2(uint64_t state, uint64_t const* words, uint64_t flip)
+    -> uint64_t
+{
+  uint64_t lanes[num_hash_lanes];
+  for (std::size_t lane = 0; lane < num_hash_lanes; ++lane) {
+    lanes[lane] = state + lane * hash_lane_offset;
+  }
+
+  __m128i const flip_vec = _mm_set1_epi64x(static_cast<long long>(flip));
+  __m128i lane_vecs[num_hash_lanes / 2];
+  for (std::size_t reg = 0; reg < num_hash_lanes / 2; ++reg) {
+    lane_vecs[reg] = load_sse2(lanes + 2 * reg);
+  }
+
+  for (std::size_t idx = 0; idx < NumWords; idx += num_hash_lanes) {
+    for (std::size_t reg = 0; reg < num_hash_lanes / 2; ++reg) {
+      __m128i const input = _mm_xor_si128(load_sse2(words + idx + 2 * reg), flip_vec);
+      lane_vecs[reg] = xorshift_star_sse2(_mm_xor_si128(lane_vecs[reg], input));
+    }
+  }
+
+  for (std::size_t reg = 0; reg < num_hash_lanes / 2; ++reg) {
+    store_sse2(lanes + 2 * reg, lane_vecs[reg]);
+  }
+  return combine_hash_lanes(state, lanes);
+}
+
+
+// AVX2 kernels
+
+GATEKIT_TARGET_AVX2 inline auto mul64_avx2(__m256i lhs, __m256i rhs) -> __m256i
+{
+  // See mul64_sse2()
+  __m256i const cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(lhs, 32), rhs),
+                                         _mm256_mul_epu32(lhs, _mm256_srli_epi64(rhs, 32)));
+  return _mm256_add_epi64(_mm256_mul_epu32(lhs, rhs), _mm256_slli_epi64(cross, 32));
+}
+
+GATEKIT_TARGET_AVX2 inline auto xorshift_star_avx2(__m256i state) -> __m256i
+{
+  state = _mm256_xor_si256(state, _mm256_srli_epi64(state, 12));
+  state = _mm256_xor_si256(state, _mm256_slli_epi64(state, 25));
+  state = _mm256_xor_si256(state, _mm256_srli_epi64(state, 27));
+  return mul64_avx2(state, _mm256_set1_epi64x(static_cast<long long>(xorshift_star_mult)));
+}
+
+GATEKIT_TARGET_AVX2 inline auto load_avx2(uint64_t const* words) -> __m256i
+{
+  return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(words));
+}
+
+GATEKIT_TARGET_AVX2 inline void store_avx2(uint64_t* words, __m256i value)
+{
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(words), value);
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_AVX2 void and_assign_avx2(uint64_t* target, uint64_t const* rhs)
+{
+  for (std::size_t idx = 0; idx < NumWords; idx += 4) {
+    store_avx2(target + idx, _mm256_and_si256(load_avx2(target + idx), load_avx2(rhs + idx)));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_AVX2 void or_assign_avx2(uint64_t* target, uint64_t const* rhs)
+{
+  for (std::size_t idx = 0; idx < NumWords; idx += 4) {
+    store_avx2(target + idx, _mm256_or_si256(load_avx2(target + idx), load_avx2(rhs + idx)));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_AVX2 void xor_assign_avx2(uint64_t* target, uint64_t const* rhs)
+{
+  for (std::size_t idx = 0; idx < NumWords; idx += 4) {
+    store_avx2(target + idx, _mm256_xor_si256(load_avx2(target + idx), load_avx2(rhs + idx)));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_AVX2 void invert_avx2(uint64_t* target)
+{
+  __m256i const ones = _mm256_set1_epi64x(-1);
+  for (std::size_t idx = 0; idx < NumWords; idx += 4) {
+    store_avx2(target + idx, _mm256_xor_si256(load_avx2(target + idx), ones));
+  }
+}
+
+GATEKIT_TARGET_AVX2 inline auto
+or_of_operands_avx2(bitvector_operand const* operands, std::size_t num_operands, std::size_t idx)
+    -> __m256i
+{
+  __m256i acc = _mm256_setzero_si256();
+  for (std::size_t op = 0; op < num_operands; ++op) {
+    __m256i const flip = _mm256_set1_epi64x(static_cast<long long>(operands[op].flip));
+    acc = _mm256_or_si256(acc, _mm256_xor_si256(load_avx2(operands[op].words + idx), flip));
+  }
+  return acc;
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_AVX2 void
+or_operands_avx2(uint64_t* target, bitvector_operand const* operands, std::size_t num_operands)
+{
+  for (std::size_t idx = 0; idx < NumWords; idx += 4) {
+    __m256i const acc = or_of_operands_avx2(operands, num_operands, idx);
+    store_avx2(target + idx, _mm256_or_si256(load_avx2(target + idx), acc));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_AVX2 void
+and_clause_avx2(uint64_t* target, bitvector_operand const* operands, std::size_t num_operands)
+{
+  for (std::size_t idx = 0; idx < NumWords; idx += 4) {
+    __m256i const acc = or_of_operands_avx2(operands, num_operands, idx);
+    store_avx2(target + idx, _mm256_and_si256(load_avx2(target + idx), acc));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_AVX2 void randomize_avx2(uint64_t* target, uint64_t additional)
+{
+  __m256i const add = _mm256_set1_epi64x(static_cast<long long>(additional));
+  for (std::size_t idx = 0; idx < NumWords; idx += 4) {
+    store_avx2(target + idx, xorshift_star_avx2(_mm256_add_epi64(load_avx2(target + idx), add)));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_AVX2 void thicken_avx2(uint64_t* target, uint64_t additional)
+{
+  __m256i const add = _mm256_set1_epi64x(static_cast<long long>(additional));
+  for (std::size_t idx = 0; idx < NumWords; idx += 4) {
+    __m256i const words = load_avx2(target + idx);
+    store_avx2(target + idx,
+               _mm256_or_si256(words, xorshift_star_avx2(_mm256_add_epi64(words, add))));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_AVX2 auto hash_avx2(uint64_t state, uint64_t const* words, uint64_t flip)
+    -> uint64_t
+{
+  uint64_t lanes[num_hash_lanes];
+  for (std::size_t lane = 0; lane < num_hash_lanes; ++lane) {
+    lanes[lane] = state + lane * hash_lane_offset;
+  }
+
+  __m256i const flip_vec = _mm256_set1_epi64x(static_cast<long long>(flip));
+  __m256i lane_vecs[num_hash_lanes / 4];
+  for (std::size_t reg = 0; reg < num_hash_lanes / 4; ++reg) {
+    lane_vecs[reg] = load_avx2(lanes + 4 * reg);
+  }
+
+  for (std::size_t idx = 0; idx < NumWords; idx += num_hash_lanes) {
+    for (std::size_t reg = 0; reg < num_hash_lanes / 4; ++reg) {
+      __m256i const input = _mm256_xor_si256(load_avx2(words + idx + 4 * reg), flip_vec);
+      lane_vecs[reg] = xorshift_star_avx2(_mm256_xor_si256(lane_vecs[reg], input));
+    }
+  }
+
+  for (std::size_t reg = 0; reg < num_hash_lanes / 4; ++reg) {
+    store_avx2(lanes + 4 * reg, lane_vecs[reg]);
+  }
+  return combine_hash_lanes(state, lanes);
+}
+
+
+// AVX-512 kernels. AVX512DQ is required for 64-bit multiplication.
+
+GATEKIT_TARGET_AVX512 inline auto xorshift_star_avx512(__m512i state) -> __m512i
+{
+  // Using the zero-masking shifts with a full mask, since the unmasked shifts
+  // trigger bogus -Wuninitialized warnings in some GCC versions
+  __mmask8 const all = 0xff;
+  state = _mm512_xor_si512(state, _mm512_maskz_srli_epi64(all, state, 12));
+  state = _mm512_xor_si512(state, _mm512_maskz_slli_epi64(all, state, 25));
+  state = _mm512_xor_si512(state, _mm512_maskz_srli_epi64(all, state, 27));
+  return _mm512_mullo_epi64(state, _mm512_set1_epi64(static_cast<long long>(xorshift_star_mult)));
+}
+
+GATEKIT_TARGET_AVX512 inline auto load_avx512(uint64_t const* words) -> __m512i
+{
+  return _mm512_loadu_si512(words);
+}
+
+GATEKIT_TARGET_AVX512 inline void store_avx512(uint64_t* words, __m512i value)
+{
+  _mm512_storeu_si512(words, value);
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_AVX512 void and_assign_avx512(uint64_t* target, uint64_t const* rhs)
+{
+  for (std::size_t idx = 0; idx < NumWords; idx += 8) {
+    store_avx512(target + idx,
+                 _mm512_and_si512(load_avx512(target + idx), load_avx512(rhs + idx)));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_AVX512 void or_assign_avx512(uint64_t* target, uint64_t const* rhs)
+{
+  for (std::size_t idx = 0; idx < NumWords; idx += 8) {
+    store_avx512(target + idx, _mm512_or_si512(load_avx512(target + idx), load_avx512(rhs + idx)));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_AVX512 void xor_assign_avx512(uint64_t* target, uint64_t const* rhs)
+{
+  for (std::size_t idx = 0; idx < NumWords; idx += 8) {
+    store_avx512(target + idx,
+                 _mm512_xor_si512(load_avx512(target + idx), load_avx512(rhs + idx)));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_AVX512 void invert_avx512(uint64_t* target)
+{
+  __m512i const ones = _mm512_set1_epi64(-1);
+  for (std::size_t idx = 0; idx < NumWords; idx += 8) {
+    store_avx512(target + idx, _mm512_xor_si512(load_avx512(target + idx), ones));
+  }
+}
+
+GATEKIT_TARGET_AVX512 inline auto
+or_of_operands_avx512(bitvector_operand const* operands, std::size_t num_operands, std::size_t idx)
+    -> __m512i
+{
+  __m512i acc = _mm512_setzero_si512();
+  for (std::size_t op = 0; op < num_operands; ++op) {
+    __m512i const flip = _mm512_set1_epi64(static_cast<long long>(operands[op].flip));
+    acc = _mm512_or_si512(acc, _mm512_xor_si512(load_avx512(operands[op].words + idx), flip));
+  }
+  return acc;
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_AVX512 void
+or_operands_avx512(uint64_t* target, bitvector_operand const* operands, std::size_t num_operands)
+{
+  for (std::size_t idx = 0; idx < NumWords; idx += 8) {
+    __m512i const acc = or_of_operands_avx512(operands, num_operands, idx);
+    store_avx512(target + idx, _mm512_or_si512(load_avx512(target + idx), acc));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_AVX512 void
+and_clause_avx512(uint64_t* target, bitvector_operand const* operands, std::size_t num_operands)
+{
+  for (std::size_t idx = 0; idx < NumWords; idx += 8) {
+    __m512i const acc = or_of_operands_avx512(operands, num_operands, idx);
+    store_avx512(target + idx, _mm512_and_si512(load_avx512(target + idx), acc));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_AVX512 void randomize_avx512(uint64_t* target, uint64_t additional)
+{
+  __m512i const add = _mm512_set1_epi64(static_cast<long long>(additional));
+  for (std::size_t idx = 0; idx < NumWords; idx += 8) {
+    store_avx512(target + idx,
+                 xorshift_star_avx512(_mm512_add_epi64(load_avx512(target + idx), add)));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_AVX512 void thicken_avx512(uint64_t* target, uint64_t additional)
+{
+  __m512i const add = _mm512_set1_epi64(static_cast<long long>(additional));
+  for (std::size_t idx = 0; idx < NumWords; idx += 8) {
+    __m512i const words = load_avx512(target + idx);
+    store_avx512(target + idx,
+                 _mm512_or_si512(words, xorshift_star_avx512(_mm512_add_epi64(words, add))));
+  }
+}
+
+template <std::size_t NumWords>
+GATEKIT_TARGET_AVX512 auto
+hash_avx512(uint64_t state, uint64_t const* words, uint64_t flip) -> uint64_t
+{
+  static_assert(num_hash_lanes == 8, "the AVX-512 hash kernel requires 8 lanes");
+
+  uint64_t lanes[num_hash_lanes];
+  for (std::size_t lane = 0; lane < num_hash_lanes; ++lane) {
+    lanes[lane] = state + lane * hash_lane_offset;
+  }
+
+  __m512i const flip_vec = _mm512_set1_epi64(static_cast<long long>(flip));
+  __m512i lane_vec = load_avx512(lanes);
+
+  for (std::size_t idx = 0; idx < NumWords; idx += num_hash_lanes) {
+    __m512i const input = _mm512_xor_si512(load_avx512(words + idx), flip_vec);
+    lane_vec = xorshift_star_avx512(_mm512_xor_si512(lane_vec, input));
+  }
+
+  store_avx512(lanes, lane_vec);
+  return combine_hash_lanes(state, lanes);
+}
+
+#undef GATEKIT_TARGET_SSE2
+#undef GATEKIT_TARGET_AVX2
+#undef GATEKIT_TARGET_AVX512
+
+#endif
+}
+
+
+/**
+ * Returns true iff the kernels for `isa` can be used on the current CPU
+ */
+inline auto is_supported(simd_isa isa) noexcept -> bool
+{
+#if defined(GATEKIT_HAS_X86_KERNELS)
+  __builtin_cpu_init();
+
+  switch (isa) {
+  case simd_isa::sse2:
+    return __builtin_cpu_supports("sse2");
+  case simd_isa::avx2:
+    return __builtin_cpu_supports("avx2");
+  case simd_isa::avx512:
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq");
+  default:
+    return true;
+  }
+#else
+  return isa == simd_isa::portable;
+#endif
+}
+
+
+/**
+ * Returns the kernels for bitvectors of `NumWords` words implemented for
+ * `isa`, which must be supported by the current CPU
+ */
+template <std::size_t NumWords>
+auto get_bitvector_kernels(simd_isa isa) noexcept -> bitvector_kernels
+{
+  static_assert(NumWords > 0 && NumWords % kernels::num_hash_lanes == 0,
+                "the number of words must be a multiple of the number of hash lanes");
+  assert(is_supported(isa));
+
+  bitvector_kernels result;
+  result.isa = simd_isa::portable;
+  result.and_assign = kernels::and_assign_portable<NumWords>;
+  result.or_assign = kernels::or_assign_portable<NumWords>;
+  result.xor_assign = kernels::xor_assign_portable<NumWords>;
+  result.invert = kernels::invert_portable<NumWords>;
+  result.and_clause = kernels::and_clause_portable<NumWords>;
+  result.or_operands = kernels::or_operands_portable<NumWords>;
+  result.randomize = kernels::randomize_portable<NumWords>;
+  result.thicken = kernels::thicken_portable<NumWords>;
+  result.hash = kernels::hash_portable<NumWords>;
+
+#if defined(GATEKIT_HAS_X86_KERNELS)
+  if (isa == simd_isa::sse2) {
+    result.isa = simd_isa::sse2;
+    result.and_assign = kernels::and_assign_sse2<NumWords>;
+    result.or_assign = kernels::or_assign_sse2<NumWords>;
+    result.xor_assign = kernels::xor_assign_sse2<NumWords>;
+    result.invert = kernels::invert_sse2<NumWords>;
+    result.and_clause = kernels::and_clause_sse2<NumWords>;
+    result.or_operands = kernels::or_operands_sse2<NumWords>;
+    result.randomize = kernels::randomize_sse2<NumWords>;
+    result.thicken = kernels::thicken_sse2<NumWords>;
+    result.hash = kernels::hash_sse2<NumWords>;
+  }
+  else if (isa == simd_isa::avx2) {
+    result.isa = simd_isa::avx2;
+    result.and_assign = kernels::and_assign_avx2<NumWords>;
+    result.or_assign = kernels::or_assign_avx2<NumWords>;
+    result.xor_assign = kernels::xor_assign_avx2<NumWords>;
+    result.invert = kernels::invert_avx2<NumWords>;
+    result.and_clause = kernels::and_clause_avx2<NumWords>;
+    result.or_operands = kernels::or_operands_avx2<NumWords>;
+    result.randomize = kernels::randomize_avx2<NumWords>;
+    result.thicken = kernels::thicken_avx2<NumWords>;
+    result.hash = kernels::hash_avx2<NumWords>;
+  }
+  else if (isa == simd_isa::avx512) {
+    result.isa = simd_isa::avx512;
+    result.and_assign = kernels::and_assign_avx512<NumWords>;
+    result.or_assign = kernels::or_assign_avx512<NumWords>;
+    result.xor_assign = kernels::xor_assign_avx512<NumWords>;
+    result.invert = kernels::invert_avx512<NumWords>;
+    result.and_clause = kernels::and_clause_avx512<NumWords>;
+    result.or_operands = kernels::or_operands_avx512<NumWords>;
+    result.randomize = kernels::randomize_avx512<NumWords>;
+    result.thicken = kernels::thicken_avx512<NumWords>;
+    result.hash = kernels::hash_avx512<NumWords>;
+  }
+#endif
+
+  return result;
+}
+
+
+/**
+ * Returns the most capable instruction set with kernels supported by the
+ * current CPU
+ */
+inline auto get_best_simd_isa() noexcept -> simd_isa
+{
+  simd_isa const candidates[] = {simd_isa::avx512, simd_isa::avx2, simd_isa::sse2};
+  for (simd_isa isa : candidates) {
+    if (is_supported(isa)) {
+      return isa;
+    }
+  }
+  return simd_isa::portable;
+}
+
+
+/**
+ * Returns the kernels for bitvectors of `NumWords` words for the most capable
+ * instruction set supported by the current CPU. The CPU is only queried on
+ * the first call.
+ */
+template <std::size_t NumWords>
+auto get_bitvector_kernels() noexcept -> bitvector_kernels const&
+{
+  static bitvector_kernels const result = get_bitvector_kernels<NumWords>(get_best_simd_isa());
+  return result;
+}
+
+}
+}
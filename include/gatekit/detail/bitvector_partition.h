@@ -5,8 +5,12 @@
 #include <gatekit/detail/utils.h>
 #include <gatekit/gate.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
+#include <limits>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
@@ -20,37 +24,51 @@ struct lit_partitioning {
 
 namespace detail {
 
-class bitvector_sequence_partition {
+template <std::size_t Width>
+class basic_bitvector_sequence_partition {
 public:
-  explicit bitvector_sequence_partition(std::size_t size) : m_hashes(size)
+  explicit basic_bitvector_sequence_partition(std::size_t size) : m_hashes(size)
   {
     for (std::size_t idx = 0; idx < m_hashes.size(); ++idx) {
       m_hashes[idx].index = idx;
     }
   }
 
-  void add(bitvector_map const& bv_map)
+  void add(basic_bitvector_map<Width> const& bv_map)
   {
-    assert(bv_map.size() == m_hashes.size());
-
+    // After compress(), only the entries of non-singleton variables are left
     for (hash_entry& current : m_hashes) {
-      bitvector const& bv = bv_map[current.index];
+      assert(current.index < bv_map.size());
+      basic_bitvector<Width> const& bv = bv_map[current.index];
       current.pos_hash.add(bv);
-      current.neg_hash.add(~bv);
+      current.neg_hash.add_negated(bv);
       current.stuck_positive &= bv.is_all_one();
       current.stuck_negative &= bv.is_all_zero();
     }
   }
 
-  void compress()
+  /**
+   * Removes the entries of variables that are neither backbone candidates
+   * nor equivalent to another variable. Since adding bitvectors can only
+   * refine the partitioning, these variables stay singletons, and dropping
+   * them saves their hash updates in subsequent add() calls.
+   *
+   * Returns true iff the partitioning has been refined since the previous
+   * call of compress(), or since construction.
+   */
+  auto compress() -> bool
   {
-    std::unordered_map<bitvector_hash, std::size_t> hash_counters;
+    m_hash_counters.clear();
+    std::size_t num_stuck = 0;
 
     for (hash_entry const& entry : m_hashes) {
-      ++hash_counters[entry.pos_hash];
-      ++hash_counters[entry.neg_hash];
+      ++m_hash_counters[entry.pos_hash];
+      ++m_hash_counters[entry.neg_hash];
+      num_stuck += (entry.stuck_negative || entry.stuck_positive) ? 1 : 0;
     }
 
+    std::size_t const num_entries = m_hashes.size();
+    std::unordered_map<bitvector_hash, std::size_t>& hash_counters = m_hash_counters;
     erase_remove_if(m_hashes, [&hash_counters](hash_entry const& removal_candidate) {
       if (removal_candidate.stuck_negative || removal_candidate.stuck_positive) {
         // stuck-at-fault/backbone candidates are always kept
@@ -64,16 +82,36 @@ public:
       // acceptable. Therefore, checking only pos_hash is sufficient here:
       return hash_counters[removal_candidate.pos_hash] == 1;
     });
+
+    // Refining the partitioning either splits off singletons, splits a class
+    // into several classes, or turns backbone candidates into equivalence
+    // candidates, changing at least one of these counts
+    std::size_t const num_dropped = num_entries - m_hashes.size();
+    std::size_t const num_hashes = m_hash_counters.size();
+    bool const refined = num_dropped != 0 || num_hashes != m_last_num_hashes ||
+                         num_stuck != m_last_num_stuck;
+
+    // Each dropped singleton had its own pos and neg hash
+    m_last_num_hashes = num_hashes - 2 * num_dropped;
+    m_last_num_stuck = num_stuck;
+    return refined;
   }
 
+  /**
+   * Returns the number of variables that are still tracked, i.e. that have not
+   * been found to be singletons by compress() yet.
+   */
+  auto num_candidates() const noexcept -> std::size_t { return m_hashes.size(); }
+
   template <typename Lit>
   auto get_current_partitions() -> lit_partitioning<Lit>
   {
     compress();
 
     lit_partitioning<Lit> result;
-    std::unordered_map<bitvector_hash, std::vector<Lit>> equivalences;
-    using map_iter = typename decltype(equivalences)::iterator;
+    using equivalence_map = std::unordered_map<bitvector_hash, std::vector<Lit>>;
+    using map_iter = typename equivalence_map::iterator;
+    equivalence_map equivalences;
 
     for (hash_entry const& entry : m_hashes) {
       if (entry.stuck_negative || entry.stuck_positive) {
@@ -116,7 +154,256 @@ private:
   };
 
   std::vector<hash_entry> m_hashes;
+
+  // Kept across compress() calls for reusing the allocated buckets
+  std::unordered_map<bitvector_hash, std::size_t> m_hash_counters;
+  std::size_t m_last_num_hashes = 0;
+  std::size_t m_last_num_stuck = 0;
+};
+
+using bitvector_sequence_partition = basic_bitvector_sequence_partition<default_simulation_width>;
+
+
+/**
+ * \brief Partition of variables by their sequences of simulated values,
+ *        refined exactly
+ *
+ * Like basic_bitvector_sequence_partition, but the equivalence classes are
+ * stored explicitly and split in each add() call by sorting the candidates
+ * by their class and their actual bitvector words. Unlike comparing hashes of
+ * the sequences, this never merges variables with different values. Since
+ * the candidates are kept in flat arrays, grouping them is also cheaper than
+ * with hash maps.
+ *
+ * To detect equivalences modulo negation, each bitvector is normalized to
+ * having the first bit of the first added round unset.
+ */
+template <std::size_t Width>
+class basic_bitvector_exact_partition {
+public:
+  explicit basic_bitvector_exact_partition(std::size_t size)
+    : m_entries(size), m_num_classes(size > 0 ? 1 : 0), m_num_class_ids(m_num_classes)
+  {
+    assert(size <= std::numeric_limits<uint32_t>::max());
+    for (std::size_t idx = 0; idx < m_entries.size(); ++idx) {
+      m_entries[idx].index = idx;
+    }
+  }
+
+  void add(basic_bitvector_map<Width> const& bv_map)
+  {
+    m_keys.clear();
+
+    for (std::size_t pos = 0; pos < m_entries.size(); ++pos) {
+      entry& current = m_entries[pos];
+      assert(current.index < bv_map.size());
+      basic_bitvector<Width> const& bv = bv_map[current.index];
+
+      if (m_is_first_round) {
+        current.flip_mask = (bv.get_words()[0] & 1) != 0 ? ~uint64_t{0} : 0;
+      }
+      current.stuck_positive &= bv.is_all_one();
+      current.stuck_negative &= bv.is_all_zero();
+
+      uint64_t const first_word = bv.get_words()[0] ^ current.flip_mask;
+      m_keys.push_back(sort_key{first_word, (uint64_t{current.class_id} << 32) | pos});
+    }
+    m_is_first_round = false;
+
+    // Sorting by the first word usually separates the unequal candidates of a
+    // class already, so the remaining words only need to be compared within
+    // runs of equal first words
+    std::sort(m_keys.begin(), m_keys.end(), [](sort_key const& lhs, sort_key const& rhs) {
+      uint32_t const lhs_class = lhs.class_id();
+      uint32_t const rhs_class = rhs.class_id();
+      return std::tie(lhs_class, lhs.first_word, lhs.class_and_pos) <
+             std::tie(rhs_class, rhs.first_word, rhs.class_and_pos);
+    });
+
+    uint32_t next_class_id = 0;
+    auto run_begin = m_keys.begin();
+    while (run_begin != m_keys.end()) {
+      auto const run_end = std::find_if(run_begin, m_keys.end(), [run_begin](sort_key const& key) {
+        return key.class_id() != run_begin->class_id() || key.first_word != run_begin->first_word;
+      });
+
+      split_run(bv_map, run_begin, run_end, next_class_id);
+      run_begin = run_end;
+    }
+
+    m_num_classes = next_class_id;
+    m_num_class_ids = next_class_id;
+  }
+
+  /**
+   * Removes the entries of variables that are neither backbone candidates
+   * nor equivalent to another variable, like
+   * basic_bitvector_sequence_partition::compress().
+   *
+   * Returns true iff the partitioning has been refined since the previous
+   * call of compress(), or since construction.
+   */
+  auto compress() -> bool
+  {
+    m_class_sizes.assign(m_num_class_ids, 0);
+    std::size_t num_stuck = 0;
+    for (entry const& current : m_entries) {
+      ++m_class_sizes[current.class_id];
+      num_stuck += (current.stuck_negative || current.stuck_positive) ? 1 : 0;
+    }
+
+    // Since classes are only ever split, the partitioning has been refined
+    // iff the number of classes including the dropped singletons has changed,
+    // or if backbone candidates have turned into equivalence candidates
+    std::size_t const num_classes = m_num_dropped + m_num_classes;
+    bool const refined = num_classes != m_last_num_classes || num_stuck != m_last_num_stuck;
+    m_last_num_classes = num_classes;
+    m_last_num_stuck = num_stuck;
+
+    std::size_t const num_entries = m_entries.size();
+    std::vector<uint32_t> const& class_sizes = m_class_sizes;
+    erase_remove_if(m_entries, [&class_sizes](entry const& removal_candidate) {
+      // stuck-at-fault/backbone candidates are always kept
+      return !removal_candidate.stuck_negative && !removal_candidate.stuck_positive &&
+             class_sizes[removal_candidate.class_id] == 1;
+    });
+
+    std::size_t const num_dropped = num_entries - m_entries.size();
+    m_num_dropped += num_dropped;
+    m_num_classes -= num_dropped;
+    return refined;
+  }
+
+  /**
+   * Returns the number of variables that are still tracked, i.e. that have not
+   * been found to be singletons by compress() yet.
+   */
+  auto num_candidates() const noexcept -> std::size_t { return m_entries.size(); }
+
+  template <typename Lit>
+  auto get_current_partitions() -> lit_partitioning<Lit>
+  {
+    compress();
+
+    lit_partitioning<Lit> result;
+
+    // The classes are ordered by their first member, and each class's first
+    // member is positive
+    m_class_slots.assign(m_num_class_ids, uint32_t{no_slot});
+    m_first_flip_masks.clear();
+
+    for (entry const& current : m_entries) {
+      if (current.stuck_negative || current.stuck_positive) {
+        result.backbones.push_back(to_lit<Lit>(current.index, current.stuck_positive));
+        continue;
+      }
+
+      uint32_t& slot = m_class_slots[current.class_id];
+      if (slot == no_slot) {
+        slot = static_cast<uint32_t>(result.equivalences.size());
+        result.equivalences.emplace_back();
+        m_first_flip_masks.push_back(current.flip_mask);
+      }
+
+      bool const positive = current.flip_mask == m_first_flip_masks[slot];
+      result.equivalences[slot].push_back(to_lit<Lit>(current.index, positive));
+    }
+
+    return result;
+  }
+
+private:
+  struct entry {
+    std::size_t index = 0;
+    uint32_t class_id = 0;
+    uint64_t flip_mask = 0;
+    bool stuck_positive = true;
+    bool stuck_negative = true;
+  };
+
+  // The class ID and the position of the entry are packed into a single
+  // word, keeping the keys at 16 bytes
+  struct sort_key {
+    uint64_t first_word;
+    uint64_t class_and_pos;
+
+    auto class_id() const noexcept -> uint32_t
+    {
+      return static_cast<uint32_t>(class_and_pos >> 32);
+    }
+
+    auto pos() const noexcept -> uint32_t { return static_cast<uint32_t>(class_and_pos); }
+  };
+
+  static_assert(sizeof(sort_key) == 16, "sort keys should not be padded");
+
+  using key_iter = typename std::vector<sort_key>::iterator;
+
+  auto get_normalized_word(basic_bitvector_map<Width> const& bv_map,
+                           sort_key const& key,
+                           std::size_t word) const noexcept -> uint64_t
+  {
+    entry const& current = m_entries[key.pos()];
+    return bv_map[current.index].get_words()[word] ^ current.flip_mask;
+  }
+
+  // Assigns new class IDs to the entries of a run of keys with equal class
+  // and first word, splitting the run by the remaining words
+  void split_run(basic_bitvector_map<Width> const& bv_map,
+                 key_iter begin,
+                 key_iter end,
+                 uint32_t& next_class_id)
+  {
+    auto const compare = [this, &bv_map](sort_key const& lhs, sort_key const& rhs) -> int {
+      for (std::size_t word = 1; word < basic_bitvector<Width>::num_words; ++word) {
+        uint64_t const lhs_word = get_normalized_word(bv_map, lhs, word);
+        uint64_t const rhs_word = get_normalized_word(bv_map, rhs, word);
+        if (lhs_word != rhs_word) {
+          return lhs_word < rhs_word ? -1 : 1;
+        }
+      }
+      return 0;
+    };
+
+    // Usually, all members of a run are equal, so checking this first avoids
+    // sorting them
+    bool const all_equal = std::all_of(
+        begin, end, [begin, &compare](sort_key const& key) { return compare(*begin, key) == 0; });
+
+    if (!all_equal) {
+      std::sort(begin, end, [&compare](sort_key const& lhs, sort_key const& rhs) {
+        return compare(lhs, rhs) < 0;
+      });
+    }
+
+    for (key_iter iter = begin; iter != end; ++iter) {
+      if (iter == begin || (!all_equal && compare(*(iter - 1), *iter) != 0)) {
+        ++next_class_id;
+      }
+      m_entries[iter->pos()].class_id = next_class_id - 1;
+    }
+  }
+
+  static constexpr uint32_t no_slot = std::numeric_limits<uint32_t>::max();
+
+  std::vector<entry> m_entries;
+  std::vector<sort_key> m_keys;
+  bool m_is_first_round = true;
+
+  // The number of classes of the entries, and the number of class IDs in use
+  std::size_t m_num_classes;
+  std::size_t m_num_class_ids;
+
+  std::size_t m_num_dropped = 0;
+  std::size_t m_last_num_classes = 0;
+  std::size_t m_last_num_stuck = 0;
+
+  std::vector<uint32_t> m_class_sizes;
+  std::vector<uint32_t> m_class_slots;
+  std::vector<uint64_t> m_first_flip_masks;
 };
 
+using bitvector_exact_partition = basic_bitvector_exact_partition<default_simulation_width>;
+
 }
 }
@@ -1,19 +1,33 @@
 #pragma once
 
 #include <gatekit/detail/bitvector.h>
+#include <gatekit/detail/bitvector_kernels.h>
+#include <gatekit/detail/threads.h>
+#include <gatekit/detail/utils.h>
+#include <gatekit/detail/var_compaction.h>
+#include <gatekit/flat_gate_structure.h>
 #include <gatekit/gate.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
 #include <utility>
+#include <vector>
 
 namespace gatekit {
 namespace detail {
 
-template <typename ClauseHandle>
+/**
+ * The clauses of a gate checked by propagate_gate(). `Gate` can be
+ * `gate<ClauseHandle>` or `gate_view<ClauseHandle>`.
+ */
+template <typename Gate>
 class prop_clauses {
 public:
-  using iterator = decltype(std::declval<gate<ClauseHandle>>().clauses.cbegin());
+  using iterator = decltype(std::declval<Gate const&>().clauses.begin());
 
-  prop_clauses(gate<ClauseHandle> const& gate)
+  prop_clauses(Gate const& gate)
   {
     bool const has_fewer_fwd = (gate.clauses.size() - gate.num_fwd_clauses <= gate.num_fwd_clauses);
     m_iterating_fwd = gate.is_nested_monotonically || has_fewer_fwd;
@@ -41,9 +55,20 @@ private:
 };
 
 
-template <typename ClauseHandle>
-void propagate_gate(bitvector_map& assignment_by_var, gate<ClauseHandle> const& gate)
+/**
+ * Like propagate_gate(assignment_by_var, gate, var_index_map), using the
+ * given kernels. Propagating many gates, callers should look up the kernels
+ * only once.
+ */
+template <std::size_t Width, typename Gate, typename VarIndexMap>
+void propagate_gate(basic_bitvector_map<Width>& assignment_by_var,
+                    Gate const& gate,
+                    VarIndexMap const& var_index_map,
+                    bitvector_kernels const& kernels)
 {
+  using ClauseHandle = typename Gate::clause_handle;
+  using bitvector = basic_bitvector<Width>;
+
   auto const out_var = to_var_index(gate.output);
 
   // Approach: check if fwd (rsp. the bwd clauses, whichever set is smaller) are all
@@ -66,12 +91,27 @@ void propagate_gate(bitvector_map& assignment_by_var, gate<ClauseHandle> const&
   // not been applied to the gate structure) since this propagator uses a
   // binary variable assignment, so indeterminacy cannot be expressed. However,
   // this is not a problem since the original gate semantics are not violated.
+  //
+  // The output variable does not occur among the operands, so
+  // output_forced_by_other_set is computed in place of the output's assignment.
+
+  bitvector& output_forced_by_other_set = assignment_by_var[var_index_map(out_var)];
+  output_forced_by_other_set.fill(~uint64_t{0});
 
-  bitvector output_forced_by_other_set = bitvector::ones();
+  // The literals of each clause are collected as kernel operands and passed
+  // to the fused clause kernel, which ORs them and ANDs the result into
+  // output_forced_by_other_set. The operands of very long clauses are ORed
+  // into clause_satisfied in chunks instead. clause_satisfied is only
+  // initialized for such clauses.
+  std::size_t const max_num_operands = 16;
+  bitvector_operand operands[max_num_operands];
+  uint64_t* const output_forced_words = output_forced_by_other_set.get_words().data();
+  alignas(64) typename bitvector::words_t clause_satisfied;
 
-  prop_clauses<ClauseHandle> clauses{gate};
+  prop_clauses<Gate> clauses{gate};
   for (ClauseHandle const& clause : clauses) {
-    bitvector this_clause_satisfied = bitvector::zeros();
+    std::size_t num_operands = 0;
+    bool is_long_clause = false;
 
     for (auto const& lit : iterate(clause)) {
       auto const lit_var = to_var_index(lit);
@@ -79,17 +119,28 @@ void propagate_gate(bitvector_map& assignment_by_var, gate<ClauseHandle> const&
         continue;
       }
 
-      bitvector& lit_var_assignments = assignment_by_var[lit_var];
-
-      if (is_positive(lit)) {
-        this_clause_satisfied |= lit_var_assignments;
-      }
-      else {
-        this_clause_satisfied |= ~lit_var_assignments;
+      if (num_operands == max_num_operands) {
+        if (!is_long_clause) {
+          clause_satisfied.fill(0);
+        }
+        kernels.or_operands(clause_satisfied.data(), operands, num_operands);
+        num_operands = 0;
+        is_long_clause = true;
       }
+
+      operands[num_operands].words =
+          assignment_by_var[var_index_map(lit_var)].get_words().data();
+      operands[num_operands].flip = is_positive(lit) ? 0 : ~uint64_t{0};
+      ++num_operands;
     }
 
-    output_forced_by_other_set &= this_clause_satisfied;
+    if (is_long_clause) {
+      kernels.or_operands(clause_satisfied.data(), operands, num_operands);
+      kernels.and_assign(output_forced_words, clause_satisfied.data());
+    }
+    else {
+      kernels.and_clause(output_forced_words, operands, num_operands);
+    }
   }
 
   // fwd clauses contain -gate.output, bwd clauses contain gate.output,
@@ -98,19 +149,33 @@ void propagate_gate(bitvector_map& assignment_by_var, gate<ClauseHandle> const&
   // the n'th bit of output_forced_by_other_set is 1 iff the n'th output
   // *literal* is negative.
   bool const fwd_forces_output = !clauses.is_iterating_fwd();
-  if ((fwd_forces_output && !is_positive(gate.output)) ||
-      (!fwd_forces_output && is_positive(gate.output))) {
-    assignment_by_var[out_var] = output_forced_by_other_set;
-  }
-  else {
-    assignment_by_var[out_var] = ~output_forced_by_other_set;
+  if (fwd_forces_output == is_positive(gate.output)) {
+    kernels.invert(output_forced_words);
   }
 }
 
+/**
+ * Propagates the given gate. The assignment of each variable `v` is stored
+ * in `assignment_by_var[var_index_map(v)]`.
+ */
+template <std::size_t Width, typename Gate, typename VarIndexMap = identity_var_index_map>
+void propagate_gate(basic_bitvector_map<Width>& assignment_by_var,
+                    Gate const& gate,
+                    VarIndexMap const& var_index_map = VarIndexMap{})
+{
+  propagate_gate(assignment_by_var,
+                 gate,
+                 var_index_map,
+                 get_bitvector_kernels<basic_bitvector<Width>::num_words>());
+}
+
 
-template <typename ClauseHandle>
-void propagate_structure(bitvector_map& assignment_by_var,
-                         gate_structure<ClauseHandle> const& structure)
+template <std::size_t Width,
+          typename ClauseHandle,
+          typename VarIndexMap = identity_var_index_map>
+void propagate_structure(basic_bitvector_map<Width>& assignment_by_var,
+                         gate_structure<ClauseHandle> const& structure,
+                         VarIndexMap const& var_index_map = VarIndexMap{})
 {
   std::vector<gate<ClauseHandle>> const& gates = structure.gates;
 
@@ -123,10 +188,235 @@ void propagate_structure(bitvector_map& assignment_by_var,
   //
   // Therefore, the assignment can be propagated by iterating backwards
   // through `gates`, with each gate forcing its output:
+  bitvector_kernels const& kernels = get_bitvector_kernels<basic_bitvector<Width>::num_words>();
   for (auto gate_iter = gates.rbegin(); gate_iter != gates.rend(); ++gate_iter) {
-    propagate_gate(assignment_by_var, *gate_iter);
+    propagate_gate(assignment_by_var, *gate_iter, var_index_map, kernels);
+  }
+}
+
+template <std::size_t Width,
+          typename ClauseHandle,
+          typename VarIndexMap = identity_var_index_map>
+void propagate_structure(basic_bitvector_map<Width>& assignment_by_var,
+                         flat_gate_structure<ClauseHandle> const& structure,
+                         VarIndexMap const& var_index_map = VarIndexMap{})
+{
+  flat_gate_list<ClauseHandle> const& gates = structure.gates;
+
+  // Like for gate_structure, the gates are propagated in reverse order
+  bitvector_kernels const& kernels = get_bitvector_kernels<basic_bitvector<Width>::num_words>();
+  for (std::size_t index = gates.size(); index > 0; --index) {
+    propagate_gate(assignment_by_var, gates[index - 1], var_index_map, kernels);
   }
 }
 
+
+/**
+ * \brief Partition of the gates of a gate structure into levels that can be
+ *        propagated independently
+ *
+ * Level 0 consists of the gates having no other gate's output among their
+ * clauses' variables. For n > 0, level n consists of the gates that read at
+ * least one output of a gate in level n-1, but none of the gates in level n
+ * and above. Propagating the levels in ascending order, with the gates in
+ * each level propagated in any order, yields the same assignment as
+ * propagate_structure(). Like propagate_structure(), this requires the
+ * gates to be in reverse topological order.
+ */
+class propagation_schedule {
+public:
+  propagation_schedule() = default;
+
+  template <typename ClauseHandle>
+  explicit propagation_schedule(gate_structure<ClauseHandle> const& structure)
+  {
+    compute(structure.gates);
+  }
+
+  template <typename ClauseHandle>
+  explicit propagation_schedule(flat_gate_structure<ClauseHandle> const& structure)
+  {
+    compute(structure.gates);
+  }
+
+  auto num_levels() const noexcept -> std::size_t { return m_level_offsets.size() - 1; }
+
+  /**
+   * Returns the indices of the gates in the given level, in descending order
+   */
+  auto get_level(std::size_t level) const noexcept -> span<std::size_t>
+  {
+    return span<std::size_t>{m_gate_indices.data() + m_level_offsets[level],
+                             m_gate_indices.data() + m_level_offsets[level + 1]};
+  }
+
+  auto get_max_level_size() const noexcept -> std::size_t { return m_max_level_size; }
+
+private:
+  template <typename Gates>
+  void compute(Gates const& gates)
+  {
+    std::size_t const num_gates = gates.size();
+
+    // level_by_var[v] is 1 + the level of the gate with output variable v, or 0
+    // if v is not the output of a gate propagated before the current gate
+    std::vector<std::size_t> level_by_var;
+    std::vector<std::size_t> level_by_gate(num_gates, 0);
+    std::size_t num_levels = 0;
+
+    for (std::size_t index = num_gates; index > 0; --index) {
+      auto const& gate = gates[index - 1];
+      std::size_t const out_var = to_var_index(gate.output);
+      std::size_t level = 0;
+
+      for (auto const& clause : gate.clauses) {
+        for (auto const& lit : iterate(clause)) {
+          std::size_t const var = to_var_index(lit);
+          if (var != out_var && var < level_by_var.size()) {
+            level = std::max(level, level_by_var[var]);
+          }
+        }
+      }
+
+      if (out_var >= level_by_var.size()) {
+        level_by_var.resize(out_var + 1, 0);
+      }
+      level_by_var[out_var] = level + 1;
+      level_by_gate[index - 1] = level;
+      num_levels = std::max(num_levels, level + 1);
+    }
+
+    // Sorting the gates by level, with a counting sort to keep the gates of
+    // each level in propagation order
+    m_level_offsets.assign(num_levels + 1, 0);
+    for (std::size_t level : level_by_gate) {
+      ++m_level_offsets[level + 1];
+    }
+
+    m_max_level_size = 0;
+    for (std::size_t level = 0; level < num_levels; ++level) {
+      m_max_level_size = std::max(m_max_level_size, m_level_offsets[level + 1]);
+      m_level_offsets[level + 1] += m_level_offsets[level];
+    }
+
+    m_gate_indices.resize(num_gates);
+    std::vector<std::size_t> insert_pos{m_level_offsets.begin(), m_level_offsets.end() - 1};
+    for (std::size_t index = num_gates; index > 0; --index) {
+      m_gate_indices[insert_pos[level_by_gate[index - 1]]++] = index - 1;
+    }
+  }
+
+  std::vector<std::size_t> m_gate_indices;
+  std::vector<std::size_t> m_level_offsets = std::vector<std::size_t>(1, 0);
+  std::size_t m_max_level_size = 0;
+};
+
+
+/**
+ * Returns the number of threads worth using for propagating the gates in
+ * `schedule`, at most `max_num_threads`.
+ */
+inline auto get_num_propagation_threads(propagation_schedule const& schedule,
+                                        std::size_t max_num_threads) -> std::size_t
+{
+  // Levels with fewer gates per thread are not worth the synchronization
+  std::size_t const min_gates_per_thread = 64;
+  return std::max<std::size_t>(
+      1, std::min(max_num_threads, schedule.get_max_level_size() / min_gates_per_thread));
+}
+
+/**
+ * Calls `propagate(gate_index)` for the indices of all gates in `schedule`,
+ * level by level. The gates of each level are distributed to the threads of
+ * `workers`, so `propagate` must only write state belonging to the given gate.
+ * If `propagate` throws, the remaining gates are skipped, and one of the
+ * exceptions is rethrown after all threads have finished.
+ */
+template <typename GatePropagator>
+void run_schedule(propagation_schedule const& schedule,
+                  worker_pool& workers,
+                  GatePropagator const& propagate)
+{
+  std::size_t const num_threads = workers.size();
+
+  if (num_threads <= 1) {
+    for (std::size_t level = 0; level < schedule.num_levels(); ++level) {
+      for (std::size_t gate_index : schedule.get_level(level)) {
+        propagate(gate_index);
+      }
+    }
+    return;
+  }
+
+  barrier level_done{num_threads};
+  std::atomic<bool> has_failed{false};
+
+  workers.run([&](std::size_t thread_index) {
+    // Threads need to arrive at the barrier of each level even after an
+    // exception, since the other threads would wait for them forever otherwise
+    std::exception_ptr error;
+
+    for (std::size_t level = 0; level < schedule.num_levels(); ++level) {
+      span<std::size_t> const level_gates = schedule.get_level(level);
+
+      // Gates are distributed to threads in contiguous chunks. Since each gate
+      // only writes to its own output's bitvector, the threads don't need to
+      // synchronize until the level is done
+      std::size_t const begin = level_gates.size() * thread_index / num_threads;
+      std::size_t const end = level_gates.size() * (thread_index + 1) / num_threads;
+      for (std::size_t idx = begin; idx < end && !has_failed.load(std::memory_order_relaxed);
+           ++idx) {
+        try {
+          propagate(level_gates[idx]);
+        }
+        catch (...) {
+          error = std::current_exception();
+          has_failed.store(true, std::memory_order_relaxed);
+        }
+      }
+
+      level_done.arrive_and_wait();
+    }
+
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  });
+}
+
+/**
+ * Like run_schedule(schedule, workers, propagate), with up to `num_threads`
+ * threads started for this call only. When propagating a structure
+ * repeatedly, the threads should be kept in a worker_pool instead.
+ */
+template <typename GatePropagator>
+void run_schedule(propagation_schedule const& schedule,
+                  std::size_t num_threads,
+                  GatePropagator const& propagate)
+{
+  worker_pool workers{get_num_propagation_threads(schedule, num_threads)};
+  run_schedule(schedule, workers, propagate);
+}
+
+/**
+ * Propagates the gates of the given structure in the order given by
+ * `schedule`, which must have been computed for `structure`. The gates of
+ * each level are distributed to up to `num_threads` threads. The result is
+ * the same as for propagate_structure(assignment_by_var, structure, var_index_map).
+ */
+template <std::size_t Width, typename Structure, typename VarIndexMap = identity_var_index_map>
+void propagate_structure(basic_bitvector_map<Width>& assignment_by_var,
+                         Structure const& structure,
+                         propagation_schedule const& schedule,
+                         std::size_t num_threads,
+                         VarIndexMap const& var_index_map = VarIndexMap{})
+{
+  auto const& gates = structure.gates;
+  bitvector_kernels const& kernels = get_bitvector_kernels<basic_bitvector<Width>::num_words>();
+  run_schedule(schedule, num_threads, [&](std::size_t gate_index) {
+    propagate_gate(assignment_by_var, gates[gate_index], var_index_map, kernels);
+  });
+}
+
 }
 }
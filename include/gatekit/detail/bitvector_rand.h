@@ -1,6 +1,7 @@
 #pragma once
 
 #include <gatekit/detail/bitvector.h>
+#include <gatekit/detail/bitvector_kernels.h>
 #include <gatekit/detail/utils.h>
 
 #include <numeric>
@@ -9,24 +10,27 @@
 namespace gatekit {
 namespace detail {
 
-inline void randomize_bv(bitvector& target, uint64_t additional)
+template <std::size_t Width>
+void randomize_bv(basic_bitvector<Width>& target, uint64_t additional)
 {
-  for (auto& word : target.get_words()) {
-    word = xorshift_star(word + additional);
-  }
+  using kernel_bitvector = basic_bitvector<Width>;
+  get_bitvector_kernels<kernel_bitvector::num_words>().randomize(target.get_words().data(),
+                                                                 additional);
 }
 
-inline void thicken_bv(bitvector& target, uint64_t additional)
+template <std::size_t Width>
+void thicken_bv(basic_bitvector<Width>& target, uint64_t additional)
 {
-  for (auto& word : target.get_words()) {
-    word |= xorshift_star(word + additional);
-  }
+  using kernel_bitvector = basic_bitvector<Width>;
+  get_bitvector_kernels<kernel_bitvector::num_words>().thicken(target.get_words().data(),
+                                                               additional);
 }
 
 
-class bitvector_randomizer {
+template <std::size_t Width>
+class basic_bitvector_randomizer {
 public:
-  void randomize(bitvector& target, uint32_t bias_exponent)
+  void randomize(basic_bitvector<Width>& target, uint32_t bias_exponent)
   {
     assert(bias_exponent > 0);
 
@@ -42,5 +46,7 @@ private:
   uint64_t m_seed = 0xe73526b9;
 };
 
+using bitvector_randomizer = basic_bitvector_randomizer<default_simulation_width>;
+
 }
 }
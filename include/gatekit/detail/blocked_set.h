@@ -4,6 +4,11 @@
 #include <gatekit/detail/clause_utils.h>
 #include <gatekit/detail/occurrence_list.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
 namespace gatekit {
 namespace detail {
 
@@ -44,5 +49,193 @@ auto is_blocked(typename OccList::lit lit, OccList const& clauses) -> bool
   return true;
 }
 
+
+/**
+ * Checks literals for blockedness in time linear in the size of the checked
+ * clauses (per pair of clauses), returning the same results as is_blocked().
+ *
+ * For each clause C containing -lit, the literals of C are marked in a
+ * per-literal stamp array. A resolvent of C and a clause D containing lit
+ * is then tautologic iff D contains a literal whose negation is stamped,
+ * which can be checked in O(|D|). Stamps are invalidated by incrementing
+ * the current stamp value, so the stamp array does not need to be cleared
+ * between checks.
+ *
+ * Additionally, each clause is summarized in a 64-bit literal signature.
+ * If the signature of C has no bit in common with the signature of the
+ * negated literals of D, the resolvent of C and D cannot be tautologic,
+ * and the check fails without accessing the literals of D.
+ *
+ * Objects of this type can be reused for arbitrarily many checks. The stamp
+ * array grows on demand.
+ */
+template <typename Lit>
+class blocked_set_checker {
+public:
+  template <typename OccList>
+  auto is_blocked(Lit lit, OccList const& clauses) -> bool
+  {
+    return is_blocked(lit, clauses[negate(lit)], clauses[lit]);
+  }
+
+  /**
+   * Checks if `lit` is blocked in the given clauses, with `fwd_clauses` containing
+   * `-lit` and `bwd_clauses` containing `lit`.
+   */
+  template <typename FwdClauses, typename BwdClauses>
+  auto is_blocked(Lit lit, FwdClauses const& fwd_clauses, BwdClauses const& bwd_clauses) -> bool
+  {
+    return is_blocked_impl(lit, fwd_clauses, bwd_clauses, no_excluded_clause{});
+  }
+
+  /**
+   * Like is_blocked(lit, fwd_clauses, bwd_clauses), but ignores the clauses
+   * in `bwd_clauses` that are equal to `excluded`. This avoids copying the
+   * remaining clauses when checking if `lit` would be blocked after removing
+   * a clause.
+   */
+  template <typename FwdClauses, typename BwdClauses, typename ClauseHandle>
+  auto is_blocked_without(Lit lit,
+                          FwdClauses const& fwd_clauses,
+                          BwdClauses const& bwd_clauses,
+                          ClauseHandle const& excluded) -> bool
+  {
+    return is_blocked_impl(lit, fwd_clauses, bwd_clauses, excluded_clause<ClauseHandle>{excluded});
+  }
+
+private:
+  struct no_excluded_clause {
+    template <typename ClauseHandle>
+    constexpr auto operator()(ClauseHandle const&) const noexcept -> bool
+    {
+      return false;
+    }
+  };
+
+  template <typename ClauseHandle>
+  struct excluded_clause {
+    ClauseHandle const& clause;
+
+    auto operator()(ClauseHandle const& other) const -> bool { return other == clause; }
+  };
+
+  /**
+   * Implements is_blocked() for the clauses in `bwd_clauses` for which
+   * `is_excluded` returns false.
+   */
+  template <typename FwdClauses, typename BwdClauses, typename IsExcluded>
+  auto is_blocked_impl(Lit lit,
+                       FwdClauses const& fwd_clauses,
+                       BwdClauses const& bwd_clauses,
+                       IsExcluded const& is_excluded) -> bool
+  {
+    if (fwd_clauses.empty() || bwd_clauses.empty()) {
+      return true;
+    }
+
+    std::size_t const resolution_idx = to_var_index(lit);
+
+    m_bwd_signatures.clear();
+    for (auto const& bwd_clause : bwd_clauses) {
+      if (is_excluded(bwd_clause)) {
+        continue;
+      }
+
+      uint64_t signature = 0;
+      for (auto const& bwd_lit : iterate(bwd_clause)) {
+        if (to_var_index(bwd_lit) != resolution_idx) {
+          signature |= get_signature(negate(bwd_lit));
+        }
+      }
+
+      if (signature == 0) {
+        // The resolvent with any clause is not tautologic
+        return false;
+      }
+
+      m_bwd_signatures.push_back(signature);
+    }
+
+    if (m_bwd_signatures.empty()) {
+      return true;
+    }
+
+    for (auto const& fwd_clause : fwd_clauses) {
+      uint64_t const fwd_signature = stamp_literals(fwd_clause, resolution_idx);
+
+      std::size_t bwd_clause_idx = 0;
+      for (auto const& bwd_clause : bwd_clauses) {
+        if (is_excluded(bwd_clause)) {
+          continue;
+        }
+
+        if ((fwd_signature & m_bwd_signatures[bwd_clause_idx++]) == 0) {
+          return false;
+        }
+
+        if (!has_stamped_negation(bwd_clause, resolution_idx)) {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  static auto get_signature(Lit literal) -> uint64_t
+  {
+    return uint64_t{1} << (to_index(literal) % 64);
+  }
+
+  template <typename ClauseHandle>
+  auto stamp_literals(ClauseHandle const& clause, std::size_t resolution_idx) -> uint64_t
+  {
+    if (m_current_stamp == std::numeric_limits<uint32_t>::max()) {
+      std::fill(m_stamps.begin(), m_stamps.end(), 0);
+      m_current_stamp = 0;
+    }
+    ++m_current_stamp;
+
+    uint64_t signature = 0;
+
+    for (auto const& literal : iterate(clause)) {
+      if (to_var_index(literal) == resolution_idx) {
+        continue;
+      }
+
+      std::size_t const index = to_index(literal);
+      if (index >= m_stamps.size()) {
+        m_stamps.resize(max_index(literal) + 1, 0);
+      }
+
+      m_stamps[index] = m_current_stamp;
+      signature |= get_signature(literal);
+    }
+
+    return signature;
+  }
+
+  template <typename ClauseHandle>
+  auto has_stamped_negation(ClauseHandle const& clause, std::size_t resolution_idx) const -> bool
+  {
+    for (auto const& literal : iterate(clause)) {
+      if (to_var_index(literal) == resolution_idx) {
+        continue;
+      }
+
+      std::size_t const index = to_index(negate(literal));
+      if (index < m_stamps.size() && m_stamps[index] == m_current_stamp) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  std::vector<uint32_t> m_stamps;
+  uint32_t m_current_stamp = 0;
+  std::vector<uint64_t> m_bwd_signatures;
+};
+
 }
 }
@@ -10,44 +10,38 @@ namespace detail {
 template <typename Lit>
 auto to_index(Lit lit) -> std::size_t
 {
-  int const dimacs_lit = lit_to_dimacs(lit);
-  if (dimacs_lit > 0) {
-    return 2 * (dimacs_lit - 1);
-  }
-  else {
-    return (-2 * (dimacs_lit + 1)) + 1;
-  }
+  return lit_traits<Lit>::to_index(lit);
 }
 
 template <typename Lit>
 auto to_var_index(Lit lit) -> std::size_t
 {
-  int const dimacs_lit = lit_to_dimacs(lit);
-  return (dimacs_lit > 0 ? dimacs_lit : -dimacs_lit) - 1;
+  return lit_traits<Lit>::to_var_index(lit);
 }
 
 template <typename Lit>
 auto is_positive(Lit lit) -> bool
 {
-  return lit_to_dimacs(lit) > 0;
+  return lit_traits<Lit>::is_positive(lit);
 }
 
 template <typename Lit>
 auto to_lit(std::size_t var_index, bool positive) -> Lit
 {
-  return dimacs_to_lit<Lit>(static_cast<int>((var_index + 1) * (positive ? 1 : -1)));
+  return lit_traits<Lit>::to_lit(var_index, positive);
 }
 
 template <typename Lit>
 auto negate(Lit lit) -> Lit
 {
-  return dimacs_to_lit<Lit>(-lit_to_dimacs(lit));
+  return lit_traits<Lit>::negate(lit);
 }
 
 template <typename Lit>
 auto max_index(Lit lit) -> std::size_t
 {
-  return std::max(to_index(lit), to_index(negate(lit)));
+  // The negative literal of a variable has the greater index
+  return 2 * to_var_index(lit) + 1;
 }
 
 template <typename ClauseHandle>
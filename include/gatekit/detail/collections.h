@@ -4,7 +4,9 @@
 #include <gatekit/detail/clause_utils.h>
 
 #include <cassert>
+#include <algorithm>
 #include <cstdint>
+#include <limits>
 #include <vector>
 
 namespace gatekit {
@@ -13,8 +15,22 @@ namespace detail {
 template <typename Lit>
 class literal_set {
 public:
+  literal_set() = default;
+
   explicit literal_set(std::size_t max_index) { m_is_contained.resize(max_index + 2); }
 
+  /**
+   * Extends the range of literals that can be added to the set, such that it
+   * covers all literals with indices up to `max_index`. The set's contents are
+   * not changed, and the range is never shrunk.
+   */
+  void grow(std::size_t max_index)
+  {
+    if (m_is_contained.size() < max_index + 2) {
+      m_is_contained.resize(max_index + 2);
+    }
+  }
+
   void add(Lit literal)
   {
     assert(to_index(literal) < m_is_contained.size());
@@ -65,5 +81,102 @@ private:
   std::vector<bool> m_is_contained;
 };
 
+
+/**
+ * Set of indices (e.g. of variables) that can be cleared in constant time:
+ * an index is contained iff its stamp equals the current epoch. The index
+ * range grows on demand, so after warming up, neither mark() nor clear()
+ * allocate memory.
+ */
+class index_marks {
+public:
+  void clear() noexcept
+  {
+    if (m_epoch == std::numeric_limits<uint32_t>::max()) {
+      std::fill(m_stamps.begin(), m_stamps.end(), 0);
+      m_epoch = 0;
+    }
+    ++m_epoch;
+  }
+
+  /**
+   * Adds `index` to the set. Returns true iff it has not been contained before.
+   */
+  auto mark(std::size_t index) -> bool
+  {
+    if (index >= m_stamps.size()) {
+      m_stamps.resize(index + 1, 0);
+    }
+
+    if (m_stamps[index] == m_epoch) {
+      return false;
+    }
+
+    m_stamps[index] = m_epoch;
+    return true;
+  }
+
+  auto is_marked(std::size_t index) const noexcept -> bool
+  {
+    return index < m_stamps.size() && m_stamps[index] == m_epoch;
+  }
+
+private:
+  std::vector<uint32_t> m_stamps;
+
+  // Stamps are initialized with 0, so the epoch is never 0
+  uint32_t m_epoch = 1;
+};
+
+
+/**
+ * Counts how often each literal has been added. In contrast to literal_set,
+ * literals can be removed again, and the index range grows on demand.
+ */
+template <typename Lit>
+class literal_multiset {
+public:
+  void add(Lit literal)
+  {
+    std::size_t const index = to_index(literal);
+    if (index >= m_counts.size()) {
+      m_counts.resize(max_index(literal) + 1);
+    }
+
+    ++m_counts[index];
+  }
+
+  void add_all(std::vector<Lit> const& literals)
+  {
+    for (Lit const& literal : literals) {
+      add(literal);
+    }
+  }
+
+  void remove(Lit literal)
+  {
+    assert(contains(literal));
+    --m_counts[to_index(literal)];
+  }
+
+  void remove_all(std::vector<Lit> const& literals)
+  {
+    for (Lit const& literal : literals) {
+      remove(literal);
+    }
+  }
+
+  auto count(Lit const& literal) const noexcept -> std::size_t
+  {
+    std::size_t const index = to_index(literal);
+    return index < m_counts.size() ? m_counts[index] : 0;
+  }
+
+  auto contains(Lit const& literal) const noexcept -> bool { return count(literal) != 0; }
+
+private:
+  std::vector<uint32_t> m_counts;
+};
+
 }
 }
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <gatekit/detail/clause_utils.h>
+#include <gatekit/detail/utils.h>
+
+#include <gatekit/clause.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace gatekit {
+namespace detail {
+
+/**
+ * Occurrence list in compressed-sparse-row layout, with the same interface as
+ * occurrence_list as far as it is used by the scanner.
+ *
+ * The occurrences of all literals are stored in a single array, with the
+ * occurrences of each literal forming a contiguous segment. Clauses can only
+ * be added if they have been removed via remove() before, so segments never
+ * grow beyond their initial size.
+ *
+ * Removed clauses are marked in a per-clause bitmap. Each segment is compacted
+ * lazily when the occurrences of its literal are accessed, and only if clauses
+ * have been removed from it since the last compaction.
+ */
+template <typename ClauseHandle>
+class csr_occurrence_list {
+public:
+  using lit = typename clause_funcs<ClauseHandle>::lit;
+  using clause_handle = ClauseHandle;
+  using occurrence_vec = span<ClauseHandle>;
+
+  template <typename ClauseHandleIter>
+  csr_occurrence_list(ClauseHandleIter start, ClauseHandleIter stop)
+  {
+    std::size_t num_clauses = 0;
+
+    for (ClauseHandleIter clause = start; clause != stop; ++clause) {
+      for (lit literal : iterate(*clause)) {
+        if (m_num_removed.size() <= max_index(literal)) {
+          m_num_removed.resize(max_index(literal) + 1);
+        }
+
+        // m_num_removed temporarily holds the occurrence counts
+        ++m_num_removed[to_index(literal)];
+      }
+
+      ++num_clauses;
+    }
+
+    assert(num_clauses <= std::numeric_limits<uint32_t>::max());
+
+    std::size_t const num_lits = m_num_removed.size();
+    m_offsets.resize(num_lits + 1);
+    m_ends.resize(num_lits);
+
+    for (std::size_t index = 0; index < num_lits; ++index) {
+      m_offsets[index + 1] = m_offsets[index] + m_num_removed[index];
+      m_ends[index] = m_offsets[index];
+      m_num_removed[index] = 0;
+    }
+
+    m_handles.resize(m_offsets.back());
+    m_ids.resize(m_offsets.back());
+    m_is_removed.resize(num_clauses, false);
+
+    uint32_t clause_id = 0;
+    for (ClauseHandleIter clause = start; clause != stop; ++clause, ++clause_id) {
+      for (lit literal : iterate(*clause)) {
+        std::size_t const position = m_ends[to_index(literal)]++;
+        m_handles[position] = *clause;
+        m_ids[position] = clause_id;
+      }
+
+      if (get_size(*clause) == 1) {
+        m_unaries.push_back(get_lit(*clause, 0));
+      }
+    }
+  }
+
+
+  auto operator[](lit const& literal) const -> span<ClauseHandle>
+  {
+    std::size_t const index = to_index(literal);
+
+    if (index >= m_ends.size()) {
+      return span<ClauseHandle>{};
+    }
+
+    if (m_num_removed[index] != 0) {
+      compact(index);
+    }
+
+    return span<ClauseHandle>{m_handles.data() + m_offsets[index],
+                                     m_handles.data() + m_ends[index]};
+  }
+
+
+  auto get_max_lit_index() const noexcept -> std::size_t
+  {
+    return m_ends.empty() ? 0 : (m_ends.size() - 1);
+  }
+
+  auto get_unaries() const noexcept -> std::vector<lit> const& { return m_unaries; }
+
+  void remove_gate_root(lit output)
+  {
+    std::size_t const fwd_index = to_index(output);
+    std::size_t const bwd_index = to_index(negate(output));
+
+    remove_all_in_segment(fwd_index);
+    remove_all_in_segment(bwd_index);
+
+    m_ends[fwd_index] = m_offsets[fwd_index];
+    m_ends[bwd_index] = m_offsets[bwd_index];
+    m_num_removed[fwd_index] = 0;
+    m_num_removed[bwd_index] = 0;
+  }
+
+  void remove_unary(lit unary)
+  {
+    std::size_t const index = to_index(unary);
+
+    for (std::size_t position = m_offsets[index]; position < m_ends[index]; ++position) {
+      if (!m_is_removed[m_ids[position]] && get_size(m_handles[position]) == 1) {
+        m_is_removed[m_ids[position]] = true;
+
+        std::size_t const last = m_ends[index] - 1;
+        m_handles[position] = m_handles[last];
+        m_ids[position] = m_ids[last];
+        m_ends[index] = last;
+        break;
+      }
+    }
+
+    unstable_erase_first(m_unaries, unary);
+  }
+
+  /**
+   * Removes a single clause. Since the clause needs to be looked up in the
+   * occurrences of its first literal, this is slower than remove_gate_root().
+   */
+  void remove(ClauseHandle clause)
+  {
+    std::size_t const index = to_index(get_lit(clause, 0));
+
+    for (std::size_t position = m_offsets[index]; position < m_ends[index]; ++position) {
+      uint32_t const id = m_ids[position];
+      if (m_is_removed[id] || !(m_handles[position] == clause)) {
+        continue;
+      }
+
+      m_is_removed[id] = true;
+      for (lit literal : iterate(clause)) {
+        ++m_num_removed[to_index(literal)];
+      }
+
+      if (get_size(clause) == 1) {
+        unstable_erase_first(m_unaries, get_lit(clause, 0));
+      }
+
+      m_detached.push_back(std::make_pair(clause, id));
+      return;
+    }
+  }
+
+  /**
+   * Adds a clause that has been removed via remove() before.
+   */
+  void add(ClauseHandle clause)
+  {
+    auto const detached = std::find_if(
+        m_detached.rbegin(), m_detached.rend(), [&clause](detached_clause const& candidate) {
+          return candidate.first == clause;
+        });
+    assert(detached != m_detached.rend());
+
+    uint32_t const id = detached->second;
+    m_detached.erase(std::next(detached).base());
+
+    // Dropping the tombstoned occurrences first, so that there is room for
+    // the clause at the end of each segment
+    for (lit literal : iterate(clause)) {
+      std::size_t const index = to_index(literal);
+      if (m_num_removed[index] != 0) {
+        compact(index);
+      }
+    }
+
+    m_is_removed[id] = false;
+
+    for (lit literal : iterate(clause)) {
+      std::size_t const index = to_index(literal);
+      assert(m_ends[index] < m_offsets[index + 1]);
+
+      m_handles[m_ends[index]] = clause;
+      m_ids[m_ends[index]] = id;
+      ++m_ends[index];
+    }
+
+    if (get_size(clause) == 1) {
+      m_unaries.push_back(get_lit(clause, 0));
+    }
+  }
+
+  auto empty() const -> bool
+  {
+    // This function is only used for testing ~> not optimized
+    for (std::size_t index = 0; index < m_ends.size(); ++index) {
+      if (!(*this)[to_lit<lit>(index / 2, index % 2 == 0)].empty()) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  auto get_estimated_lookup_cost(lit literal) const noexcept -> std::size_t
+  {
+    return m_num_removed[to_index(literal)] + m_num_removed[to_index(negate(literal))];
+  }
+
+  auto get_num_pending_removals(lit literal) const noexcept -> std::size_t
+  {
+    std::size_t const index = to_index(literal);
+    return index < m_num_removed.size() ? m_num_removed[index] : 0;
+  }
+
+private:
+  void remove_all_in_segment(std::size_t index)
+  {
+    for (std::size_t position = m_offsets[index]; position < m_ends[index]; ++position) {
+      uint32_t const id = m_ids[position];
+      if (m_is_removed[id]) {
+        continue;
+      }
+
+      m_is_removed[id] = true;
+      for (lit literal : iterate(m_handles[position])) {
+        ++m_num_removed[to_index(literal)];
+      }
+
+      if (get_size(m_handles[position]) == 1) {
+        unstable_erase_first(m_unaries, get_lit(m_handles[position], 0));
+      }
+    }
+  }
+
+  void compact(std::size_t index) const
+  {
+    std::size_t const stop = m_ends[index];
+    std::size_t new_end = m_offsets[index];
+
+    for (std::size_t position = m_offsets[index]; position < stop; ++position) {
+      if (!m_is_removed[m_ids[position]]) {
+        m_handles[new_end] = m_handles[position];
+        m_ids[new_end] = m_ids[position];
+        ++new_end;
+      }
+    }
+
+    m_ends[index] = new_end;
+    m_num_removed[index] = 0;
+  }
+
+  // The occurrences of the literal with index i are stored in
+  // m_handles[m_offsets[i]] to m_handles[m_ends[i] - 1]. m_ids contains the
+  // clause indices of the handles, which are used to look up m_is_removed.
+  std::vector<std::size_t> m_offsets;
+
+  // Segments are compacted in operator[], which is const (since it does not
+  // change observable state), so the following members need to be mutable.
+  mutable std::vector<std::size_t> m_ends;
+  mutable std::vector<ClauseHandle> m_handles;
+  mutable std::vector<uint32_t> m_ids;
+
+  // For each literal: the number of removed clauses still contained in its segment
+  mutable std::vector<uint32_t> m_num_removed;
+
+  std::vector<bool> m_is_removed;
+  std::vector<lit> m_unaries;
+
+  // Clauses removed via remove(), with their clause indices
+  using detached_clause = std::pair<ClauseHandle, uint32_t>;
+  std::vector<detached_clause> m_detached;
+};
+
+}
+}
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <gatekit/clause_arena.h>
+#include <gatekit/detail/threads.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace gatekit {
+namespace detail {
+
+struct dimacs_chunk {
+  // Literals preceding the first clause terminator of the chunk. These belong
+  // to a clause starting in a preceding chunk (or are the first clause).
+  std::vector<int32_t> head;
+  bool has_terminator = false;
+
+  // Clauses starting and ending in this chunk, in clause_arena layout
+  std::vector<int32_t> clauses;
+  std::size_t num_clauses = 0;
+
+  // Literals following the last clause terminator of the chunk
+  std::vector<int32_t> tail;
+
+  std::size_t max_var = 0;
+  bool has_end_marker = false;
+
+  // Error thrown while parsing the chunk. Since the input following the end
+  // marker is ignored, the error is only reported if no preceding chunk
+  // contains the end marker.
+  std::exception_ptr error;
+};
+
+inline auto is_dimacs_space(char character) noexcept -> bool
+{
+  return character == ' ' || character == '\n' || character == '\t' || character == '\r' ||
+         character == '\v' || character == '\f';
+}
+
+inline auto skip_line(char const* position, char const* stop) noexcept -> char const*
+{
+  while (position != stop && *position != '\n') {
+    ++position;
+  }
+  return position;
+}
+
+inline auto parse_dimacs_chunk(char const* start, char const* stop) -> dimacs_chunk
+{
+  dimacs_chunk result;
+
+  std::vector<int32_t>& out = result.clauses;
+  out.push_back(0);
+  std::size_t clause_start = 0;
+
+  char const* position = start;
+  while (position != stop) {
+    char const current = *position;
+
+    if (is_dimacs_space(current)) {
+      ++position;
+      continue;
+    }
+
+    if (current == 'c' || current == 'p') {
+      position = skip_line(position, stop);
+      continue;
+    }
+
+    if (current == '%') {
+      // End of problem marker used by some benchmark collections
+      result.has_end_marker = true;
+      break;
+    }
+
+    bool const is_negative = (current == '-');
+    if (is_negative) {
+      ++position;
+    }
+
+    char const* const digits_start = position;
+    int64_t value = 0;
+    while (position != stop && *position >= '0' && *position <= '9') {
+      value = 10 * value + (*position - '0');
+      if (value > std::numeric_limits<int32_t>::max()) {
+        throw std::runtime_error{"gatekit: DIMACS literal out of range"};
+      }
+      ++position;
+    }
+
+    if (position == digits_start || (position != stop && !is_dimacs_space(*position))) {
+      throw std::runtime_error{"gatekit: invalid token in DIMACS input"};
+    }
+
+    if (value == 0) {
+      if (!result.has_terminator) {
+        result.head.assign(out.begin() + 1, out.end());
+        out.resize(1);
+        result.has_terminator = true;
+      }
+      else {
+        out[clause_start] = static_cast<int32_t>(out.size() - clause_start - 1);
+        ++result.num_clauses;
+        clause_start = out.size();
+        out.push_back(0);
+      }
+    }
+    else {
+      out.push_back(static_cast<int32_t>(is_negative ? -value : value));
+      result.max_var = std::max(result.max_var, static_cast<std::size_t>(value));
+    }
+  }
+
+  if (!result.has_terminator) {
+    result.head.assign(out.begin() + 1, out.end());
+    out.clear();
+  }
+  else {
+    result.tail.assign(out.begin() + clause_start + 1, out.end());
+    out.resize(clause_start);
+  }
+
+  return result;
+}
+
+
+inline auto parse_dimacs_header_num_vars(char const* start, char const* stop) -> std::size_t
+{
+  char const* position = start;
+
+  while (position != stop) {
+    if (is_dimacs_space(*position)) {
+      ++position;
+    }
+    else if (*position == 'c') {
+      position = skip_line(position, stop);
+    }
+    else if (*position == 'p') {
+      char const* const line_end = skip_line(position, stop);
+      char const* field = position + 1;
+
+      // Skipping the format field ("cnf")
+      while (field != line_end && is_dimacs_space(*field)) {
+        ++field;
+      }
+      while (field != line_end && !is_dimacs_space(*field)) {
+        ++field;
+      }
+      while (field != line_end && is_dimacs_space(*field)) {
+        ++field;
+      }
+
+      std::size_t result = 0;
+      while (field != line_end && *field >= '0' && *field <= '9') {
+        result = 10 * result + static_cast<std::size_t>(*field - '0');
+        ++field;
+      }
+      return result;
+    }
+    else {
+      return 0;
+    }
+  }
+
+  return 0;
+}
+
+
+inline auto get_dimacs_chunk_bounds(char const* start, char const* stop, std::size_t num_chunks)
+    -> std::vector<char const*>
+{
+  // Chunks are aligned to line starts, since comment lines need to be
+  // recognized by their first character
+  std::size_t const size = static_cast<std::size_t>(stop - start);
+
+  std::vector<char const*> result = {start};
+  for (std::size_t chunk = 1; chunk < num_chunks; ++chunk) {
+    char const* bound = std::max(start + chunk * (size / num_chunks), result.back());
+    bound = skip_line(bound, stop);
+    if (bound != stop) {
+      ++bound;
+    }
+    result.push_back(bound);
+  }
+  result.push_back(stop);
+
+  return result;
+}
+
+
+inline void append_clause(std::vector<int32_t>& target, std::vector<int32_t> const& literals)
+{
+  target.push_back(static_cast<int32_t>(literals.size()));
+  target.insert(target.end(), literals.begin(), literals.end());
+}
+
+
+inline auto merge_dimacs_chunks(std::vector<dimacs_chunk>& chunks, std::size_t num_declared_vars)
+    -> clause_arena
+{
+  std::size_t total_size = 0;
+  for (dimacs_chunk const& chunk : chunks) {
+    total_size += chunk.head.size() + chunk.clauses.size() + chunk.tail.size() + 1;
+  }
+
+  std::vector<int32_t> data;
+  data.reserve(total_size + 1);
+
+  std::size_t num_clauses = 0;
+  std::size_t num_vars = num_declared_vars;
+  std::vector<int32_t> carry;
+
+  for (dimacs_chunk& chunk : chunks) {
+    if (chunk.error) {
+      std::rethrow_exception(chunk.error);
+    }
+
+    num_vars = std::max(num_vars, chunk.max_var);
+    carry.insert(carry.end(), chunk.head.begin(), chunk.head.end());
+
+    if (chunk.has_terminator) {
+      append_clause(data, carry);
+      ++num_clauses;
+
+      data.insert(data.end(), chunk.clauses.begin(), chunk.clauses.end());
+      num_clauses += chunk.num_clauses;
+
+      carry = std::move(chunk.tail);
+    }
+
+    bool const has_end_marker = chunk.has_end_marker;
+    chunk = dimacs_chunk{};
+
+    if (has_end_marker) {
+      break;
+    }
+  }
+
+  if (!carry.empty()) {
+    // Tolerating a missing terminator for the last clause
+    append_clause(data, carry);
+    ++num_clauses;
+  }
+
+  return clause_arena{std::move(data), num_clauses, num_vars};
+}
+
+
+inline auto parse_dimacs_chunked(char const* start, char const* stop, std::size_t num_chunks)
+    -> clause_arena
+{
+  std::vector<char const*> const bounds = get_dimacs_chunk_bounds(start, stop, num_chunks);
+  std::vector<dimacs_chunk> chunks(num_chunks);
+
+  run_in_parallel(num_chunks, [&bounds, &chunks](std::size_t chunk) {
+    try {
+      chunks[chunk] = parse_dimacs_chunk(bounds[chunk], bounds[chunk + 1]);
+    }
+    catch (std::runtime_error const&) {
+      chunks[chunk].error = std::current_exception();
+    }
+  });
+
+  return merge_dimacs_chunks(chunks, parse_dimacs_header_num_vars(start, stop));
+}
+
+}
+}
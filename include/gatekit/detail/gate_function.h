@@ -0,0 +1,341 @@
+#pragma once
+
+#include <gatekit/detail/utils.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+namespace gatekit {
+namespace detail {
+
+/**
+ * Clause of a gate with at most 64 inputs, represented as bitmasks over the
+ * gate's sorted input variables. Bit i of `positive` (`negative`) is set iff
+ * the clause contains the i-th input variable positively (negatively). The
+ * output literal is not represented.
+ */
+struct clause_bitmask {
+  uint64_t positive;
+  uint64_t negative;
+};
+
+inline auto operator<(clause_bitmask const& lhs, clause_bitmask const& rhs) noexcept -> bool
+{
+  return lhs.positive < rhs.positive ||
+         (lhs.positive == rhs.positive && lhs.negative < rhs.negative);
+}
+
+
+constexpr std::size_t max_truth_table_inputs = 12;
+
+
+/**
+ * Returns the word with index `word_idx` of the truth table of the
+ * `input_idx`-th input variable, with bit j of word w corresponding to
+ * the input assignment 64*w + j.
+ */
+inline auto get_input_truth_table_word(std::size_t input_idx, std::size_t word_idx) noexcept
+    -> uint64_t
+{
+  static uint64_t const patterns[6] = {0xAAAAAAAAAAAAAAAAull,
+                                       0xCCCCCCCCCCCCCCCCull,
+                                       0xF0F0F0F0F0F0F0F0ull,
+                                       0xFF00FF00FF00FF00ull,
+                                       0xFFFF0000FFFF0000ull,
+                                       0xFFFFFFFF00000000ull};
+
+  if (input_idx < 6) {
+    return patterns[input_idx];
+  }
+
+  return ((word_idx >> (input_idx - 6)) & 1) != 0 ? ~uint64_t{0} : uint64_t{0};
+}
+
+
+/**
+ * Computes the word with index `word_idx` of the truth table of the
+ * input assignments for which at least one of the given clauses propagates
+ * its output literal, ie. for which all other literals of the clause are
+ * false.
+ */
+inline auto get_propagating_assignments_word(std::vector<clause_bitmask> const& clauses,
+                                             std::size_t num_inputs,
+                                             std::size_t word_idx) noexcept -> uint64_t
+{
+  uint64_t result = 0;
+
+  for (clause_bitmask const& clause : clauses) {
+    uint64_t propagating = ~uint64_t{0};
+
+    for (std::size_t input_idx = 0; input_idx < num_inputs; ++input_idx) {
+      uint64_t const bit = uint64_t{1} << input_idx;
+
+      if ((clause.positive & bit) != 0) {
+        propagating &= ~get_input_truth_table_word(input_idx, word_idx);
+      }
+      else if ((clause.negative & bit) != 0) {
+        propagating &= get_input_truth_table_word(input_idx, word_idx);
+      }
+    }
+
+    result |= propagating;
+  }
+
+  return result;
+}
+
+
+/**
+ * Returns true iff for each assignment of the `num_inputs` inputs, exactly
+ * one of the clause sets `fwd` and `bwd` propagates the output, ie. iff
+ * the clauses define the output as a total function of the inputs.
+ *
+ * The truth tables are evaluated 64 input assignments at a time.
+ */
+inline auto is_total_function(std::vector<clause_bitmask> const& fwd,
+                              std::vector<clause_bitmask> const& bwd,
+                              std::size_t num_inputs) -> bool
+{
+  assert(num_inputs <= max_truth_table_inputs);
+
+  std::size_t const num_words = num_inputs <= 6 ? 1 : (std::size_t{1} << (num_inputs - 6));
+  uint64_t const used_bits =
+      num_inputs >= 6 ? ~uint64_t{0} : ((uint64_t{1} << (uint64_t{1} << num_inputs)) - 1);
+
+  for (std::size_t word_idx = 0; word_idx < num_words; ++word_idx) {
+    uint64_t const fwd_word = get_propagating_assignments_word(fwd, num_inputs, word_idx);
+    uint64_t const bwd_word = get_propagating_assignments_word(bwd, num_inputs, word_idx);
+
+    if (((fwd_word ^ bwd_word) & used_bits) != used_bits) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+/**
+ * Buffers used for computing NPN keys, which can be reused across computations
+ * to avoid allocations
+ */
+struct npn_key_scratch {
+  std::vector<std::size_t> num_pos;
+  std::vector<std::size_t> num_neg;
+  std::vector<std::size_t> num_first;
+  std::vector<std::size_t> order;
+  std::vector<clause_bitmask> normalized;
+};
+
+
+/**
+ * Computes the NPN key of get_npn_key() for a fixed output polarity, with
+ * `first` being the clause set placed first in the key. The key is stored
+ * in `result`.
+ */
+inline void compute_np_key(std::vector<clause_bitmask> const& first,
+                           std::vector<clause_bitmask> const& second,
+                           std::size_t num_inputs,
+                           npn_key_scratch& scratch,
+                           std::vector<uint64_t>& result)
+{
+  std::vector<std::size_t>& num_pos = scratch.num_pos;
+  std::vector<std::size_t>& num_neg = scratch.num_neg;
+  std::vector<std::size_t>& num_first = scratch.num_first;
+
+  num_pos.assign(num_inputs, 0);
+  num_neg.assign(num_inputs, 0);
+  num_first.assign(num_inputs, 0);
+
+  for (std::vector<clause_bitmask> const* side : {&first, &second}) {
+    for (clause_bitmask const& clause : *side) {
+      for (std::size_t input_idx = 0; input_idx < num_inputs; ++input_idx) {
+        uint64_t const bit = uint64_t{1} << input_idx;
+        num_pos[input_idx] += (clause.positive & bit) != 0 ? 1 : 0;
+        num_neg[input_idx] += (clause.negative & bit) != 0 ? 1 : 0;
+        if (side == &first && ((clause.positive | clause.negative) & bit) != 0) {
+          ++num_first[input_idx];
+        }
+      }
+    }
+  }
+
+  uint64_t negated_inputs = 0;
+  for (std::size_t input_idx = 0; input_idx < num_inputs; ++input_idx) {
+    if (num_neg[input_idx] > num_pos[input_idx]) {
+      negated_inputs |= uint64_t{1} << input_idx;
+      std::swap(num_neg[input_idx], num_pos[input_idx]);
+    }
+  }
+
+  std::vector<std::size_t>& order = scratch.order;
+  order.resize(num_inputs);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs) -> bool {
+    if (num_pos[lhs] != num_pos[rhs]) {
+      return num_pos[lhs] > num_pos[rhs];
+    }
+    if (num_neg[lhs] != num_neg[rhs]) {
+      return num_neg[lhs] > num_neg[rhs];
+    }
+    return num_first[lhs] > num_first[rhs];
+  });
+
+  auto normalize = [&](clause_bitmask const& clause) -> clause_bitmask {
+    clause_bitmask const negated = {(clause.positive & ~negated_inputs) |
+                                        (clause.negative & negated_inputs),
+                                    (clause.negative & ~negated_inputs) |
+                                        (clause.positive & negated_inputs)};
+    clause_bitmask result = {0, 0};
+    for (std::size_t new_idx = 0; new_idx < num_inputs; ++new_idx) {
+      uint64_t const old_bit = uint64_t{1} << order[new_idx];
+      uint64_t const new_bit = uint64_t{1} << new_idx;
+      result.positive |= (negated.positive & old_bit) != 0 ? new_bit : 0;
+      result.negative |= (negated.negative & old_bit) != 0 ? new_bit : 0;
+    }
+    return result;
+  };
+
+  result.clear();
+  result.push_back(num_inputs);
+  result.push_back(first.size());
+
+  std::vector<clause_bitmask>& normalized = scratch.normalized;
+  for (std::vector<clause_bitmask> const* side : {&first, &second}) {
+    normalized.clear();
+    std::transform(side->begin(), side->end(), std::back_inserter(normalized), normalize);
+    std::sort(normalized.begin(), normalized.end());
+
+    for (clause_bitmask const& clause : normalized) {
+      result.push_back(clause.positive);
+      result.push_back(clause.negative);
+    }
+  }
+}
+
+
+inline auto get_np_key(std::vector<clause_bitmask> const& first,
+                       std::vector<clause_bitmask> const& second,
+                       std::size_t num_inputs) -> std::vector<uint64_t>
+{
+  npn_key_scratch scratch;
+  std::vector<uint64_t> result;
+  compute_np_key(first, second, num_inputs, scratch, result);
+  return result;
+}
+
+
+/**
+ * Computes a key for the given gate encoding such that encodings with equal
+ * keys are equivalent modulo negating inputs, permuting inputs and negating
+ * the output (NPN equivalence). Since is_total_function() is invariant under
+ * these transformations, its result can be cached by key.
+ *
+ * The key is computed by normalizing the encoding heuristically: inputs are
+ * negated such that they occur at least as often positively as negatively,
+ * and are then ordered by their occurrence counts. The output is negated
+ * such that the clause set with fewer clauses comes first, or such that the
+ * key is minimal if both sets have the same size. Encodings that are
+ * NPN-equivalent but have ties in the input criteria can end up with
+ * different keys, which only costs cache hits.
+ *
+ * `alt_key` is used as a buffer for the key with the other output polarity.
+ */
+inline void compute_npn_key(std::vector<clause_bitmask> const& fwd,
+                            std::vector<clause_bitmask> const& bwd,
+                            std::size_t num_inputs,
+                            npn_key_scratch& scratch,
+                            std::vector<uint64_t>& result,
+                            std::vector<uint64_t>& alt_key)
+{
+  if (fwd.size() < bwd.size()) {
+    compute_np_key(fwd, bwd, num_inputs, scratch, result);
+    return;
+  }
+
+  if (bwd.size() < fwd.size()) {
+    compute_np_key(bwd, fwd, num_inputs, scratch, result);
+    return;
+  }
+
+  compute_np_key(fwd, bwd, num_inputs, scratch, result);
+  compute_np_key(bwd, fwd, num_inputs, scratch, alt_key);
+  if (alt_key < result) {
+    result.swap(alt_key);
+  }
+}
+
+
+inline auto get_npn_key(std::vector<clause_bitmask> const& fwd,
+                        std::vector<clause_bitmask> const& bwd,
+                        std::size_t num_inputs) -> std::vector<uint64_t>
+{
+  npn_key_scratch scratch;
+  std::vector<uint64_t> result;
+  std::vector<uint64_t> alt_key;
+  compute_npn_key(fwd, bwd, num_inputs, scratch, result, alt_key);
+  return result;
+}
+
+
+struct npn_key_hash {
+  auto operator()(std::vector<uint64_t> const& key) const noexcept -> std::size_t
+  {
+    uint64_t result = key.size();
+    for (uint64_t word : key) {
+      result = xorshift_star(result ^ word);
+    }
+    return static_cast<std::size_t>(result);
+  }
+};
+
+
+/**
+ * Cache of is_total_function() results, keyed by get_npn_key(). Encodings
+ * of the same function tend to be repeated very often in CNF instances
+ * generated from circuits, so most checks are answered by a single lookup.
+ */
+class gate_function_cache {
+public:
+  auto is_total_function(std::vector<clause_bitmask> const& fwd,
+                         std::vector<clause_bitmask> const& bwd,
+                         std::size_t num_inputs) -> bool
+  {
+    // The key is computed in reused buffers, so only cache misses allocate memory
+    compute_npn_key(fwd, bwd, num_inputs, m_scratch, m_key, m_alt_key);
+
+    auto const cached = m_verdicts.find(m_key);
+    if (cached != m_verdicts.end()) {
+      return cached->second;
+    }
+
+    bool const result = detail::is_total_function(fwd, bwd, num_inputs);
+
+    if (m_verdicts.size() >= max_size) {
+      m_verdicts.clear();
+    }
+    m_verdicts.emplace(m_key, result);
+
+    return result;
+  }
+
+  auto size() const noexcept -> std::size_t { return m_verdicts.size(); }
+
+private:
+  static constexpr std::size_t max_size = 1 << 16;
+
+  std::unordered_map<std::vector<uint64_t>, bool, npn_key_hash> m_verdicts;
+
+  npn_key_scratch m_scratch;
+  std::vector<uint64_t> m_key;
+  std::vector<uint64_t> m_alt_key;
+};
+
+}
+}
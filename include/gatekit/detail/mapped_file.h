@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GATEKIT_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gatekit {
+namespace detail {
+
+/**
+ * Read-only view of a file's contents. The file is memory-mapped on
+ * POSIX systems, and read into memory otherwise.
+ */
+class mapped_file {
+public:
+  explicit mapped_file(std::string const& path)
+  {
+#if defined(GATEKIT_HAS_MMAP)
+    int const fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error{"gatekit: could not open " + path};
+    }
+
+    struct stat file_stat;
+    if (::fstat(fd, &file_stat) != 0) {
+      ::close(fd);
+      throw std::runtime_error{"gatekit: could not stat " + path};
+    }
+
+    m_size = static_cast<std::size_t>(file_stat.st_size);
+
+    if (m_size > 0) {
+      void* const mapping = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      ::close(fd);
+
+      if (mapping == MAP_FAILED) {
+        throw std::runtime_error{"gatekit: could not map " + path};
+      }
+
+      ::madvise(mapping, m_size, MADV_SEQUENTIAL);
+      m_data = static_cast<char const*>(mapping);
+    }
+    else {
+      ::close(fd);
+    }
+#else
+    std::ifstream file{path, std::ios::binary};
+    if (!file) {
+      throw std::runtime_error{"gatekit: could not open " + path};
+    }
+
+    m_buffer.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+#endif
+  }
+
+  ~mapped_file()
+  {
+#if defined(GATEKIT_HAS_MMAP)
+    if (m_data != nullptr) {
+      ::munmap(const_cast<char*>(m_data), m_size);
+    }
+#endif
+  }
+
+  mapped_file(mapped_file const&) = delete;
+  auto operator=(mapped_file const&) -> mapped_file& = delete;
+
+  auto begin() const noexcept -> char const* { return m_data; }
+
+  auto end() const noexcept -> char const* { return m_data + m_size; }
+
+  auto size() const noexcept -> std::size_t { return m_size; }
+
+private:
+  char const* m_data = nullptr;
+  std::size_t m_size = 0;
+
+#if !defined(GATEKIT_HAS_MMAP)
+  std::vector<char> m_buffer;
+#endif
+};
+
+}
+}
@@ -54,6 +54,19 @@ public:
 
   auto get_unaries() const noexcept -> std::vector<lit> const& { return m_unaries; }
 
+  void add(ClauseHandle clause)
+  {
+    for (lit literal : iterate(clause)) {
+      if (to_index(literal) < m_occ_lists_by_lit.size()) {
+        // The clause might be pending removal if it has been removed before
+        erase_clauses_to_remove(to_index(literal));
+        m_occ_lists_by_lit[to_index(literal)].is_sorted = false;
+      }
+    }
+
+    add_clause(clause);
+  }
+
   void remove(ClauseHandle clause)
   {
     // m_clauses_by_lit is not updated eagerly: since the occurrence list can
@@ -133,6 +146,13 @@ public:
            m_occ_lists_by_lit[to_index(negate(literal))].clauses_to_remove.size();
   }
 
+  auto get_num_pending_removals(lit literal) const noexcept -> std::size_t
+  {
+    std::size_t const index = to_index(literal);
+    return index < m_occ_lists_by_lit.size() ? m_occ_lists_by_lit[index].clauses_to_remove.size()
+                                             : 0;
+  }
+
 private:
   template <typename ClauseHandleIter>
   auto get_occurrence_counts(ClauseHandleIter start, ClauseHandleIter stop)
@@ -172,7 +192,7 @@ private:
       std::size_t const lit_index = to_index(literal);
 
       if (m_occ_lists_by_lit.size() <= max_index(literal)) {
-        m_occ_lists_by_lit.resize(max_index(lit_index) + 1);
+        m_occ_lists_by_lit.resize(max_index(literal) + 1);
       }
 
       m_occ_lists_by_lit[lit_index].clauses.emplace_back(clause);
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <utility>
+
+namespace gatekit {
+namespace detail {
+
+/**
+ * Scan budget that is never exhausted. All checks are optimized away.
+ */
+struct unlimited_scan_budget {
+  constexpr auto consume_step() const noexcept -> bool { return true; }
+
+  constexpr auto is_exhausted() const noexcept -> bool { return false; }
+};
+
+
+/**
+ * Limits the effort spent by the scanner. The budget is exhausted when the
+ * maximum number of steps has been consumed, when the deadline has passed,
+ * or when the cancellation callback returns true.
+ *
+ * Since reading the clock and calling the callback is relatively costly
+ * compared to single steps, these limits are only checked every
+ * `check_interval` steps, and for the first step.
+ */
+class scan_budget {
+public:
+  using clock = std::chrono::steady_clock;
+
+  static constexpr uint64_t check_interval = 64;
+
+  scan_budget(uint64_t max_steps, clock::time_point deadline, std::function<bool()> is_cancelled)
+    : m_remaining_steps(max_steps), m_deadline(deadline), m_is_cancelled(std::move(is_cancelled))
+  {
+  }
+
+  /**
+   * Returns true iff another step may be performed, and consumes it.
+   */
+  auto consume_step() -> bool
+  {
+    if (m_is_exhausted) {
+      return false;
+    }
+
+    if (m_remaining_steps == 0) {
+      m_is_exhausted = true;
+      return false;
+    }
+
+    if (m_num_consumed_steps % check_interval == 0 && is_time_up()) {
+      m_is_exhausted = true;
+      return false;
+    }
+
+    --m_remaining_steps;
+    ++m_num_consumed_steps;
+    return true;
+  }
+
+  auto is_exhausted() const noexcept -> bool { return m_is_exhausted; }
+
+  auto get_num_consumed_steps() const noexcept -> uint64_t { return m_num_consumed_steps; }
+
+private:
+  auto is_time_up() const -> bool
+  {
+    if (m_is_cancelled && m_is_cancelled()) {
+      return true;
+    }
+
+    return m_deadline != clock::time_point::max() && clock::now() >= m_deadline;
+  }
+
+  uint64_t m_remaining_steps;
+  uint64_t m_num_consumed_steps = 0;
+  clock::time_point m_deadline;
+  std::function<bool()> m_is_cancelled;
+  bool m_is_exhausted = false;
+};
+
+
+/**
+ * Limits the effort spent by multiple scanners running concurrently. The
+ * steps are taken from a common pool, and the budget of all scanners is
+ * exhausted as soon as one of them runs out of steps or time.
+ *
+ * The cancellation callback is called from the scanning threads, but never
+ * concurrently.
+ */
+class shared_scan_limits {
+public:
+  using clock = std::chrono::steady_clock;
+
+  shared_scan_limits(uint64_t max_steps,
+                     clock::time_point deadline,
+                     std::function<bool()> is_cancelled)
+    : m_is_step_limited(max_steps != std::numeric_limits<uint64_t>::max())
+    , m_remaining_steps(max_steps)
+    , m_deadline(deadline)
+    , m_is_cancelled(std::move(is_cancelled))
+  {
+  }
+
+  shared_scan_limits(shared_scan_limits const&) = delete;
+  auto operator=(shared_scan_limits const&) -> shared_scan_limits& = delete;
+
+  /**
+   * Returns true iff a step has been taken from the pool.
+   */
+  auto try_take_step() noexcept -> bool
+  {
+    if (!m_is_step_limited) {
+      return true;
+    }
+
+    uint64_t remaining = m_remaining_steps.load(std::memory_order_relaxed);
+    do {
+      if (remaining == 0) {
+        return false;
+      }
+    } while (!m_remaining_steps.compare_exchange_weak(
+        remaining, remaining - 1, std::memory_order_relaxed));
+
+    return true;
+  }
+
+  auto is_time_up() -> bool
+  {
+    if (m_is_cancelled) {
+      std::lock_guard<std::mutex> lock{m_cancellation_mutex};
+      if (m_is_cancelled()) {
+        return true;
+      }
+    }
+
+    return m_deadline != clock::time_point::max() && clock::now() >= m_deadline;
+  }
+
+  void set_exhausted() noexcept { m_is_exhausted.store(true, std::memory_order_relaxed); }
+
+  auto is_exhausted() const noexcept -> bool
+  {
+    return m_is_exhausted.load(std::memory_order_relaxed);
+  }
+
+private:
+  bool m_is_step_limited;
+  std::atomic<uint64_t> m_remaining_steps;
+  std::atomic<bool> m_is_exhausted{false};
+  clock::time_point m_deadline;
+  std::function<bool()> m_is_cancelled;
+  std::mutex m_cancellation_mutex;
+};
+
+
+/**
+ * Budget of a single scanner drawing from `shared_scan_limits`. Like
+ * `scan_budget`, the time limits are only checked every `check_interval`
+ * steps, and for the first step.
+ */
+class shared_scan_budget {
+public:
+  static constexpr uint64_t check_interval = 64;
+
+  explicit shared_scan_budget(shared_scan_limits& limits) noexcept : m_limits(&limits) {}
+
+  /**
+   * Returns true iff another step may be performed, and consumes it.
+   */
+  auto consume_step() -> bool
+  {
+    if (m_limits->is_exhausted()) {
+      return false;
+    }
+
+    if (m_num_consumed_steps % check_interval == 0 && m_limits->is_time_up()) {
+      m_limits->set_exhausted();
+      return false;
+    }
+
+    if (!m_limits->try_take_step()) {
+      m_limits->set_exhausted();
+      return false;
+    }
+
+    ++m_num_consumed_steps;
+    return true;
+  }
+
+  auto is_exhausted() const noexcept -> bool { return m_limits->is_exhausted(); }
+
+private:
+  shared_scan_limits* m_limits;
+  uint64_t m_num_consumed_steps = 0;
+};
+
+}
+}
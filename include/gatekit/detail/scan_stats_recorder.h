@@ -0,0 +1,184 @@
+#pragma once
+
+#include <gatekit/scan_options.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace gatekit {
+namespace detail {
+
+enum class gate_failure { empty_fwd, not_blocked, input_mismatch, no_pattern };
+
+
+/**
+ * Stats recorder that does not record anything. All calls are optimized
+ * away, so uninstrumented scans have no overhead.
+ */
+struct null_stats_recorder {
+  template <typename OccList>
+  using occurrence_list = OccList;
+
+  struct timer {
+  };
+
+  template <typename OccList>
+  void attach(OccList&) const noexcept
+  {
+  }
+
+  auto start_timer() const noexcept -> timer { return timer{}; }
+
+  void on_try_get_gate() const noexcept {}
+
+  void on_failure(gate_failure) const noexcept {}
+
+  void on_blockedness_checked(timer) const noexcept {}
+
+  void on_matchers_finished(timer) const noexcept {}
+
+  void on_erase_batch(std::size_t, timer) const noexcept {}
+
+  void on_bfs_finished(std::size_t) const noexcept {}
+};
+
+
+template <typename OccList, typename Recorder>
+class instrumented_occurrence_list;
+
+
+/**
+ * Adds the statistics in `source` to `target`, as if both had been collected
+ * in the same object. The per-root values of `source` are appended.
+ */
+inline void add_stats(scan_stats& target, scan_stats const& source)
+{
+  target.num_try_get_gate_calls += source.num_try_get_gate_calls;
+  target.num_failed_empty_fwd += source.num_failed_empty_fwd;
+  target.num_failed_blockedness += source.num_failed_blockedness;
+  target.num_failed_input_mismatch += source.num_failed_input_mismatch;
+  target.num_failed_pattern += source.num_failed_pattern;
+  target.num_erase_batches += source.num_erase_batches;
+  target.total_erase_batch_size += source.total_erase_batch_size;
+  target.max_erase_batch_size = std::max(target.max_erase_batch_size, source.max_erase_batch_size);
+  target.erase_time += source.erase_time;
+  target.blockedness_time += source.blockedness_time;
+  target.matcher_time += source.matcher_time;
+  target.num_bfs_rounds_per_root.insert(target.num_bfs_rounds_per_root.end(),
+                                        source.num_bfs_rounds_per_root.begin(),
+                                        source.num_bfs_rounds_per_root.end());
+}
+
+
+/**
+ * Stats recorder writing to a scan_stats object
+ */
+class stats_recorder {
+public:
+  template <typename OccList>
+  using occurrence_list = instrumented_occurrence_list<OccList, stats_recorder>;
+
+  using timer = std::chrono::steady_clock::time_point;
+
+  stats_recorder() = default;
+
+  explicit stats_recorder(scan_stats& stats) noexcept : m_stats(&stats) {}
+
+  template <typename OccList>
+  void attach(OccList& occs) const noexcept
+  {
+    occs.set_recorder(*this);
+  }
+
+  auto start_timer() const noexcept -> timer { return std::chrono::steady_clock::now(); }
+
+  void on_try_get_gate() const noexcept { ++m_stats->num_try_get_gate_calls; }
+
+  void on_failure(gate_failure failure) const noexcept
+  {
+    switch (failure) {
+    case gate_failure::empty_fwd:
+      ++m_stats->num_failed_empty_fwd;
+      break;
+    case gate_failure::not_blocked:
+      ++m_stats->num_failed_blockedness;
+      break;
+    case gate_failure::input_mismatch:
+      ++m_stats->num_failed_input_mismatch;
+      break;
+    case gate_failure::no_pattern:
+      ++m_stats->num_failed_pattern;
+      break;
+    }
+  }
+
+  void on_blockedness_checked(timer start) const noexcept
+  {
+    m_stats->blockedness_time += get_time_since(start);
+  }
+
+  void on_matchers_finished(timer start) const noexcept
+  {
+    m_stats->matcher_time += get_time_since(start);
+  }
+
+  void on_erase_batch(std::size_t size, timer start) const noexcept
+  {
+    m_stats->erase_time += get_time_since(start);
+    ++m_stats->num_erase_batches;
+    m_stats->total_erase_batch_size += size;
+    m_stats->max_erase_batch_size = std::max<uint64_t>(m_stats->max_erase_batch_size, size);
+  }
+
+  void on_bfs_finished(std::size_t num_rounds) const
+  {
+    m_stats->num_bfs_rounds_per_root.push_back(num_rounds);
+  }
+
+private:
+  static auto get_time_since(timer start) noexcept -> std::chrono::nanoseconds
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start);
+  }
+
+  scan_stats* m_stats = nullptr;
+};
+
+
+/**
+ * Occurrence list recording the lazy erasure of removed clauses, which
+ * happens when the occurrences of a literal are accessed. OccList needs to
+ * provide get_num_pending_removals(). The recorder needs to be set before
+ * the occurrences are accessed.
+ */
+template <typename OccList, typename Recorder>
+class instrumented_occurrence_list : public OccList {
+public:
+  using OccList::OccList;
+
+  void set_recorder(Recorder recorder) { m_recorder = recorder; }
+
+  auto operator[](typename OccList::lit const& literal) const
+      -> decltype(std::declval<OccList const&>()[literal])
+  {
+    std::size_t const num_pending = OccList::get_num_pending_removals(literal);
+    if (num_pending == 0) {
+      return OccList::operator[](literal);
+    }
+
+    typename Recorder::timer const start = m_recorder.start_timer();
+    auto&& result = OccList::operator[](literal);
+    m_recorder.on_erase_batch(num_pending, start);
+    return result;
+  }
+
+private:
+  Recorder m_recorder;
+};
+
+}
+}
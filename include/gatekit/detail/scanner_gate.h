@@ -2,21 +2,61 @@
 
 #include <gatekit/detail/blocked_set.h>
 #include <gatekit/detail/clause_utils.h>
+#include <gatekit/detail/collections.h>
+#include <gatekit/detail/gate_function.h>
 #include <gatekit/detail/occurrence_list.h>
+#include <gatekit/detail/scan_stats_recorder.h>
 #include <gatekit/detail/utils.h>
 
 #include <gatekit/clause.h>
 #include <gatekit/gate.h>
 
 #include <algorithm>
+#include <cassert>
+#include <cstdint>
 #include <vector>
 
 namespace gatekit {
 namespace detail {
 
+/**
+ * Buffers used for recognizing gates, reused across gate recognition attempts.
+ * Once the buffers have grown to their working size, rejecting a candidate
+ * gate does not allocate memory.
+ */
+template <typename Lit>
+struct gate_matcher_workspace {
+  // Input variables of the current candidate gate
+  index_marks fwd_vars;
+  index_marks bwd_vars;
+  std::vector<std::size_t> inputs;
+
+  // Bitmask representations of the current candidate's clauses
+  std::vector<clause_bitmask> fwd_masks;
+  std::vector<clause_bitmask> bwd_masks;
+
+  // Input literals of recognized gates
+  index_marks input_lits;
+  std::vector<Lit> input_lits_buffer;
+
+  // Candidate outputs of the breadth-first search for gates
+  literal_set<Lit> next_candidates;
+  std::vector<Lit> current_candidates;
+};
+
+
+/**
+ * Computes the input variables of the gate candidate with output `output`,
+ * i.e. the variables other than the output occurring in its clauses, and stores
+ * them in ascending order in `workspace.inputs`.
+ *
+ * Returns false if the forward and backward clauses don't have the same
+ * variables, or if they don't have any variables besides the output.
+ */
 template <typename OccList>
-auto try_get_gate_inputs(typename OccList::lit const& output, OccList const& clauses)
-    -> std::vector<std::size_t>
+auto try_get_gate_inputs(typename OccList::lit const& output,
+                         OccList const& clauses,
+                         gate_matcher_workspace<typename OccList::lit>& workspace) -> bool
 {
   // Assumption: `output` is blocked
   //
@@ -26,68 +66,76 @@ auto try_get_gate_inputs(typename OccList::lit const& output, OccList const& cla
 
   using lit = typename OccList::lit;
 
-  auto const& fwd_clauses = clauses[negate(output)];
-  auto const& bwd_clauses = clauses[output];
-
-  std::vector<std::size_t> fwd_vars;
-  std::vector<std::size_t> bwd_vars;
+  std::vector<std::size_t>& inputs = workspace.inputs;
+  inputs.clear();
+  workspace.fwd_vars.clear();
+  workspace.bwd_vars.clear();
 
   std::size_t const output_var_index = to_var_index(output);
 
-  for (auto const& fwd_clause : fwd_clauses) {
+  for (auto const& fwd_clause : clauses[negate(output)]) {
     for (lit const& fwd_lit : iterate(fwd_clause)) {
       std::size_t const fwd_var_index = to_var_index(fwd_lit);
 
-      if (fwd_var_index != output_var_index) {
-        if (std::find(fwd_vars.begin(), fwd_vars.end(), fwd_var_index) == fwd_vars.end()) {
-          fwd_vars.push_back(fwd_var_index);
-        }
+      if (fwd_var_index != output_var_index && workspace.fwd_vars.mark(fwd_var_index)) {
+        inputs.push_back(fwd_var_index);
       }
     }
   }
 
-  for (auto const& bwd_clause : bwd_clauses) {
+  std::size_t num_bwd_vars = 0;
+
+  for (auto const& bwd_clause : clauses[output]) {
     for (lit const& bwd_lit : iterate(bwd_clause)) {
       std::size_t const bwd_var_index = to_var_index(bwd_lit);
 
       if (bwd_var_index != output_var_index) {
-        if (std::find(bwd_vars.begin(), bwd_vars.end(), bwd_var_index) == bwd_vars.end()) {
-          bwd_vars.push_back(bwd_var_index);
+        if (!workspace.fwd_vars.is_marked(bwd_var_index)) {
+          return false;
+        }
+
+        if (workspace.bwd_vars.mark(bwd_var_index)) {
+          ++num_bwd_vars;
         }
       }
     }
   }
 
-  if (fwd_vars.size() != bwd_vars.size()) {
-    return {};
+  if (inputs.empty() || num_bwd_vars != inputs.size()) {
+    return false;
   }
 
-  std::sort(fwd_vars.begin(), fwd_vars.end());
-  std::sort(bwd_vars.begin(), bwd_vars.end());
+  std::sort(inputs.begin(), inputs.end());
+  return true;
+}
 
-  if (fwd_vars == bwd_vars) {
-    return fwd_vars;
-  }
-  else {
+
+template <typename OccList>
+auto try_get_gate_inputs(typename OccList::lit const& output, OccList const& clauses)
+    -> std::vector<std::size_t>
+{
+  gate_matcher_workspace<typename OccList::lit> workspace;
+  if (!try_get_gate_inputs(output, clauses, workspace)) {
     return {};
   }
+  return workspace.inputs;
 }
 
-template <typename ClauseHandle>
-auto are_all_of_size(std::vector<ClauseHandle> const& clauses, std::size_t size) -> bool
+template <typename ClauseRange>
+auto are_all_of_size(ClauseRange const& clauses, std::size_t size) -> bool
 {
-  return std::all_of(clauses.begin(), clauses.end(), [size](ClauseHandle const& clause) {
+  return std::all_of(clauses.begin(), clauses.end(), [size](decltype(*clauses.begin()) clause) {
     return get_size(clause) == size;
   });
 }
 
-template <typename ClauseHandle>
-auto get_num_covered_input_combinations(std::vector<ClauseHandle> const& clauses,
-                                        std::size_t num_inputs) -> uint64_t
+template <typename ClauseRange>
+auto get_num_covered_input_combinations(ClauseRange const& clauses, std::size_t num_inputs)
+    -> uint64_t
 {
   uint64_t result = 0;
 
-  for (ClauseHandle clause : clauses) {
+  for (auto const& clause : clauses) {
     result += 1ull << (num_inputs + 1 - get_size(clause));
   }
 
@@ -109,16 +157,16 @@ auto is_joined_clause_taut(ClauseHandle const& lhs, ClauseHandle const& rhs) ->
 }
 
 
-template <typename ClauseHandle>
-auto are_pairwise_joined_clauses_all_taut(std::vector<ClauseHandle> const& clauses,
-                                          std::size_t num_inputs) -> bool
+template <typename ClauseRange>
+auto are_pairwise_joined_clauses_all_taut(ClauseRange const& clauses, std::size_t num_inputs)
+    -> bool
 {
-  for (ClauseHandle const& lhs : clauses) {
+  for (auto const& lhs : clauses) {
     if (get_size(lhs) == num_inputs + 1) {
       continue;
     }
 
-    for (ClauseHandle const& rhs : clauses) {
+    for (auto const& rhs : clauses) {
       if (&lhs == &rhs || get_size(rhs) == num_inputs + 1) {
         continue;
       }
@@ -133,10 +181,107 @@ auto are_pairwise_joined_clauses_all_taut(std::vector<ClauseHandle> const& claus
 }
 
 
+/**
+ * Computes the bitmask representations of `clauses` relative to the sorted
+ * input variables `inputs`, appending them to `result`.
+ *
+ * Returns false if some clause cannot be represented faithfully, ie. if it
+ * contains a variable more than once, does not contain the output variable
+ * exactly once, or contains a variable that is not an input. In that case,
+ * `result` is left in an unspecified state.
+ */
+template <typename ClauseRange, typename Lit>
+auto try_get_clause_bitmasks(ClauseRange const& clauses,
+                             Lit const& output,
+                             std::vector<std::size_t> const& inputs,
+                             std::vector<clause_bitmask>& result) -> bool
+{
+  assert(inputs.size() <= 64);
+  assert(std::is_sorted(inputs.begin(), inputs.end()));
+
+  std::size_t const output_var_index = to_var_index(output);
+
+  for (auto const& clause : clauses) {
+    clause_bitmask mask = {0, 0};
+    std::size_t num_output_lits = 0;
+
+    for (auto const& literal : iterate(clause)) {
+      std::size_t const var_index = to_var_index(literal);
+      if (var_index == output_var_index) {
+        ++num_output_lits;
+        continue;
+      }
+
+      auto const input_pos = std::lower_bound(inputs.begin(), inputs.end(), var_index);
+      if (input_pos == inputs.end() || *input_pos != var_index) {
+        return false;
+      }
+
+      uint64_t const bit = uint64_t{1} << (input_pos - inputs.begin());
+      (is_positive(literal) ? mask.positive : mask.negative) |= bit;
+    }
+
+    // With exactly one output literal, the check of the input count rules out
+    // repeated input variables
+    if (num_output_lits != 1 || popcount(mask.positive | mask.negative) + 1 != get_size(clause) ||
+        (mask.positive & mask.negative) != 0) {
+      return false;
+    }
+
+    result.push_back(mask);
+  }
+
+  return true;
+}
+
+
+inline auto get_num_covered_input_combinations(std::vector<clause_bitmask> const& clauses,
+                                               std::size_t num_inputs) -> uint64_t
+{
+  uint64_t result = 0;
+
+  for (clause_bitmask const& clause : clauses) {
+    result += 1ull << (num_inputs - popcount(clause.positive | clause.negative));
+  }
+
+  return result;
+}
+
+
+inline auto are_pairwise_joined_clauses_all_taut(std::vector<clause_bitmask> const& clauses,
+                                                 std::size_t num_inputs) -> bool
+{
+  // Full clauses are skipped, like in the generic variant of this function
+  for (std::size_t lhs_idx = 0; lhs_idx < clauses.size(); ++lhs_idx) {
+    clause_bitmask const& lhs = clauses[lhs_idx];
+    if (popcount(lhs.positive | lhs.negative) == num_inputs) {
+      continue;
+    }
+
+    // Since tautologicity of the joined clause is symmetric, checking each
+    // unordered pair once suffices
+    for (std::size_t rhs_idx = lhs_idx + 1; rhs_idx < clauses.size(); ++rhs_idx) {
+      clause_bitmask const& rhs = clauses[rhs_idx];
+      if (popcount(rhs.positive | rhs.negative) == num_inputs) {
+        continue;
+      }
+
+      if (((lhs.positive & rhs.negative) | (lhs.negative & rhs.positive)) == 0) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+
 template <typename OccList>
 auto is_full_gate_or_ssr_optimized(typename OccList::lit const& output,
                                    OccList const& clauses,
-                                   std::vector<size_t> const& inputs) -> bool
+                                   std::vector<size_t> const& inputs,
+                                   gate_matcher_workspace<typename OccList::lit>& workspace)
+    -> bool
 {
   // Detect gates in which each input assignment causes exactly one clause
   // to propagate the output. XOR gates and gates with one clause for each
@@ -158,23 +303,42 @@ auto is_full_gate_or_ssr_optimized(typename OccList::lit const& output,
   // tautologic for each two distinct clauses A, B in the gate encoding,
   // each input causes a single gate in the clause to propagate the output.
 
-  using ClauseHandle = typename OccList::clause_handle;
-
-  std::vector<ClauseHandle> const& fwd = clauses[negate(output)];
-  std::vector<ClauseHandle> const& bwd = clauses[output];
+  auto const& fwd = clauses[negate(output)];
+  auto const& bwd = clauses[output];
   std::size_t const num_inputs = inputs.size();
 
   if (num_inputs <= 63) {
     uint64_t const num_total_input_combinations = (1ull << num_inputs);
+
+    // If a clause contains A contains x and B contains -x, they
+    // cannot propagate their output literal at the same time. fwd
+    // and bwd can be checked separately because blockedness already
+    // guarantees right-uniqueness.
+    //
+    // For clauses that can be represented as bitmasks over the inputs, all
+    // checks reduce to a few bitwise operations per clause (pair). Otherwise,
+    // the checks are performed on the literals.
+    std::vector<clause_bitmask>& fwd_masks = workspace.fwd_masks;
+    std::vector<clause_bitmask>& bwd_masks = workspace.bwd_masks;
+    fwd_masks.clear();
+    bwd_masks.clear();
+
+    if (try_get_clause_bitmasks(fwd, output, inputs, fwd_masks) &&
+        try_get_clause_bitmasks(bwd, output, inputs, bwd_masks)) {
+      uint64_t const num_covered_input_combinations =
+          get_num_covered_input_combinations(fwd_masks, num_inputs) +
+          get_num_covered_input_combinations(bwd_masks, num_inputs);
+
+      return num_covered_input_combinations == num_total_input_combinations &&
+             are_pairwise_joined_clauses_all_taut(fwd_masks, num_inputs) &&
+             are_pairwise_joined_clauses_all_taut(bwd_masks, num_inputs);
+    }
+
     uint64_t const num_covered_input_combinations =
         get_num_covered_input_combinations(fwd, num_inputs) +
         get_num_covered_input_combinations(bwd, num_inputs);
 
     if (num_covered_input_combinations == num_total_input_combinations) {
-      // If a clause contains A contains x and B contains -x, they
-      // cannot propagate their output literal at the same time. fwd
-      // and bwd can be checked separately because blockedness already
-      // guarantees right-uniqueness.
       if (are_pairwise_joined_clauses_all_taut(fwd, num_inputs) &&
           are_pairwise_joined_clauses_all_taut(bwd, num_inputs)) {
         return true;
@@ -186,14 +350,14 @@ auto is_full_gate_or_ssr_optimized(typename OccList::lit const& output,
 }
 
 
-template <typename ClauseHandle>
-auto get_clause_sizes_if_same_length(std::vector<ClauseHandle> const& clauses) -> std::size_t
+template <typename ClauseRange>
+auto get_clause_sizes_if_same_length(ClauseRange const& clauses) -> std::size_t
 {
   if (clauses.empty()) {
     return 0;
   }
 
-  std::size_t result = get_size(clauses.front());
+  std::size_t result = get_size(*clauses.begin());
 
   for (auto const& clause : clauses) {
     if (get_size(clause) != result) {
@@ -210,10 +374,8 @@ auto is_at_least_k_gate(typename OccList::lit const& output,
                         OccList const& clauses,
                         std::vector<size_t> const& inputs) -> bool
 {
-  using ClauseHandle = typename OccList::clause_handle;
-
-  std::vector<ClauseHandle> const& fwd = clauses[negate(output)];
-  std::vector<ClauseHandle> const& bwd = clauses[output];
+  auto const& fwd = clauses[negate(output)];
+  auto const& bwd = clauses[output];
 
   std::size_t const fwd_clause_size = get_clause_sizes_if_same_length(fwd);
   if (fwd_clause_size == 0) {
@@ -240,38 +402,100 @@ auto is_at_least_k_gate(typename OccList::lit const& output,
 
 
 template <typename OccList>
+auto is_total_function_gate(typename OccList::lit const& output,
+                            OccList const& clauses,
+                            std::vector<size_t> const& inputs,
+                            gate_function_cache& functions,
+                            gate_matcher_workspace<typename OccList::lit>& workspace) -> bool
+{
+  // Fallback for gates not matching any of the specific patterns: the
+  // encoding is a gate iff for each input assignment, exactly one of the
+  // fwd and bwd clause sets propagates the output. This is checked by
+  // computing the truth tables of both sets.
+  if (inputs.size() > max_truth_table_inputs) {
+    return false;
+  }
+
+  std::vector<clause_bitmask>& fwd_masks = workspace.fwd_masks;
+  std::vector<clause_bitmask>& bwd_masks = workspace.bwd_masks;
+  fwd_masks.clear();
+  bwd_masks.clear();
+
+  return try_get_clause_bitmasks(clauses[negate(output)], output, inputs, fwd_masks) &&
+         try_get_clause_bitmasks(clauses[output], output, inputs, bwd_masks) &&
+         functions.is_total_function(fwd_masks, bwd_masks, inputs.size());
+}
+
+
+/**
+ * State used for recognizing gates, reused across calls of is_gate_output()
+ * to avoid recomputations and allocations
+ */
+template <typename Lit, typename Recorder = null_stats_recorder>
+struct gate_matcher_state {
+  blocked_set_checker<Lit> blockedness;
+  gate_function_cache functions;
+  gate_matcher_workspace<Lit> workspace;
+  Recorder stats;
+};
+
+
+template <typename OccList, typename Recorder>
 auto is_matching_gate_pattern(typename OccList::lit const& output,
                               OccList const& clauses,
-                              std::vector<size_t> const& inputs) -> bool
+                              gate_matcher_state<typename OccList::lit, Recorder>& state) -> bool
 {
   // Note that
   //   * AND and OR gates are special cases of at-least-k gates
   //   * at-most-k gates can be interpreted in terms of at-least-k'
   //   * XOR gates are special cases of "full" gates
+  std::vector<size_t> const& inputs = state.workspace.inputs;
   return is_at_least_k_gate(output, clauses, inputs) ||
-         is_full_gate_or_ssr_optimized(output, clauses, inputs);
+         is_full_gate_or_ssr_optimized(output, clauses, inputs, state.workspace) ||
+         is_total_function_gate(output, clauses, inputs, state.functions, state.workspace);
 }
 
-template <typename OccList>
-auto is_output_of_fully_encoded_gate(typename OccList::lit const& output, OccList const& clauses)
+template <typename OccList, typename Recorder>
+auto is_output_of_fully_encoded_gate(typename OccList::lit const& output,
+                                     OccList const& clauses,
+                                     gate_matcher_state<typename OccList::lit, Recorder>& state)
     -> bool
 {
-  std::vector<size_t> inputs = try_get_gate_inputs(output, clauses);
-  return !inputs.empty() && is_matching_gate_pattern(output, clauses, inputs);
+  typename Recorder::timer const start = state.stats.start_timer();
+
+  if (!try_get_gate_inputs(output, clauses, state.workspace)) {
+    state.stats.on_matchers_finished(start);
+    state.stats.on_failure(gate_failure::input_mismatch);
+    return false;
+  }
+
+  bool const result = is_matching_gate_pattern(output, clauses, state);
+  state.stats.on_matchers_finished(start);
+
+  if (!result) {
+    state.stats.on_failure(gate_failure::no_pattern);
+  }
+  return result;
 }
 
-template <typename OccList>
+template <typename OccList, typename Recorder>
 auto is_gate_output(typename OccList::lit const& output,
                     OccList const& clauses,
-                    bool is_nested_monotonically) -> bool
+                    bool is_nested_monotonically,
+                    gate_matcher_state<typename OccList::lit, Recorder>& state) -> bool
 {
   if (clauses[negate(output)].empty()) {
     // `output` is not a gate output, since the possible inputs cannot
     // constrain it.
+    state.stats.on_failure(gate_failure::empty_fwd);
     return false;
   }
 
-  if (!is_blocked(output, clauses)) {
+  typename Recorder::timer const blockedness_start = state.stats.start_timer();
+  bool const is_blocked = state.blockedness.is_blocked(output, clauses);
+  state.stats.on_blockedness_checked(blockedness_start);
+
+  if (!is_blocked) {
     // The clauses currently remaining in the occurrence list
     // are not a gate encoding, since CNF gate encodings are
     // required to be a blocked set (with `output` being a
@@ -283,6 +507,7 @@ auto is_gate_output(typename OccList::lit const& output,
     // indeed the output of a gate. G needs to be recovered first,
     // so that its clauses are not contained in the occurrence
     // list anymore.
+    state.stats.on_failure(gate_failure::not_blocked);
     return false;
   }
 
@@ -296,7 +521,16 @@ auto is_gate_output(typename OccList::lit const& output,
     return true;
   }
 
-  return is_output_of_fully_encoded_gate(output, clauses);
+  return is_output_of_fully_encoded_gate(output, clauses, state);
+}
+
+template <typename OccList>
+auto is_gate_output(typename OccList::lit const& output,
+                    OccList const& clauses,
+                    bool is_nested_monotonically) -> bool
+{
+  gate_matcher_state<typename OccList::lit> state;
+  return is_gate_output(output, clauses, is_nested_monotonically, state);
 }
 
 }
@@ -0,0 +1,275 @@
+#pragma once
+
+#include <gatekit/detail/clause_utils.h>
+#include <gatekit/detail/scan_budget.h>
+#include <gatekit/detail/scan_stats_recorder.h>
+#include <gatekit/detail/scanner_structure.h>
+#include <gatekit/detail/threads.h>
+
+#include <gatekit/clause.h>
+#include <gatekit/gate.h>
+#include <gatekit/scan_options.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace gatekit {
+namespace detail {
+
+class var_components {
+public:
+  explicit var_components(std::size_t num_vars) : m_parents(num_vars)
+  {
+    std::iota(m_parents.begin(), m_parents.end(), 0);
+  }
+
+  auto find(std::size_t var) noexcept -> std::size_t
+  {
+    while (m_parents[var] != var) {
+      m_parents[var] = m_parents[m_parents[var]];
+      var = m_parents[var];
+    }
+    return var;
+  }
+
+  void join(std::size_t lhs, std::size_t rhs) noexcept
+  {
+    std::size_t const lhs_root = find(lhs);
+    std::size_t const rhs_root = find(rhs);
+
+    if (lhs_root < rhs_root) {
+      m_parents[rhs_root] = lhs_root;
+    }
+    else {
+      m_parents[lhs_root] = rhs_root;
+    }
+  }
+
+  auto size() const noexcept -> std::size_t { return m_parents.size(); }
+
+private:
+  std::vector<std::size_t> m_parents;
+};
+
+
+template <typename ClauseHandleIter>
+auto get_max_var_index_plus_one(ClauseHandleIter start, ClauseHandleIter stop) -> std::size_t
+{
+  std::size_t result = 0;
+
+  for (ClauseHandleIter clause = start; clause != stop; ++clause) {
+    for (auto const& literal : iterate(*clause)) {
+      result = std::max(result, to_var_index(literal) + 1);
+    }
+  }
+
+  return result;
+}
+
+
+template <typename ClauseHandleIter>
+void join_clause_vars(var_components& components, ClauseHandleIter start, ClauseHandleIter stop)
+{
+  for (ClauseHandleIter clause = start; clause != stop; ++clause) {
+    if (get_size(*clause) == 0) {
+      continue;
+    }
+
+    std::size_t const first_var = to_var_index(get_lit(*clause, 0));
+    for (auto const& literal : iterate(*clause)) {
+      components.join(first_var, to_var_index(literal));
+    }
+  }
+}
+
+
+struct component_info {
+  std::size_t weight = 0;
+  bool has_root_candidate = false;
+};
+
+
+inline auto distribute_to_batches(std::vector<component_info> const& components,
+                                  std::size_t max_num_batches) -> std::vector<std::size_t>
+{
+  // Greedy longest-processing-time-first assignment of the components
+  // containing root candidates to the batches. Components without root
+  // candidates cannot contain gates, so they are not scanned at all.
+  std::size_t const no_batch = std::numeric_limits<std::size_t>::max();
+  std::vector<std::size_t> result(components.size(), no_batch);
+
+  std::vector<std::size_t> scannable;
+  for (std::size_t rank = 0; rank < components.size(); ++rank) {
+    if (components[rank].has_root_candidate) {
+      scannable.push_back(rank);
+    }
+  }
+
+  std::stable_sort(
+      scannable.begin(), scannable.end(), [&components](std::size_t lhs, std::size_t rhs) {
+        return components[lhs].weight > components[rhs].weight;
+      });
+
+  using load_and_batch = std::pair<std::size_t, std::size_t>;
+  std::priority_queue<load_and_batch, std::vector<load_and_batch>, std::greater<load_and_batch>>
+      loads;
+
+  std::size_t const num_batches = std::min(max_num_batches, scannable.size());
+  for (std::size_t batch = 0; batch < num_batches; ++batch) {
+    loads.push({0, batch});
+  }
+
+  for (std::size_t rank : scannable) {
+    load_and_batch least_loaded = loads.top();
+    loads.pop();
+
+    result[rank] = least_loaded.second;
+    least_loaded.first += components[rank].weight;
+    loads.push(least_loaded);
+  }
+
+  return result;
+}
+
+
+template <typename ClauseHandle, typename ClauseHandleIter>
+auto scan_gates_parallel_impl(ClauseHandleIter start,
+                              ClauseHandleIter stop,
+                              scan_options const& options,
+                              std::size_t num_threads) -> scan_result<ClauseHandle>
+{
+  // Basic algorithm:
+  //
+  // The clauses are partitioned into variable-disjoint components. Since
+  // the scanner never relates clauses of distinct components to each
+  // other, scanning the union of some components yields the same gates
+  // as scanning them separately, and the subsequence of gates belonging to
+  // a single component is the same in both cases. So the components are
+  // distributed to one batch per thread, each batch is scanned with its own
+  // occurrence list, and the results are merged by stably sorting the gates
+  // and roots by component, with components ordered by their first clause
+  // in [start, stop). This ordering does not depend on the thread count, and
+  // it is reverse-topological since gates of distinct components are not
+  // connected.
+  //
+  // Non-unary root clauses are selected per component, which yields the
+  // same roots as selecting them for the whole problem instance, since the
+  // candidates of distinct components do not affect each other. The scanners
+  // share a single step budget, and their statistics are collected separately
+  // and added to options.stats when all scanners have finished.
+
+  using lit = typename clause_funcs<ClauseHandle>::lit;
+
+  std::size_t const num_vars = get_max_var_index_plus_one(start, stop);
+
+  var_components components{num_vars};
+  join_clause_vars(components, start, stop);
+
+  std::size_t const no_rank = std::numeric_limits<std::size_t>::max();
+  std::vector<std::size_t> rank_by_var(num_vars, no_rank);
+  std::vector<component_info> component_infos;
+
+  for (ClauseHandleIter clause = start; clause != stop; ++clause) {
+    if (get_size(*clause) == 0) {
+      continue;
+    }
+
+    std::size_t const component = components.find(to_var_index(get_lit(*clause, 0)));
+    if (rank_by_var[component] == no_rank) {
+      rank_by_var[component] = component_infos.size();
+      component_infos.emplace_back();
+    }
+
+    component_info& info = component_infos[rank_by_var[component]];
+    info.weight += get_size(*clause);
+    info.has_root_candidate = info.has_root_candidate || get_size(*clause) == 1 ||
+                              options.roots == root_selection::unaries_and_clauses;
+  }
+
+  for (std::size_t var = 0; var < num_vars; ++var) {
+    rank_by_var[var] = rank_by_var[components.find(var)];
+  }
+
+  std::vector<std::size_t> const batch_by_rank =
+      distribute_to_batches(component_infos, get_num_threads(num_threads));
+  std::size_t num_batches = 0;
+  for (std::size_t batch : batch_by_rank) {
+    if (batch != no_rank) {
+      num_batches = std::max(num_batches, batch + 1);
+    }
+  }
+
+  std::vector<std::vector<ClauseHandle>> batch_clauses(num_batches);
+  for (ClauseHandleIter clause = start; clause != stop; ++clause) {
+    if (get_size(*clause) == 0) {
+      continue;
+    }
+
+    std::size_t const batch = batch_by_rank[rank_by_var[to_var_index(get_lit(*clause, 0))]];
+    if (batch != no_rank) {
+      batch_clauses[batch].push_back(*clause);
+    }
+  }
+
+  shared_scan_limits limits{options.max_steps, options.deadline, options.is_cancelled};
+
+  std::vector<gate_structure<ClauseHandle>> batch_results(num_batches);
+  std::vector<scan_stats> batch_stats(options.stats != nullptr ? num_batches : 0);
+
+  run_in_parallel(num_batches, [&](std::size_t batch) {
+    std::vector<ClauseHandle> const& clauses = batch_clauses[batch];
+    shared_scan_budget budget{limits};
+
+    if (options.stats != nullptr) {
+      batch_results[batch] = scan_gates_with_layout_impl<ClauseHandle>(
+          clauses.begin(), clauses.end(), options, budget, stats_recorder{batch_stats[batch]});
+    }
+    else {
+      batch_results[batch] = scan_gates_with_layout_impl<ClauseHandle>(
+          clauses.begin(), clauses.end(), options, budget, null_stats_recorder{});
+    }
+  });
+
+  for (scan_stats const& stats : batch_stats) {
+    add_stats(*options.stats, stats);
+  }
+
+  scan_result<ClauseHandle> result;
+  result.is_finished = !limits.is_exhausted();
+
+  gate_structure<ClauseHandle>& structure = result.structure;
+  for (gate_structure<ClauseHandle>& batch_result : batch_results) {
+    std::move(batch_result.gates.begin(),
+              batch_result.gates.end(),
+              std::back_inserter(structure.gates));
+    std::move(batch_result.roots.begin(),
+              batch_result.roots.end(),
+              std::back_inserter(structure.roots));
+  }
+
+  std::stable_sort(structure.gates.begin(),
+                   structure.gates.end(),
+                   [&rank_by_var](gate<ClauseHandle> const& lhs, gate<ClauseHandle> const& rhs) {
+                     return rank_by_var[to_var_index(lhs.output)] <
+                            rank_by_var[to_var_index(rhs.output)];
+                   });
+
+  std::stable_sort(structure.roots.begin(),
+                   structure.roots.end(),
+                   [&rank_by_var](std::vector<lit> const& lhs, std::vector<lit> const& rhs) {
+                     return rank_by_var[to_var_index(lhs.front())] <
+                            rank_by_var[to_var_index(rhs.front())];
+                   });
+
+  return result;
+}
+
+}
+}
@@ -3,14 +3,20 @@
 #include <gatekit/detail/blocked_set.h>
 #include <gatekit/detail/clause_utils.h>
 #include <gatekit/detail/collections.h>
+#include <gatekit/detail/csr_occurrence_list.h>
 #include <gatekit/detail/occurrence_list.h>
+#include <gatekit/detail/scan_budget.h>
+#include <gatekit/detail/scan_stats_recorder.h>
 #include <gatekit/detail/scanner_gate.h>
 
 #include <gatekit/clause.h>
 #include <gatekit/gate.h>
+#include <gatekit/scan_options.h>
 
 #include <algorithm>
+#include <cstddef>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 
@@ -23,13 +29,19 @@ struct optional_gate {
   bool m_is_valid = false;
 };
 
+/**
+ * Stores the input literals of `gate` in `result`, in the order of their first
+ * occurrence in the gate's forward clauses. `marks` is used for deduplication.
+ */
 template <typename ClauseHandle>
-auto get_inputs(gate<ClauseHandle> const& gate)
-    -> std::vector<typename clause_funcs<ClauseHandle>::lit>
+void collect_inputs(gate<ClauseHandle> const& gate,
+                    index_marks& marks,
+                    std::vector<typename clause_funcs<ClauseHandle>::lit>& result)
 {
   using lit = typename clause_funcs<ClauseHandle>::lit;
 
-  std::vector<lit> result;
+  marks.clear();
+  result.clear();
 
   auto const stop = gate.clauses.begin() + gate.num_fwd_clauses;
   for (auto iter = gate.clauses.begin(); iter != stop; ++iter) {
@@ -38,19 +50,28 @@ auto get_inputs(gate<ClauseHandle> const& gate)
         continue;
       }
 
-      if (std::find(result.begin(), result.end(), literal) == result.end()) {
+      if (marks.mark(to_index(literal))) {
         result.push_back(literal);
       }
     }
   }
+}
 
+template <typename ClauseHandle>
+auto get_inputs(gate<ClauseHandle> const& gate)
+    -> std::vector<typename clause_funcs<ClauseHandle>::lit>
+{
+  index_marks marks;
+  std::vector<typename clause_funcs<ClauseHandle>::lit> result;
+  collect_inputs(gate, marks, result);
   return result;
 }
 
 template <typename OccList>
 auto create_valid_gate(typename OccList::lit const& output,
                        OccList const& clauses,
-                       bool is_nested_monotonically)
+                       bool is_nested_monotonically,
+                       gate_matcher_workspace<typename OccList::lit>& workspace)
     -> optional_gate<typename OccList::clause_handle>
 {
   using ClauseHandle = typename OccList::clause_handle;
@@ -60,25 +81,35 @@ auto create_valid_gate(typename OccList::lit const& output,
   result.m_is_valid = true;
   result.m_gate.output = output;
   result.m_gate.is_nested_monotonically = is_nested_monotonically;
-  result.m_gate.clauses = clauses[negate(output)];
-  result.m_gate.num_fwd_clauses = result.m_gate.clauses.size();
 
+  auto const& fwd_clauses = clauses[negate(output)];
   auto const& bwd_clauses = clauses[output];
+  result.m_gate.clauses.reserve(fwd_clauses.size() + bwd_clauses.size());
+  result.m_gate.clauses.assign(fwd_clauses.begin(), fwd_clauses.end());
+  result.m_gate.num_fwd_clauses = result.m_gate.clauses.size();
   result.m_gate.clauses.insert(result.m_gate.clauses.end(), bwd_clauses.begin(), bwd_clauses.end());
 
-  result.m_gate.inputs = get_inputs(result.m_gate);
+  // Collecting the inputs in a reused buffer first, so that the inputs of the
+  // gate are allocated with their final size
+  collect_inputs(result.m_gate, workspace.input_lits, workspace.input_lits_buffer);
+  result.m_gate.inputs.assign(workspace.input_lits_buffer.begin(),
+                              workspace.input_lits_buffer.end());
 
   return result;
 }
 
 
-template <typename OccList>
+template <typename OccList, typename Recorder>
 auto try_get_gate(typename OccList::lit const& output,
                   OccList const& clauses,
-                  bool is_nested_monotonically) -> optional_gate<typename OccList::clause_handle>
+                  bool is_nested_monotonically,
+                  gate_matcher_state<typename OccList::lit, Recorder>& matcher_state)
+    -> optional_gate<typename OccList::clause_handle>
 {
-  if (is_gate_output(output, clauses, is_nested_monotonically)) {
-    return create_valid_gate(output, clauses, is_nested_monotonically);
+  matcher_state.stats.on_try_get_gate();
+
+  if (is_gate_output(output, clauses, is_nested_monotonically, matcher_state)) {
+    return create_valid_gate(output, clauses, is_nested_monotonically, matcher_state.workspace);
   }
 
   return {};
@@ -92,19 +123,26 @@ void sort_by_estimated_access_cost(std::vector<Lit>& to_sort, OccList const& occ
   });
 }
 
-template <typename ClauseHandle>
-void extend_gate_structure(gate_structure<ClauseHandle>& result,
-                           occurrence_list<ClauseHandle>& occs,
-                           literal_set<typename clause_funcs<ClauseHandle>::lit>& inputs,
-                           typename clause_funcs<ClauseHandle>::lit root)
+template <typename Structure,
+          typename OccList,
+          typename InputSet,
+          typename Recorder,
+          typename Budget>
+auto extend_gate_structure_from(Structure& result,
+                                OccList& occs,
+                                InputSet& inputs,
+                                gate_matcher_state<typename OccList::lit, Recorder>& matcher_state,
+                                Budget& budget,
+                                typename OccList::lit start) -> bool
 {
-  using lit = typename clause_funcs<ClauseHandle>::lit;
+  using ClauseHandle = typename OccList::clause_handle;
+  using lit = typename OccList::lit;
 
   // Basic algorithm:
   //
   // The gate structure is scanned using BFS. The inputs of gates
   // discovered in the current round are used as current_candidates
-  // in the next round. Initially, only the root literal is a candidate.
+  // in the next round. Initially, only the start literal is a candidate.
   // When a gate is found, its clauses are removed from the occurrence
   // lists, and the search continues.
   //
@@ -117,13 +155,26 @@ void extend_gate_structure(gate_structure<ClauseHandle>& result,
   // contain clauses of other gates. In that case, X automatically
   // becomes a candidate again when the last gate having X or ~X as
   // input has been recovered.
-
-  std::vector<lit> current_candidates = {root};
-  literal_set<lit> next_candidates{occs.get_max_lit_index()};
+  //
+  // Each gate recognition attempt consumes a step of `budget`. When the
+  // budget is exhausted, the search is stopped. Since gates are added to
+  // `result` only after their users, the result is still a valid gate
+  // structure in that case.
+
+  // The candidate sets are kept in the matcher's workspace, so that they are
+  // not reallocated for each start literal
+  std::vector<lit>& current_candidates = matcher_state.workspace.current_candidates;
+  literal_set<lit>& next_candidates = matcher_state.workspace.next_candidates;
+  current_candidates.assign(1, start);
+  next_candidates.clear();
+  next_candidates.grow(occs.get_max_lit_index());
 
   bool found_any = false;
+  std::size_t num_rounds = 0;
 
   while (!current_candidates.empty()) {
+    ++num_rounds;
+
     // Preferring to access "cheap" literals first, causing removals to be performed in
     // the occurrence list while it is cheap. This causes the cost of cheap
     // occurrence_list<>::operator[]() to become even cheaper (most cases) and further
@@ -136,10 +187,16 @@ void extend_gate_structure(gate_structure<ClauseHandle>& result,
     sort_by_estimated_access_cost(current_candidates, occs);
 
     for (lit candidate : current_candidates) {
+      if (!budget.consume_step()) {
+        matcher_state.stats.on_bfs_finished(num_rounds);
+        return found_any;
+      }
+
       bool const is_nested_mono =
           !(inputs.contains(candidate) && inputs.contains(negate(candidate)));
 
-      optional_gate<ClauseHandle> potential_gate = try_get_gate(candidate, occs, is_nested_mono);
+      optional_gate<ClauseHandle> potential_gate =
+          try_get_gate(candidate, occs, is_nested_mono, matcher_state);
 
       if (potential_gate.m_is_valid) {
         occs.remove_gate_root(potential_gate.m_gate.output);
@@ -158,32 +215,310 @@ void extend_gate_structure(gate_structure<ClauseHandle>& result,
       }
     }
 
-    current_candidates = next_candidates.literals();
+    current_candidates.assign(next_candidates.literals().begin(),
+                              next_candidates.literals().end());
     next_candidates.clear();
   }
 
-  if (found_any) {
+  matcher_state.stats.on_bfs_finished(num_rounds);
+  return found_any;
+}
+
+template <typename Structure, typename OccList, typename InputSet, typename Recorder>
+auto extend_gate_structure_from(Structure& result,
+                                OccList& occs,
+                                InputSet& inputs,
+                                gate_matcher_state<typename OccList::lit, Recorder>& matcher_state,
+                                typename OccList::lit start) -> bool
+{
+  unlimited_scan_budget budget;
+  return extend_gate_structure_from(result, occs, inputs, matcher_state, budget, start);
+}
+
+template <typename Structure,
+          typename OccList,
+          typename InputSet,
+          typename Recorder,
+          typename Budget>
+void extend_gate_structure(Structure& result,
+                           OccList& occs,
+                           InputSet& inputs,
+                           gate_matcher_state<typename OccList::lit, Recorder>& matcher_state,
+                           Budget& budget,
+                           typename OccList::lit root)
+{
+  if (extend_gate_structure_from(result, occs, inputs, matcher_state, budget, root)) {
     result.roots.push_back({root});
   }
 }
 
 
-template <typename ClauseHandle, typename ClauseHandleIter>
-auto scan_gates_impl(ClauseHandleIter start, ClauseHandleIter stop) -> gate_structure<ClauseHandle>
+template <typename OccList>
+auto contains_clause(OccList const& occs, typename OccList::clause_handle const& clause) -> bool
 {
-  occurrence_list<ClauseHandle> occs{start, stop};
+  auto const& occurrences = occs[get_lit(clause, 0)];
+  return std::find(occurrences.begin(), occurrences.end(), clause) != occurrences.end();
+}
+
+/**
+ * Returns true iff `literal` is blocked in `occs` without `clause`, with `-literal`
+ * occurring in some clause. If the clause is a root constraint, the literal could
+ * then be the output of a gate.
+ */
+template <typename OccList>
+auto is_gate_output_candidate_without(typename OccList::lit const& literal,
+                                      OccList const& occs,
+                                      typename OccList::clause_handle const& clause,
+                                      blocked_set_checker<typename OccList::lit>& blockedness)
+    -> bool
+{
+  auto const& fwd_clauses = occs[negate(literal)];
+  if (fwd_clauses.empty()) {
+    return false;
+  }
+
+  return blockedness.is_blocked_without(literal, fwd_clauses, occs[literal], clause);
+}
+
+/**
+ * Returns the non-unary clauses in `occs` that could be root constraints, ie.
+ * the clauses in which each literal could be a gate output if the clause was
+ * removed. The clauses are ordered by the total number of occurrences of their
+ * literals' variables, which is roughly proportional to the cost of trying to
+ * find gates starting from their literals.
+ *
+ * Checking a clause consumes a step of `budget`. When the budget is exhausted,
+ * only the candidates found until then are returned.
+ */
+template <typename OccList, typename Budget>
+auto get_root_clause_candidates(OccList const& occs,
+                                blocked_set_checker<typename OccList::lit>& blockedness,
+                                Budget& budget) -> std::vector<typename OccList::clause_handle>
+{
+  using ClauseHandle = typename OccList::clause_handle;
+  using lit = typename OccList::lit;
+
+  std::vector<std::pair<std::size_t, ClauseHandle>> candidates;
 
-  gate_structure<ClauseHandle> result;
-  literal_set<typename clause_funcs<ClauseHandle>::lit> inputs{occs.get_max_lit_index()};
+  for (std::size_t index = 0; index <= occs.get_max_lit_index() && !budget.is_exhausted();
+       ++index) {
+    lit const literal = to_lit<lit>(index / 2, index % 2 == 0);
+
+    for (ClauseHandle const& clause : occs[literal]) {
+      // Visiting each clause only once, via its first literal
+      if (get_size(clause) < 2 || !(get_lit(clause, 0) == literal)) {
+        continue;
+      }
+
+      if (!budget.consume_step()) {
+        break;
+      }
+
+      std::size_t cost = 0;
+      bool is_candidate = true;
+
+      for (lit clause_lit : iterate(clause)) {
+        if (!is_gate_output_candidate_without(clause_lit, occs, clause, blockedness)) {
+          is_candidate = false;
+          break;
+        }
+        cost += occs[negate(clause_lit)].size() + occs[clause_lit].size();
+      }
+
+      if (is_candidate) {
+        candidates.emplace_back(cost, clause);
+      }
+    }
+  }
+
+  std::stable_sort(candidates.begin(),
+                   candidates.end(),
+                   [](std::pair<std::size_t, ClauseHandle> const& lhs,
+                      std::pair<std::size_t, ClauseHandle> const& rhs) -> bool {
+                     return lhs.first < rhs.first;
+                   });
+
+  std::vector<ClauseHandle> result;
+  result.reserve(candidates.size());
+  for (auto const& candidate : candidates) {
+    result.push_back(candidate.second);
+  }
+
+  return result;
+}
+
+/**
+ * Tries to find gates starting from each literal of the given clause, with the
+ * clause being removed from `occs`. If any gate is found, the clause is added
+ * to the roots of `result`. Otherwise, it is added back to `occs`.
+ */
+template <typename Structure,
+          typename OccList,
+          typename InputSet,
+          typename Recorder,
+          typename Budget>
+void extend_gate_structure_from_clause(
+    Structure& result,
+    OccList& occs,
+    InputSet& inputs,
+    gate_matcher_state<typename OccList::lit, Recorder>& matcher_state,
+    Budget& budget,
+    typename OccList::clause_handle const& root)
+{
+  using lit = typename OccList::lit;
+
+  occs.remove(root);
+
+  bool found_any = false;
+  for (lit root_lit : iterate(root)) {
+    found_any =
+        extend_gate_structure_from(result, occs, inputs, matcher_state, budget, root_lit) ||
+        found_any;
+  }
+
+  if (found_any) {
+    std::vector<lit> root_lits;
+    for (lit root_lit : iterate(root)) {
+      root_lits.push_back(root_lit);
+    }
+    result.roots.push_back(std::move(root_lits));
+  }
+  else {
+    occs.add(root);
+  }
+}
+
+
+/**
+ * Scans the clauses in `[start, stop)` for gates. `Structure` is the type of
+ * the resulting gate structure, with `gates` and `roots` members supporting
+ * push_back() of gates and roots, like `gate_structure<ClauseHandle>`.
+ */
+template <typename ClauseHandle,
+          typename ClauseHandleIter,
+          typename OccList,
+          typename Structure = gate_structure<ClauseHandle>,
+          typename Budget,
+          typename Recorder>
+auto scan_gates_impl(ClauseHandleIter start,
+                     ClauseHandleIter stop,
+                     root_selection roots,
+                     Budget& budget,
+                     Recorder const& recorder) -> Structure
+{
+  using lit = typename clause_funcs<ClauseHandle>::lit;
+
+  typename Recorder::template occurrence_list<OccList> occs{start, stop};
+  recorder.attach(occs);
+
+  Structure result;
+  literal_set<lit> inputs{occs.get_max_lit_index()};
+  gate_matcher_state<lit, Recorder> matcher_state;
+  matcher_state.stats = recorder;
 
   auto unaries = occs.get_unaries();
   for (auto root_candidate : unaries) {
+    if (budget.is_exhausted()) {
+      break;
+    }
+
     occs.remove_unary(root_candidate);
-    extend_gate_structure(result, occs, inputs, root_candidate);
+    extend_gate_structure(result, occs, inputs, matcher_state, budget, root_candidate);
+  }
+
+  if (roots == root_selection::unaries_and_clauses) {
+    // Clauses that are part of gates found from other candidates are removed
+    // from occs in the meantime, so candidates are checked again before use.
+    std::vector<ClauseHandle> const candidates =
+        get_root_clause_candidates(occs, matcher_state.blockedness, budget);
+
+    for (ClauseHandle const& root_candidate : candidates) {
+      if (budget.is_exhausted()) {
+        break;
+      }
+
+      if (contains_clause(occs, root_candidate)) {
+        extend_gate_structure_from_clause(
+            result, occs, inputs, matcher_state, budget, root_candidate);
+      }
+    }
+  }
+
+  return result;
+}
+
+template <typename ClauseHandle,
+          typename ClauseHandleIter,
+          typename OccList = occurrence_list<ClauseHandle>>
+auto scan_gates_impl(ClauseHandleIter start, ClauseHandleIter stop) -> gate_structure<ClauseHandle>
+{
+  unlimited_scan_budget budget;
+  return scan_gates_impl<ClauseHandle, ClauseHandleIter, OccList>(
+      start, stop, root_selection::unaries, budget, null_stats_recorder{});
+}
+
+
+/**
+ * Runs scan_gates_impl() with occurrence lists in the layout given by `options`,
+ * using `budget` instead of the limits of `options`.
+ */
+template <typename ClauseHandle,
+          typename Structure = gate_structure<ClauseHandle>,
+          typename ClauseHandleIter,
+          typename Budget,
+          typename Recorder>
+auto scan_gates_with_layout_impl(ClauseHandleIter start,
+                                 ClauseHandleIter stop,
+                                 scan_options const& options,
+                                 Budget& budget,
+                                 Recorder const& recorder) -> Structure
+{
+  if (options.layout == occurrence_list_layout::compressed) {
+    return scan_gates_impl<ClauseHandle,
+                           ClauseHandleIter,
+                           csr_occurrence_list<ClauseHandle>,
+                           Structure>(start, stop, options.roots, budget, recorder);
   }
 
+  return scan_gates_impl<ClauseHandle, ClauseHandleIter, occurrence_list<ClauseHandle>, Structure>(
+      start, stop, options.roots, budget, recorder);
+}
+
+template <typename ClauseHandle,
+          typename Structure = gate_structure<ClauseHandle>,
+          typename ClauseHandleIter,
+          typename Recorder>
+auto scan_gates_with_options_impl(ClauseHandleIter start,
+                                  ClauseHandleIter stop,
+                                  scan_options const& options,
+                                  Recorder const& recorder) -> scan_result<ClauseHandle, Structure>
+{
+  scan_budget budget{options.max_steps, options.deadline, options.is_cancelled};
+
+  scan_result<ClauseHandle, Structure> result;
+  result.structure =
+      scan_gates_with_layout_impl<ClauseHandle, Structure>(start, stop, options, budget, recorder);
+  result.is_finished = !budget.is_exhausted();
   return result;
 }
 
+template <typename ClauseHandle,
+          typename Structure = gate_structure<ClauseHandle>,
+          typename ClauseHandleIter>
+auto scan_gates_with_options_impl(ClauseHandleIter start,
+                                  ClauseHandleIter stop,
+                                  scan_options const& options)
+    -> scan_result<ClauseHandle, Structure>
+{
+  // Dispatching here, so that scans without statistics are not instrumented at all
+  if (options.stats != nullptr) {
+    return scan_gates_with_options_impl<ClauseHandle, Structure>(
+        start, stop, options, stats_recorder{*options.stats});
+  }
+
+  return scan_gates_with_options_impl<ClauseHandle, Structure>(
+      start, stop, options, null_stats_recorder{});
+}
+
 }
 }
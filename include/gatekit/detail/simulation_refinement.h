@@ -0,0 +1,479 @@
+#pragma once
+
+#include <gatekit/detail/bitvector.h>
+#include <gatekit/detail/bitvector_partition.h>
+#include <gatekit/detail/clause_utils.h>
+#include <gatekit/detail/simulation_tape.h>
+#include <gatekit/detail/utils.h>
+#include <gatekit/detail/var_compaction.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+namespace gatekit {
+
+/**
+ * \brief Input patterns distinguishing conjectured equivalences
+ *
+ * Each pattern is a partial assignment of the structure's input variables,
+ * given as the literals that are assigned true. The patterns are in terms of
+ * the original variables, so a database can be kept across simulations of
+ * different structures recovered from the same problem instance.
+ */
+template <typename Lit>
+struct simulation_patterns {
+  std::vector<std::vector<Lit>> patterns;
+};
+
+
+/**
+ * \brief Options for refining the partitioning computed by random_simulation()
+ *
+ * After the random rounds, the refinement simulates rounds of input patterns
+ * targeting the equivalence classes that are still merged. In each of these
+ * rounds, the bits belonging to a class are derived from the previous
+ * round's patterns by flipping inputs in the fanin cones of its candidates,
+ * restricted to the inputs not shared by both cones if there are any, or by
+ * assigning biased random values to the inputs of the cones. The refinement
+ * stops when the partitioning has not been refined for
+ * `max_rounds_without_progress` rounds.
+ */
+template <typename Lit>
+struct refinement_options {
+  /**
+   * The maximum number of refinement rounds, each simulating as many
+   * patterns as the simulation width.
+   */
+  std::size_t max_num_rounds = 256;
+
+  std::size_t max_rounds_without_progress = 8;
+
+  /**
+   * The maximum number of gates visited when collecting the fanin cone of a
+   * candidate. The inputs of larger cones are only partially flipped.
+   */
+  std::size_t max_cone_size = 4096;
+
+  /**
+   * If not null, the patterns of this database are simulated before the
+   * targeted rounds, and the patterns found to split a class are added to
+   * it.
+   */
+  simulation_patterns<Lit>* patterns = nullptr;
+
+  /**
+   * The maximum number of patterns kept in `patterns`. When recording
+   * patterns exceeds it, the oldest patterns are dropped first.
+   */
+  std::size_t max_num_patterns = 65536;
+};
+
+
+namespace detail {
+
+/**
+ * Collects the input variables in the fanin cones of variables on a
+ * simulation tape.
+ */
+class fanin_cones {
+public:
+  fanin_cones(simulation_tape const& tape, std::size_t num_vars)
+    : m_gate_by_var(num_vars, std::size_t{no_gate}), m_visited(num_vars, 0)
+  {
+    for (std::size_t gate = 0; gate < tape.num_gates(); ++gate) {
+      m_gate_by_var[tape.get_gate(gate).output_var] = gate;
+    }
+  }
+
+  /**
+   * Stores the sorted input variables of the cone of `var` in `result`,
+   * visiting at most `max_size` gates.
+   */
+  void collect_inputs(simulation_tape const& tape,
+                      std::size_t var,
+                      std::size_t max_size,
+                      std::vector<std::size_t>& result)
+  {
+    result.clear();
+    ++m_current_visit;
+
+    std::size_t num_visited_gates = 0;
+    m_stack.assign(1, var);
+    m_visited[var] = m_current_visit;
+
+    while (!m_stack.empty()) {
+      std::size_t const current = m_stack.back();
+      m_stack.pop_back();
+
+      std::size_t const gate_index = m_gate_by_var[current];
+      if (gate_index == no_gate) {
+        result.push_back(current);
+        continue;
+      }
+
+      if (num_visited_gates == max_size) {
+        continue;
+      }
+      ++num_visited_gates;
+
+      simulation_tape::tape_gate const& gate = tape.get_gate(gate_index);
+      for (std::size_t clause = gate.clauses_begin; clause < gate.clauses_end; ++clause) {
+        for (uint32_t operand : tape.get_operands(clause)) {
+          std::size_t const operand_var = operand >> 1;
+          if (m_visited[operand_var] != m_current_visit) {
+            m_visited[operand_var] = m_current_visit;
+            m_stack.push_back(operand_var);
+          }
+        }
+      }
+    }
+
+    std::sort(result.begin(), result.end());
+  }
+
+private:
+  static constexpr std::size_t no_gate = std::numeric_limits<std::size_t>::max();
+
+  std::vector<std::size_t> m_gate_by_var;
+  std::vector<uint32_t> m_visited;
+  uint32_t m_current_visit = 0;
+  std::vector<std::size_t> m_stack;
+};
+
+
+/**
+ * Refines the partitioning of `partition` by simulating targeted input
+ * patterns, as described for refinement_options. `assignments` must contain
+ * the assignment of the last simulated round. The variables are dense
+ * indices of `compaction`. `propagate()` is called to propagate the inputs of
+ * `assignments` on `tape`. `Partition` is a bitvector partition like
+ * basic_bitvector_exact_partition.
+ */
+template <typename Lit, std::size_t Width, typename Partition, typename Propagator>
+class partition_refiner {
+public:
+  using bitvector = basic_bitvector<Width>;
+
+  partition_refiner(basic_bitvector_map<Width>& assignments,
+                    Partition& partition,
+                    simulation_tape const& tape,
+                    var_compaction const& compaction,
+                    refinement_options<Lit> const& options,
+                    Propagator const& propagate)
+    : m_assignments(assignments)
+    , m_partition(partition)
+    , m_tape(tape)
+    , m_compaction(compaction)
+    , m_options(options)
+    , m_propagate(propagate)
+    , m_cones(tape, compaction.size())
+  {
+  }
+
+  void run()
+  {
+    // Patterns recorded during this refinement have been simulated already
+    std::size_t const num_saved_patterns =
+        (m_options.patterns != nullptr) ? m_options.patterns->patterns.size() : 0;
+    std::size_t num_replayed = 0;
+    std::size_t rounds_without_progress = 0;
+
+    for (std::size_t round = 0; round < m_options.max_num_rounds; ++round) {
+      m_classes = m_partition.template get_current_partitions<Lit>().equivalences;
+      if (m_classes.empty()) {
+        return;
+      }
+
+      if (num_replayed < num_saved_patterns) {
+        num_replayed = replay_patterns(num_replayed, num_saved_patterns);
+        m_propagate();
+        m_partition.add(m_assignments);
+      }
+      else {
+        target_cone_inputs(round);
+        m_propagate();
+        m_partition.add(m_assignments);
+        record_distinguishing_patterns();
+      }
+
+      // Dropping the singletons split off in this round saves their hash
+      // updates in the following rounds
+      rounds_without_progress = m_partition.compress() ? 0 : rounds_without_progress + 1;
+      if (rounds_without_progress >= m_options.max_rounds_without_progress) {
+        return;
+      }
+    }
+  }
+
+private:
+  auto get_value(Lit lit, std::size_t word) const noexcept -> uint64_t
+  {
+    uint64_t const var_word = m_assignments[to_var_index(lit)].get_words()[word];
+    return is_positive(lit) ? var_word : ~var_word;
+  }
+
+  auto next_random() noexcept -> uint64_t
+  {
+    m_seed = xorshift_star(m_seed);
+    return m_seed;
+  }
+
+  // Assigns the next patterns of the database to the lanes of the inputs,
+  // with unassigned inputs keeping their values. Returns the index of the
+  // first pattern not replayed yet.
+  auto replay_patterns(std::size_t first_pattern, std::size_t num_patterns) -> std::size_t
+  {
+    std::vector<std::vector<Lit>> const& patterns = m_options.patterns->patterns;
+    std::size_t const end = std::min(num_patterns, first_pattern + Width);
+
+    for (std::size_t pattern = first_pattern; pattern < end; ++pattern) {
+      std::size_t const lane = pattern - first_pattern;
+      uint64_t const bit = uint64_t{1} << (lane % 64);
+
+      for (Lit const& lit : patterns[pattern]) {
+        std::size_t const var = to_var_index(lit);
+        if (!m_compaction.contains(var)) {
+          continue;
+        }
+
+        uint64_t& word = m_assignments[m_compaction(var)].get_words()[lane / 64];
+        word = is_positive(lit) ? (word | bit) : (word & ~bit);
+      }
+    }
+
+    return end;
+  }
+
+  // Collects the cone inputs of the first two candidates of the class
+  void collect_cones(std::vector<Lit> const& eq_class)
+  {
+    std::size_t const max_size = m_options.max_cone_size;
+    m_cones.collect_inputs(m_tape, to_var_index(eq_class[0]), max_size, m_lhs_cone);
+    m_cones.collect_inputs(m_tape, to_var_index(eq_class[1]), max_size, m_rhs_cone);
+  }
+
+  void collect_cone_union(std::vector<Lit> const& eq_class)
+  {
+    collect_cones(eq_class);
+
+    m_targeted_inputs.clear();
+    std::set_union(m_lhs_cone.begin(),
+                   m_lhs_cone.end(),
+                   m_rhs_cone.begin(),
+                   m_rhs_cone.end(),
+                   std::back_inserter(m_targeted_inputs));
+  }
+
+  // Collects the inputs in exactly one of the cones of the first two
+  // candidates of the class, or the inputs of both cones if they are equal
+  void collect_targeted_inputs(std::vector<Lit> const& eq_class)
+  {
+    collect_cones(eq_class);
+
+    m_targeted_inputs.clear();
+    std::set_symmetric_difference(m_lhs_cone.begin(),
+                                  m_lhs_cone.end(),
+                                  m_rhs_cone.begin(),
+                                  m_rhs_cone.end(),
+                                  std::back_inserter(m_targeted_inputs));
+
+    if (m_targeted_inputs.empty()) {
+      collect_cone_union(eq_class);
+    }
+  }
+
+  // Returns a random word with each bit set with probability 2^-exponent
+  auto sparse_random(std::size_t exponent) noexcept -> uint64_t
+  {
+    uint64_t result = ~uint64_t{0};
+    for (std::size_t rep = 0; rep < exponent; ++rep) {
+      result &= next_random();
+    }
+    return result;
+  }
+
+  // Word `w` of the input bitvectors is assigned to class `(offset + w) %
+  // num_classes`. In even rounds, the inputs targeted for that class are
+  // flipped at sparse random positions of the word. In odd rounds, the inputs
+  // of both cones are assigned biased random values instead, alternately
+  // towards true and false, for reaching values that flipping single bits
+  // of uniformly random patterns hardly reaches (e.g. all inputs of a large
+  // AND gate being true).
+  void target_cone_inputs(std::size_t round)
+  {
+    m_targeted_classes.clear();
+    std::size_t const num_targeted = std::min(m_classes.size(), bitvector::num_words);
+    bool const flip = (round % 2) == 0;
+    bool const towards_true = ((round / 2) % 2) == 0;
+    std::size_t const exponent = 1 + ((round / 4) % 4);
+
+    for (std::size_t idx = 0; idx < num_targeted; ++idx) {
+      m_targeted_classes.push_back((m_class_offset + idx) % m_classes.size());
+    }
+    m_class_offset = (m_class_offset + num_targeted) % m_classes.size();
+
+    for (std::size_t idx = 0; idx < num_targeted; ++idx) {
+      std::vector<Lit> const& eq_class = m_classes[m_targeted_classes[idx]];
+      if (flip) {
+        collect_targeted_inputs(eq_class);
+      }
+      else {
+        collect_cone_union(eq_class);
+      }
+
+      for (std::size_t word = idx; word < bitvector::num_words; word += num_targeted) {
+        for (std::size_t var : m_targeted_inputs) {
+          uint64_t& value = m_assignments[var].get_words()[word];
+          if (flip) {
+            value ^= sparse_random(exponent);
+          }
+          else {
+            value = towards_true ? ~sparse_random(exponent) : sparse_random(exponent);
+          }
+        }
+      }
+    }
+  }
+
+  auto get_lane_value(Lit lit, std::size_t word, std::size_t lane) const noexcept -> uint8_t
+  {
+    return static_cast<uint8_t>((get_value(lit, word) >> lane) & 1);
+  }
+
+  // Checks if the values of the class members in the given lane tell apart
+  // members that are not told apart by the patterns recorded for the class yet
+  auto is_splitting_lane(std::vector<Lit> const& eq_class, std::size_t word, std::size_t lane)
+      -> bool
+  {
+    m_first_value_in_group.assign(m_num_groups, uint8_t{unassigned});
+    for (std::size_t member = 0; member < eq_class.size(); ++member) {
+      uint8_t const value = get_lane_value(eq_class[member], word, lane);
+      uint8_t& first_value = m_first_value_in_group[m_groups[member]];
+      if (first_value == unassigned) {
+        first_value = value;
+      }
+      else if (first_value != value) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Splits the groups of class members by their values in the given lane
+  void split_groups(std::vector<Lit> const& eq_class, std::size_t word, std::size_t lane)
+  {
+    m_split_group_ids.assign(2 * m_num_groups, uint32_t{no_group});
+    uint32_t num_groups = 0;
+
+    for (std::size_t member = 0; member < eq_class.size(); ++member) {
+      uint8_t const value = get_lane_value(eq_class[member], word, lane);
+      uint32_t& new_group = m_split_group_ids[2 * m_groups[member] + value];
+      if (new_group == no_group) {
+        new_group = num_groups++;
+      }
+      m_groups[member] = new_group;
+    }
+
+    m_num_groups = num_groups;
+  }
+
+  // Collects the inputs of the cones of all members of the class
+  void collect_class_inputs(std::vector<Lit> const& eq_class)
+  {
+    m_targeted_inputs.clear();
+    for (Lit const& member : eq_class) {
+      m_cones.collect_inputs(m_tape, to_var_index(member), m_options.max_cone_size, m_lhs_cone);
+      m_targeted_inputs.insert(m_targeted_inputs.end(), m_lhs_cone.begin(), m_lhs_cone.end());
+    }
+
+    std::sort(m_targeted_inputs.begin(), m_targeted_inputs.end());
+    m_targeted_inputs.erase(std::unique(m_targeted_inputs.begin(), m_targeted_inputs.end()),
+                            m_targeted_inputs.end());
+  }
+
+  // Adds the assignments of the class members' cone inputs to the pattern
+  // database for each class split in the last round. Since the values of the
+  // members are determined by their cone inputs, replaying the recorded
+  // patterns splits the class the same way. Of the lanes splitting a class,
+  // only those are recorded that tell apart members not told apart by the
+  // lanes recorded before. Afterwards, the oldest patterns exceeding
+  // max_num_patterns are dropped.
+  void record_distinguishing_patterns()
+  {
+    if (m_options.patterns == nullptr) {
+      return;
+    }
+
+    for (std::vector<Lit> const& eq_class : m_classes) {
+      m_groups.assign(eq_class.size(), 0);
+      m_num_groups = 1;
+      bool inputs_collected = false;
+
+      for (std::size_t word = 0; word < bitvector::num_words; ++word) {
+        uint64_t const first_value = get_value(eq_class[0], word);
+        uint64_t difference = 0;
+        for (Lit const& member : eq_class) {
+          difference |= get_value(member, word) ^ first_value;
+        }
+
+        for (std::size_t lane = 0; lane < 64 && difference != 0; ++lane, difference >>= 1) {
+          if ((difference & 1) == 0 || !is_splitting_lane(eq_class, word, lane)) {
+            continue;
+          }
+
+          if (!inputs_collected) {
+            collect_class_inputs(eq_class);
+            inputs_collected = true;
+          }
+
+          std::vector<Lit> pattern;
+          for (std::size_t var : m_targeted_inputs) {
+            bool const value = ((m_assignments[var].get_words()[word] >> lane) & 1) != 0;
+            pattern.push_back(to_lit<Lit>(m_compaction.to_original(var), value));
+          }
+          m_options.patterns->patterns.push_back(std::move(pattern));
+
+          split_groups(eq_class, word, lane);
+        }
+      }
+    }
+
+    std::vector<std::vector<Lit>>& patterns = m_options.patterns->patterns;
+    if (patterns.size() > m_options.max_num_patterns) {
+      std::size_t const num_dropped = patterns.size() - m_options.max_num_patterns;
+      patterns.erase(patterns.begin(), patterns.begin() + num_dropped);
+    }
+  }
+
+  static constexpr uint8_t unassigned = 2;
+  static constexpr uint32_t no_group = std::numeric_limits<uint32_t>::max();
+
+  basic_bitvector_map<Width>& m_assignments;
+  Partition& m_partition;
+  simulation_tape const& m_tape;
+  var_compaction const& m_compaction;
+  refinement_options<Lit> const& m_options;
+  Propagator const& m_propagate;
+
+  fanin_cones m_cones;
+  std::vector<std::vector<Lit>> m_classes;
+  std::vector<std::size_t> m_targeted_classes;
+  std::size_t m_class_offset = 0;
+  uint64_t m_seed = 0x5f0e3c29a6d1b847ull;
+
+  std::vector<std::size_t> m_lhs_cone;
+  std::vector<std::size_t> m_rhs_cone;
+  std::vector<std::size_t> m_targeted_inputs;
+
+  std::vector<uint32_t> m_groups;
+  uint32_t m_num_groups = 0;
+  std::vector<uint8_t> m_first_value_in_group;
+  std::vector<uint32_t> m_split_group_ids;
+};
+
+}
+}
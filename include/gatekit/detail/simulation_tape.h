@@ -0,0 +1,248 @@
+#pragma once
+
+#include <gatekit/detail/bitvector.h>
+#include <gatekit/detail/bitvector_kernels.h>
+#include <gatekit/detail/bitvector_prop.h>
+#include <gatekit/detail/utils.h>
+#include <gatekit/detail/var_compaction.h>
+#include <gatekit/flat_gate_structure.h>
+#include <gatekit/gate.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace gatekit {
+namespace detail {
+
+/**
+ * \brief Gate structure compiled for repeated propagation
+ *
+ * propagate_gate() selects the clauses to check, decodes their literals and
+ * skips the output variable each time a gate is propagated. The tape does
+ * this once: for each gate, it stores the clauses checked by propagate_gate()
+ * as runs of operands, with each operand consisting of a variable index and
+ * a polarity. The gates of the tape have the same indices as the gates of
+ * the structure, so a propagation_schedule computed for the structure can be
+ * used for the tape, too.
+ */
+class simulation_tape {
+public:
+  struct tape_gate {
+    // The gate's clauses are [clauses_begin, clauses_end)
+    std::size_t clauses_begin = 0;
+    std::size_t clauses_end = 0;
+
+    std::size_t output_var = 0;
+
+    // If true, the output variable is assigned the negation of the
+    // conjunction of the clauses
+    bool invert_output = false;
+  };
+
+  simulation_tape() = default;
+
+  /**
+   * Compiles the given structure. The operand and output variable indices are
+   * mapped through `var_index_map`.
+   */
+  template <typename ClauseHandle, typename VarIndexMap = identity_var_index_map>
+  explicit simulation_tape(gate_structure<ClauseHandle> const& structure,
+                           VarIndexMap const& var_index_map = VarIndexMap{})
+  {
+    compile(structure.gates, var_index_map);
+  }
+
+  template <typename ClauseHandle, typename VarIndexMap = identity_var_index_map>
+  explicit simulation_tape(flat_gate_structure<ClauseHandle> const& structure,
+                           VarIndexMap const& var_index_map = VarIndexMap{})
+  {
+    compile(structure.gates, var_index_map);
+  }
+
+  auto num_gates() const noexcept -> std::size_t { return m_gates.size(); }
+
+  auto get_gate(std::size_t gate_index) const noexcept -> tape_gate const&
+  {
+    return m_gates[gate_index];
+  }
+
+  /**
+   * Returns the operands of the given clause. Operand `2*v` denotes the
+   * variable with index `v`, and operand `2*v + 1` denotes its negation.
+   */
+  auto get_operands(std::size_t clause_index) const noexcept -> span<uint32_t>
+  {
+    return span<uint32_t>{m_operands.data() + m_clause_offsets[clause_index],
+                          m_operands.data() + m_clause_offsets[clause_index + 1]};
+  }
+
+private:
+  template <typename Gates, typename VarIndexMap>
+  void compile(Gates const& gates, VarIndexMap const& var_index_map)
+  {
+    m_gates.reserve(gates.size());
+    for (auto const& gate : gates) {
+      add_gate(gate, var_index_map);
+    }
+  }
+
+  template <typename Gate, typename VarIndexMap>
+  void add_gate(Gate const& gate, VarIndexMap const& var_index_map)
+  {
+    using ClauseHandle = typename Gate::clause_handle;
+
+    std::size_t const out_var = to_var_index(gate.output);
+
+    tape_gate result;
+    result.clauses_begin = m_clause_offsets.size() - 1;
+
+    prop_clauses<Gate> clauses{gate};
+    for (ClauseHandle const& clause : clauses) {
+      for (auto const& lit : iterate(clause)) {
+        std::size_t const lit_var = to_var_index(lit);
+        if (lit_var != out_var) {
+          std::size_t const operand = 2 * var_index_map(lit_var) + (is_positive(lit) ? 0 : 1);
+          assert(operand <= std::numeric_limits<uint32_t>::max());
+          m_operands.push_back(static_cast<uint32_t>(operand));
+        }
+      }
+      m_clause_offsets.push_back(m_operands.size());
+    }
+
+    result.clauses_end = m_clause_offsets.size() - 1;
+    result.output_var = var_index_map(out_var);
+
+    // See propagate_gate() for how the output is derived from the clauses
+    bool const fwd_forces_output = !clauses.is_iterating_fwd();
+    result.invert_output = (fwd_forces_output == is_positive(gate.output));
+
+    m_gates.push_back(result);
+  }
+
+  std::vector<tape_gate> m_gates;
+  std::vector<std::size_t> m_clause_offsets = std::vector<std::size_t>(1, 0);
+  std::vector<uint32_t> m_operands;
+};
+
+
+/**
+ * Propagates the gate with the given index on the tape, using the given
+ * kernels. The result is the same as for propagate_gate() on the
+ * corresponding gate of the structure.
+ */
+template <std::size_t Width>
+void run_tape_gate(basic_bitvector_map<Width>& assignment_by_var,
+                   simulation_tape const& tape,
+                   std::size_t gate_index,
+                   bitvector_kernels const& kernels)
+{
+  using bitvector = basic_bitvector<Width>;
+
+  simulation_tape::tape_gate const& gate = tape.get_gate(gate_index);
+
+  // The output variable does not occur among the operands, so the clauses
+  // can be evaluated in place
+  bitvector& output = assignment_by_var[gate.output_var];
+  output.fill(~uint64_t{0});
+  uint64_t* const output_words = output.get_words().data();
+
+  // clause_satisfied is only initialized for long clauses
+  std::size_t const max_num_operands = 16;
+  bitvector_operand operands[max_num_operands];
+  alignas(64) typename bitvector::words_t clause_satisfied;
+
+  for (std::size_t clause = gate.clauses_begin; clause < gate.clauses_end; ++clause) {
+    span<uint32_t> const clause_operands = tape.get_operands(clause);
+    bool const is_long_clause = clause_operands.size() > max_num_operands;
+    std::size_t num_operands = 0;
+
+    if (is_long_clause) {
+      clause_satisfied.fill(0);
+    }
+
+    for (uint32_t operand : clause_operands) {
+      if (num_operands == max_num_operands) {
+        kernels.or_operands(clause_satisfied.data(), operands, num_operands);
+        num_operands = 0;
+      }
+
+      operands[num_operands].words = assignment_by_var[operand >> 1].get_words().data();
+      operands[num_operands].flip = uint64_t{0} - (operand & 1);
+      ++num_operands;
+    }
+
+    if (is_long_clause) {
+      kernels.or_operands(clause_satisfied.data(), operands, num_operands);
+      kernels.and_assign(output_words, clause_satisfied.data());
+    }
+    else {
+      kernels.and_clause(output_words, operands, num_operands);
+    }
+  }
+
+  if (gate.invert_output) {
+    kernels.invert(output_words);
+  }
+}
+
+template <std::size_t Width>
+void run_tape_gate(basic_bitvector_map<Width>& assignment_by_var,
+                   simulation_tape const& tape,
+                   std::size_t gate_index)
+{
+  run_tape_gate(assignment_by_var,
+                tape,
+                gate_index,
+                get_bitvector_kernels<basic_bitvector<Width>::num_words>());
+}
+
+/**
+ * Propagates all gates on the tape, like propagate_structure() does for the
+ * gates of the structure.
+ */
+template <std::size_t Width>
+void run_tape(basic_bitvector_map<Width>& assignment_by_var, simulation_tape const& tape)
+{
+  bitvector_kernels const& kernels = get_bitvector_kernels<basic_bitvector<Width>::num_words>();
+  for (std::size_t index = tape.num_gates(); index > 0; --index) {
+    run_tape_gate(assignment_by_var, tape, index - 1, kernels);
+  }
+}
+
+/**
+ * Propagates all gates on the tape in the order given by `schedule`, which
+ * must have been computed for the structure from which the tape has been
+ * compiled. The gates of each level are distributed to the threads of
+ * `workers`.
+ */
+template <std::size_t Width>
+void run_tape(basic_bitvector_map<Width>& assignment_by_var,
+              simulation_tape const& tape,
+              propagation_schedule const& schedule,
+              worker_pool& workers)
+{
+  bitvector_kernels const& kernels = get_bitvector_kernels<basic_bitvector<Width>::num_words>();
+  run_schedule(schedule, workers, [&](std::size_t gate_index) {
+    run_tape_gate(assignment_by_var, tape, gate_index, kernels);
+  });
+}
+
+/**
+ * Like run_tape(assignment_by_var, tape, schedule, workers), with up to
+ * `num_threads` threads started for this call only.
+ */
+template <std::size_t Width>
+void run_tape(basic_bitvector_map<Width>& assignment_by_var,
+              simulation_tape const& tape,
+              propagation_schedule const& schedule,
+              std::size_t num_threads)
+{
+  worker_pool workers{get_num_propagation_threads(schedule, num_threads)};
+  run_tape(assignment_by_var, tape, schedule, workers);
+}
+
+}
+}
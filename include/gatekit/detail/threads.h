@@ -0,0 +1,248 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gatekit {
+namespace detail {
+
+inline auto get_num_threads(std::size_t requested) -> std::size_t
+{
+  if (requested != 0) {
+    return requested;
+  }
+
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+
+/**
+ * Calls `task(index)` for each `index` in `[0, num_tasks)`, with each call
+ * running on its own thread. The calling thread executes the task with index
+ * 0. If a thread cannot be started, the calling thread also executes the
+ * tasks that have not been started. If tasks throw exceptions, one of them is
+ * rethrown after all tasks have finished.
+ */
+template <typename Task>
+void run_in_parallel(std::size_t num_tasks, Task&& task)
+{
+  std::vector<std::exception_ptr> errors(num_tasks);
+
+  auto run_task = [&task, &errors](std::size_t index) {
+    try {
+      task(index);
+    }
+    catch (...) {
+      errors[index] = std::current_exception();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  std::size_t num_started = std::min<std::size_t>(num_tasks, 1);
+  try {
+    workers.reserve(num_tasks);
+    for (; num_started < num_tasks; ++num_started) {
+      workers.emplace_back(run_task, num_started);
+    }
+  }
+  catch (std::exception const&) {
+    // Not rethrowing here, since the started threads need to be joined
+  }
+
+  if (num_tasks > 0) {
+    run_task(0);
+  }
+
+  for (std::size_t index = num_started; index < num_tasks; ++index) {
+    run_task(index);
+  }
+
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  for (std::exception_ptr const& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+
+/**
+ * Threads that are started once and then execute any number of jobs. This
+ * avoids starting and joining threads for each job, e.g. for each
+ * simulation round.
+ *
+ * If threads cannot be started, the pool has fewer threads than requested.
+ */
+class worker_pool {
+public:
+  explicit worker_pool(std::size_t num_threads) : m_errors(std::max<std::size_t>(num_threads, 1))
+  {
+    try {
+      m_workers.reserve(m_errors.size() - 1);
+      for (std::size_t index = 1; index < m_errors.size(); ++index) {
+        m_workers.emplace_back([this, index]() { work(index); });
+      }
+    }
+    catch (std::exception const&) {
+      // Continuing with the threads that have been started
+    }
+  }
+
+  ~worker_pool()
+  {
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      m_is_stopping = true;
+    }
+    m_job_started.notify_all();
+
+    for (std::thread& worker : m_workers) {
+      worker.join();
+    }
+  }
+
+  worker_pool(worker_pool const&) = delete;
+  auto operator=(worker_pool const&) -> worker_pool& = delete;
+
+  /**
+   * Returns the number of threads executing jobs, including the thread
+   * calling run().
+   */
+  auto size() const noexcept -> std::size_t { return m_workers.size() + 1; }
+
+  /**
+   * Calls `task(index)` for each `index` in `[0, size())`, with each call
+   * running on its own thread. The calling thread executes the task with index
+   * 0. If tasks throw exceptions, one of them is rethrown after all tasks have
+   * finished.
+   */
+  template <typename Task>
+  void run(Task const& task)
+  {
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      m_task = &task;
+      m_invoke_task = &invoke<Task>;
+      m_num_running = m_workers.size();
+      ++m_job;
+    }
+    m_job_started.notify_all();
+
+    run_task(0);
+
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_job_finished.wait(lock, [this]() { return m_num_running == 0; });
+    }
+
+    for (std::exception_ptr& error : m_errors) {
+      if (error) {
+        std::exception_ptr const to_rethrow = error;
+        std::fill(m_errors.begin(), m_errors.end(), nullptr);
+        std::rethrow_exception(to_rethrow);
+      }
+    }
+  }
+
+private:
+  template <typename Task>
+  static void invoke(void const* task, std::size_t index)
+  {
+    (*static_cast<Task const*>(task))(index);
+  }
+
+  void run_task(std::size_t index) noexcept
+  {
+    try {
+      m_invoke_task(m_task, index);
+    }
+    catch (...) {
+      m_errors[index] = std::current_exception();
+    }
+  }
+
+  void work(std::size_t index)
+  {
+    uint64_t last_job = 0;
+    std::unique_lock<std::mutex> lock{m_mutex};
+
+    while (true) {
+      m_job_started.wait(lock, [this, last_job]() { return m_is_stopping || m_job != last_job; });
+      if (m_is_stopping) {
+        return;
+      }
+
+      last_job = m_job;
+      lock.unlock();
+      run_task(index);
+      lock.lock();
+
+      if (--m_num_running == 0) {
+        m_job_finished.notify_one();
+      }
+    }
+  }
+
+  std::mutex m_mutex;
+  std::condition_variable m_job_started;
+  std::condition_variable m_job_finished;
+
+  // The current job. m_job is incremented for each job.
+  void const* m_task = nullptr;
+  void (*m_invoke_task)(void const*, std::size_t) = nullptr;
+  uint64_t m_job = 0;
+  std::size_t m_num_running = 0;
+  bool m_is_stopping = false;
+
+  // For each thread: the exception thrown by its task in the current job
+  std::vector<std::exception_ptr> m_errors;
+  std::vector<std::thread> m_workers;
+};
+
+
+/**
+ * Synchronization point for a fixed number of threads: arrive_and_wait()
+ * blocks until all threads have called it. The barrier can be reused
+ * immediately afterwards.
+ *
+ * Waiting threads yield instead of sleeping, since the barrier is used for
+ * separating short phases of work, where the latency of waking up sleeping
+ * threads would dominate.
+ */
+class barrier {
+public:
+  explicit barrier(std::size_t num_threads) : m_num_threads(num_threads) {}
+
+  void arrive_and_wait() noexcept
+  {
+    std::size_t const generation = m_generation.load(std::memory_order_acquire);
+
+    if (m_num_waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == m_num_threads) {
+      m_num_waiting.store(0, std::memory_order_relaxed);
+      m_generation.store(generation + 1, std::memory_order_release);
+      return;
+    }
+
+    while (m_generation.load(std::memory_order_acquire) == generation) {
+      std::this_thread::yield();
+    }
+  }
+
+private:
+  std::size_t m_num_threads;
+  std::atomic<std::size_t> m_num_waiting{0};
+  std::atomic<std::size_t> m_generation{0};
+};
+
+}
+}
@@ -129,6 +129,40 @@ void unstable_erase_first_all(std::vector<T>& container, std::vector<T>& to_eras
   }
 }
 
+/**
+ * Non-owning view of a contiguous sequence of constant objects
+ */
+template <typename T>
+class span {
+public:
+  using value_type = T;
+  using iterator = T const*;
+  using const_iterator = T const*;
+
+  span() = default;
+
+  span(T const* begin, T const* end) noexcept : m_begin(begin), m_end(end) {}
+
+  auto begin() const noexcept -> iterator { return m_begin; }
+
+  auto end() const noexcept -> iterator { return m_end; }
+
+  auto size() const noexcept -> std::size_t { return static_cast<std::size_t>(m_end - m_begin); }
+
+  auto empty() const noexcept -> bool { return m_begin == m_end; }
+
+  auto operator[](std::size_t index) const noexcept -> T const&
+  {
+    assert(index < size());
+    return m_begin[index];
+  }
+
+private:
+  T const* m_begin = nullptr;
+  T const* m_end = nullptr;
+};
+
+
 template <typename Container, typename Pred>
 void erase_remove_if(Container& container, Pred&& predicate)
 {
@@ -227,13 +261,29 @@ auto allocate_aligned(std::size_t num_objs) -> unique_aligned_array_ptr<T>
 }
 
 
+constexpr uint64_t xorshift_star_mult = 2685821657736338717ull;
+
 inline auto xorshift_star(uint64_t state) noexcept -> uint64_t
 {
-  const uint64_t mult = 2685821657736338717ull;
   state ^= state >> 12;
   state ^= state << 25;
   state ^= state >> 27;
-  return state * mult;
+  return state * xorshift_star_mult;
+}
+
+
+inline auto popcount(uint64_t value) noexcept -> std::size_t
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<std::size_t>(__builtin_popcountll(value));
+#else
+  std::size_t result = 0;
+  while (value != 0) {
+    value &= value - 1;
+    ++result;
+  }
+  return result;
+#endif
 }
 
 
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <gatekit/detail/bitvector_partition.h>
+#include <gatekit/detail/clause_utils.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace gatekit {
+namespace detail {
+
+/**
+ * Maps variable indices to themselves. Used for propagating gates on
+ * assignments indexed by the original variable indices.
+ */
+struct identity_var_index_map {
+  auto operator()(std::size_t var_index) const noexcept -> std::size_t { return var_index; }
+};
+
+
+/**
+ * \brief Renumbering of the variables occurring in a gate structure to the
+ *        dense index range [0, size())
+ *
+ * Structures recovered from large instances often contain only a small
+ * fraction of the instance's variables, so simulation state indexed by the
+ * original variable indices would mostly be wasted. The renumbering is
+ * monotonic: for occurring variables `x < y`, the dense index of `x` is less
+ * than the dense index of `y`.
+ */
+class var_compaction {
+public:
+  /**
+   * Computes the renumbering for the variables occurring in the clauses or
+   * outputs of `gates`, which can be the gates of a `gate_structure` or of a
+   * `flat_gate_structure`.
+   */
+  template <typename GateRange>
+  explicit var_compaction(GateRange const& gates)
+  {
+    for (auto const& gate : gates) {
+      add_var(to_var_index(gate.output));
+      for (auto const& clause : gate.clauses) {
+        for (auto const& lit : iterate(clause)) {
+          add_var(to_var_index(lit));
+        }
+      }
+    }
+
+    // Assigning the dense indices in a separate pass keeps them in the order
+    // of the original indices
+    for (std::size_t var = 0; var < m_dense_index.size(); ++var) {
+      if (m_dense_index[var] != absent) {
+        m_dense_index[var] = static_cast<uint32_t>(m_original_index.size());
+        m_original_index.push_back(var);
+      }
+    }
+  }
+
+  /**
+   * Returns the dense index of the given variable, which must occur in the
+   * structure.
+   */
+  auto operator()(std::size_t var_index) const noexcept -> std::size_t
+  {
+    assert(contains(var_index));
+    return m_dense_index[var_index];
+  }
+
+  auto contains(std::size_t var_index) const noexcept -> bool
+  {
+    return var_index < m_dense_index.size() && m_dense_index[var_index] != absent;
+  }
+
+  auto to_original(std::size_t dense_index) const noexcept -> std::size_t
+  {
+    return m_original_index[dense_index];
+  }
+
+  /**
+   * Returns the number of occurring variables.
+   */
+  auto size() const noexcept -> std::size_t { return m_original_index.size(); }
+
+  /**
+   * Returns the dense indices of the given variables, in the same order.
+   */
+  auto compact(std::vector<std::size_t> const& var_indices) const -> std::vector<std::size_t>
+  {
+    std::vector<std::size_t> result;
+    result.reserve(var_indices.size());
+    for (std::size_t var : var_indices) {
+      result.push_back((*this)(var));
+    }
+    return result;
+  }
+
+  /**
+   * Maps the literals of a partitioning computed in the dense index space
+   * back to the original variables.
+   */
+  template <typename Lit>
+  auto restore(lit_partitioning<Lit> partitioning) const -> lit_partitioning<Lit>
+  {
+    for (Lit& lit : partitioning.backbones) {
+      lit = restore(lit);
+    }
+
+    for (std::vector<Lit>& equivalence : partitioning.equivalences) {
+      for (Lit& lit : equivalence) {
+        lit = restore(lit);
+      }
+    }
+
+    return partitioning;
+  }
+
+private:
+  // The dense indices are stored with 32 bits, since the table has an entry
+  // for each variable up to the maximum occurring one
+  static constexpr uint32_t absent = std::numeric_limits<uint32_t>::max();
+  static constexpr uint32_t present = 0;
+
+  void add_var(std::size_t var_index)
+  {
+    if (var_index >= m_dense_index.size()) {
+      m_dense_index.resize(var_index + 1, uint32_t{absent});
+    }
+    m_dense_index[var_index] = present;
+  }
+
+  template <typename Lit>
+  auto restore(Lit lit) const -> Lit
+  {
+    return to_lit<Lit>(to_original(to_var_index(lit)), is_positive(lit));
+  }
+
+  std::vector<uint32_t> m_dense_index;
+  std::vector<std::size_t> m_original_index;
+};
+
+}
+}
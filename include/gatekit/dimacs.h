@@ -0,0 +1,63 @@
+/**
+ * \file
+ *
+ * \brief Functions for reading DIMACS CNF problem instances
+ */
+
+#pragma once
+
+#include <gatekit/clause_arena.h>
+#include <gatekit/detail/dimacs_parser.h>
+#include <gatekit/detail/mapped_file.h>
+#include <gatekit/detail/threads.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+
+namespace gatekit {
+
+/**
+ * Parses the DIMACS CNF problem instance contained in `[begin, end)`.
+ *
+ * The input is split into chunks that are parsed concurrently, and the
+ * resulting clauses are stored in a single clause_arena. The clause order
+ * of the input is preserved. Parsing stops at the end marker `%` used by some
+ * benchmark collections.
+ *
+ * \throws std::runtime_error if the input preceding the end marker contains invalid tokens
+ *
+ * \param num_threads     The maximum number of threads used for parsing. If
+ *                        `num_threads` is 0, the number of hardware threads is used.
+ */
+inline auto parse_dimacs(char const* begin, char const* end, std::size_t num_threads = 0)
+    -> clause_arena
+{
+  // Avoiding to start threads for small inputs
+  std::size_t const min_chunk_size = 1 << 20;
+  std::size_t const max_num_chunks = static_cast<std::size_t>(end - begin) / min_chunk_size + 1;
+
+  std::size_t const num_chunks = std::min(detail::get_num_threads(num_threads), max_num_chunks);
+  return detail::parse_dimacs_chunked(begin, end, num_chunks);
+}
+
+/**
+ * Reads the DIMACS CNF problem instance stored in the file at `path`.
+ *
+ * The file is memory-mapped if supported by the platform, and parsed
+ * like in `parse_dimacs()`.
+ *
+ * Usage example:
+ *
+ *     clause_arena clauses = read_dimacs("problem.cnf");
+ *     auto gates = scan_gates<arena_clause>(clauses.begin(), clauses.end());
+ *
+ * \throws std::runtime_error if the file cannot be read or contains invalid tokens
+ */
+inline auto read_dimacs(std::string const& path, std::size_t num_threads = 0) -> clause_arena
+{
+  detail::mapped_file const file{path};
+  return parse_dimacs(file.begin(), file.end(), num_threads);
+}
+
+}
@@ -0,0 +1,389 @@
+/**
+ * \file
+ *
+ * \brief Compact gate structure representation with contiguous storage
+ */
+
+#pragma once
+
+#include <gatekit/clause.h>
+#include <gatekit/gate.h>
+
+#include <gatekit/detail/utils.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace gatekit {
+
+/**
+ * \brief Read-only view of a gate stored in a flat_gate_list
+ *
+ * The view has the same members as `gate<ClauseHandle>`, with `clauses` and
+ * `inputs` being non-owning ranges instead of vectors. It is valid until the
+ * list it refers to is modified or destroyed.
+ */
+template <typename ClauseHandle>
+struct gate_view {
+  using lit = typename clause_funcs<ClauseHandle>::lit;
+  using clause_handle = ClauseHandle;
+
+  /**
+   * CNF representation of the gate, with the forward clauses preceding the
+   * backward clauses. See `gate::clauses`.
+   */
+  detail::span<ClauseHandle> clauses;
+
+  /**
+   * The gate input literals. See `gate::inputs`.
+   */
+  detail::span<lit> inputs;
+
+  lit output = lit{};
+  uint32_t num_fwd_clauses = 0;
+  bool is_nested_monotonically = false;
+};
+
+
+/**
+ * \brief Sequence of gates with all clause handles and inputs stored in two
+ *        contiguous pools
+ *
+ * Storing a `std::vector<gate>` requires two allocations per gate, and
+ * scatters the gates' clauses and inputs across the heap. This list stores
+ * the data of all gates in a fixed number of arrays instead: the clause
+ * handles and inputs of gate `i` are the ranges `[offsets[i], offsets[i+1])`
+ * of the respective pool, and the outputs and flags are kept in per-gate
+ * arrays. Gates are accessed via `gate_view` objects.
+ */
+template <typename ClauseHandle>
+class flat_gate_list {
+public:
+  using lit = typename clause_funcs<ClauseHandle>::lit;
+  using value_type = gate_view<ClauseHandle>;
+
+  class const_iterator {
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = gate_view<ClauseHandle>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = gate_view<ClauseHandle>;
+
+    const_iterator() = default;
+
+    const_iterator(flat_gate_list const* list, std::size_t index) noexcept
+      : m_list(list), m_index(index)
+    {
+    }
+
+    auto operator*() const -> gate_view<ClauseHandle> { return (*m_list)[m_index]; }
+
+    auto operator[](difference_type offset) const -> gate_view<ClauseHandle>
+    {
+      return *(*this + offset);
+    }
+
+    auto operator++() noexcept -> const_iterator&
+    {
+      ++m_index;
+      return *this;
+    }
+
+    auto operator++(int) noexcept -> const_iterator
+    {
+      const_iterator result = *this;
+      ++m_index;
+      return result;
+    }
+
+    auto operator--() noexcept -> const_iterator&
+    {
+      --m_index;
+      return *this;
+    }
+
+    auto operator--(int) noexcept -> const_iterator
+    {
+      const_iterator result = *this;
+      --m_index;
+      return result;
+    }
+
+    auto operator+=(difference_type offset) noexcept -> const_iterator&
+    {
+      m_index = static_cast<std::size_t>(static_cast<difference_type>(m_index) + offset);
+      return *this;
+    }
+
+    auto operator-=(difference_type offset) noexcept -> const_iterator&
+    {
+      return *this += -offset;
+    }
+
+    auto operator+(difference_type offset) const noexcept -> const_iterator
+    {
+      const_iterator result = *this;
+      return result += offset;
+    }
+
+    auto operator-(difference_type offset) const noexcept -> const_iterator
+    {
+      const_iterator result = *this;
+      return result -= offset;
+    }
+
+    auto operator-(const_iterator const& rhs) const noexcept -> difference_type
+    {
+      return static_cast<difference_type>(m_index) - static_cast<difference_type>(rhs.m_index);
+    }
+
+    auto operator==(const_iterator const& rhs) const noexcept -> bool
+    {
+      return m_index == rhs.m_index;
+    }
+
+    auto operator!=(const_iterator const& rhs) const noexcept -> bool
+    {
+      return m_index != rhs.m_index;
+    }
+
+    auto operator<(const_iterator const& rhs) const noexcept -> bool
+    {
+      return m_index < rhs.m_index;
+    }
+
+    auto operator>(const_iterator const& rhs) const noexcept -> bool { return rhs < *this; }
+
+    auto operator<=(const_iterator const& rhs) const noexcept -> bool { return !(rhs < *this); }
+
+    auto operator>=(const_iterator const& rhs) const noexcept -> bool { return !(*this < rhs); }
+
+  private:
+    flat_gate_list const* m_list = nullptr;
+    std::size_t m_index = 0;
+  };
+
+  using iterator = const_iterator;
+
+
+  flat_gate_list() : m_clause_offsets(1, 0), m_input_offsets(1, 0) {}
+
+  /**
+   * Appends a gate. `Gate` can be `gate<ClauseHandle>` or `gate_view<ClauseHandle>`,
+   * but views must not refer to gates of this list.
+   */
+  template <typename Gate>
+  void push_back(Gate const& gate)
+  {
+    m_clauses.insert(m_clauses.end(), gate.clauses.begin(), gate.clauses.end());
+    m_inputs.insert(m_inputs.end(), gate.inputs.begin(), gate.inputs.end());
+    m_clause_offsets.push_back(m_clauses.size());
+    m_input_offsets.push_back(m_inputs.size());
+
+    m_outputs.push_back(gate.output);
+    m_num_fwd_clauses.push_back(gate.num_fwd_clauses);
+    m_nested_monotonically_flags.push_back(gate.is_nested_monotonically ? 1 : 0);
+  }
+
+  /**
+   * Reserves memory for `num_gates` gates with a total of `num_clauses` clause
+   * handles and `num_inputs` inputs.
+   */
+  void reserve(std::size_t num_gates, std::size_t num_clauses, std::size_t num_inputs)
+  {
+    m_clauses.reserve(num_clauses);
+    m_inputs.reserve(num_inputs);
+    m_clause_offsets.reserve(num_gates + 1);
+    m_input_offsets.reserve(num_gates + 1);
+    m_outputs.reserve(num_gates);
+    m_num_fwd_clauses.reserve(num_gates);
+    m_nested_monotonically_flags.reserve(num_gates);
+  }
+
+  void clear() noexcept
+  {
+    m_clauses.clear();
+    m_inputs.clear();
+    m_clause_offsets.resize(1);
+    m_input_offsets.resize(1);
+    m_outputs.clear();
+    m_num_fwd_clauses.clear();
+    m_nested_monotonically_flags.clear();
+  }
+
+  auto operator[](std::size_t index) const noexcept -> gate_view<ClauseHandle>
+  {
+    assert(index < size());
+
+    gate_view<ClauseHandle> result;
+    result.clauses = detail::span<ClauseHandle>{m_clauses.data() + m_clause_offsets[index],
+                                                m_clauses.data() + m_clause_offsets[index + 1]};
+    result.inputs = detail::span<lit>{m_inputs.data() + m_input_offsets[index],
+                                      m_inputs.data() + m_input_offsets[index + 1]};
+    result.output = m_outputs[index];
+    result.num_fwd_clauses = m_num_fwd_clauses[index];
+    result.is_nested_monotonically = m_nested_monotonically_flags[index] != 0;
+    return result;
+  }
+
+  auto size() const noexcept -> std::size_t { return m_outputs.size(); }
+
+  auto empty() const noexcept -> bool { return m_outputs.empty(); }
+
+  auto begin() const noexcept -> const_iterator { return const_iterator{this, 0}; }
+
+  auto end() const noexcept -> const_iterator { return const_iterator{this, size()}; }
+
+  /**
+   * Returns the outputs of all gates, in the order of the gates
+   */
+  auto get_outputs() const noexcept -> std::vector<lit> const& { return m_outputs; }
+
+private:
+  std::vector<ClauseHandle> m_clauses;
+  std::vector<lit> m_inputs;
+
+  // Offsets of the gates' ranges in m_clauses and m_inputs, with a final
+  // entry marking the end of the last gate's range
+  std::vector<std::size_t> m_clause_offsets;
+  std::vector<std::size_t> m_input_offsets;
+
+  std::vector<lit> m_outputs;
+  std::vector<uint32_t> m_num_fwd_clauses;
+  std::vector<uint8_t> m_nested_monotonically_flags;
+};
+
+
+/**
+ * \brief Gate structure with contiguously stored gates
+ *
+ * This structure has the same members and semantics as `gate_structure`,
+ * with `gates` being a `flat_gate_list` instead of a vector of gates.
+ */
+template <typename ClauseHandle>
+struct flat_gate_structure {
+  using lit = typename clause_funcs<ClauseHandle>::lit;
+
+  flat_gate_list<ClauseHandle> gates;
+
+  // Root constraints, see gate_structure::roots
+  std::vector<std::vector<lit>> roots;
+};
+
+
+/**
+ * \brief Returns the flat representation of the given gate structure
+ *
+ * Use `scan_gates_flat()` to obtain the flat structure without creating a
+ * `gate_structure` first.
+ */
+template <typename ClauseHandle>
+auto flatten(gate_structure<ClauseHandle> const& structure) -> flat_gate_structure<ClauseHandle>
+{
+  std::size_t num_clauses = 0;
+  std::size_t num_inputs = 0;
+  for (gate<ClauseHandle> const& gate : structure.gates) {
+    num_clauses += gate.clauses.size();
+    num_inputs += gate.inputs.size();
+  }
+
+  flat_gate_structure<ClauseHandle> result;
+  result.gates.reserve(structure.gates.size(), num_clauses, num_inputs);
+  for (gate<ClauseHandle> const& gate : structure.gates) {
+    result.gates.push_back(gate);
+  }
+  result.roots = structure.roots;
+  return result;
+}
+
+
+/**
+ * \brief Returns a copy of the gate referred to by the view
+ */
+template <typename ClauseHandle>
+auto to_gate(gate_view<ClauseHandle> const& view) -> gate<ClauseHandle>
+{
+  gate<ClauseHandle> result;
+  result.clauses.assign(view.clauses.begin(), view.clauses.end());
+  result.inputs.assign(view.inputs.begin(), view.inputs.end());
+  result.output = view.output;
+  result.num_fwd_clauses = view.num_fwd_clauses;
+  result.is_nested_monotonically = view.is_nested_monotonically;
+  return result;
+}
+
+
+/**
+ * \brief Returns the representation of the given flat gate structure as
+ *        `gate_structure`
+ */
+template <typename ClauseHandle>
+auto to_gate_structure(flat_gate_structure<ClauseHandle> const& structure)
+    -> gate_structure<ClauseHandle>
+{
+  gate_structure<ClauseHandle> result;
+  result.gates.reserve(structure.gates.size());
+  for (gate_view<ClauseHandle> const& view : structure.gates) {
+    result.gates.push_back(to_gate(view));
+  }
+  result.roots = structure.roots;
+  return result;
+}
+
+
+/**
+ * \brief Returns a JSON object string representation of the given gate
+ */
+template <typename ClauseHandle>
+auto to_string(gate_view<ClauseHandle> const& gate) -> std::string
+{
+  return detail::gate_to_string(gate);
+}
+
+/**
+ * \brief Returns a JSON object string representation of the given gate
+ *        structure, in the same format as for `gate_structure`
+ */
+template <typename ClauseHandle>
+auto to_string(flat_gate_structure<ClauseHandle> const& structure) -> std::string
+{
+  return detail::structure_to_string(structure);
+}
+
+/**
+ * \brief Returns the maximum variable index occurring in the given gate, or 0
+ *        if the gate is empty
+ */
+template <typename ClauseHandle>
+auto max_var_index(gate_view<ClauseHandle> const& gate) -> std::size_t
+{
+  return detail::gate_max_var_index(gate);
+}
+
+/**
+ * \brief Returns the maximum variable index occurring in the given gate
+ *        structure, or 0 if the structure is empty.
+ */
+template <typename ClauseHandle>
+auto max_var_index(flat_gate_structure<ClauseHandle> const& structure) -> std::size_t
+{
+  return detail::gates_max_var_index(structure.gates);
+}
+
+/**
+ * \brief Returns the indices of all variables that occur in any gate inputs,
+ *        but are not gate outputs. The result is sorted in ascending order.
+ */
+template <typename ClauseHandle>
+auto input_var_indices(flat_gate_structure<ClauseHandle> const& structure)
+    -> std::vector<std::size_t>
+{
+  return detail::gates_input_var_indices(structure.gates);
+}
+
+}
@@ -10,6 +10,8 @@
 #include <gatekit/detail/clause_utils.h>
 #include <gatekit/detail/utils.h>
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <unordered_set>
@@ -95,97 +97,79 @@ struct gate_structure {
 
   std::vector<gate<Clause>> gates;
 
-  // Root constraints, e.g. a unary clause. May be empty.
+  // Root constraints, e.g. a unary clause, or a non-unary clause if the scanner
+  // has been configured to start from such clauses. May be empty.
   std::vector<std::vector<lit>> roots;
 };
 
 
-/**
- * \brief Returns a JSON object string representation of the given gate
- */
-template <typename ClauseHandle>
-auto to_string(gate<ClauseHandle> const& gate) -> std::string
+namespace detail {
+template <typename Gate>
+auto gate_to_string(Gate const& gate) -> std::string
 {
   using std::to_string;
+  using clause_handle = typename Gate::clause_handle;
 
   std::string result = "{";
-  result += "\"inputs\": " + detail::iterable_to_string(gate.inputs) + ", ";
+  result += "\"inputs\": " + iterable_to_string(gate.inputs) + ", ";
   result += "\"output\": " + to_string(gate.output) + ", ";
   result += "\"num_fwd_clauses\": " + to_string(gate.num_fwd_clauses) + ", ";
   result += "\"is_nested_monotonically\": " + to_string(gate.is_nested_monotonically) + ", ";
-  result +=
-      "\"clauses\": " + detail::iterable_to_string(gate.clauses, [](ClauseHandle const& clause) {
-        return detail::iterable_to_string(::gatekit::detail::iterate(clause));
-      });
+  result += "\"clauses\": " + iterable_to_string(gate.clauses, [](clause_handle const& clause) {
+              return iterable_to_string(::gatekit::detail::iterate(clause));
+            });
 
   result += "}";
   return result;
 }
 
-/**
- * \brief Returns a JSON object string representation of the given gate
- *        structure
- */
-template <typename ClauseHandle>
-auto to_string(gate_structure<ClauseHandle> const& structure) -> std::string
+template <typename Structure>
+auto structure_to_string(Structure const& structure) -> std::string
 {
-  using lit = typename clause_funcs<ClauseHandle>::lit;
+  using lit = typename Structure::lit;
 
   std::string result = "{";
-  result += "\"gates\": " + detail::iterable_to_string(structure.gates) + ", ";
-  result += "\"roots\": " +
-            detail::iterable_to_string(structure.roots, [](std::vector<lit> const& roots) {
-              return detail::iterable_to_string(roots);
+  result += "\"gates\": " + iterable_to_string(structure.gates) + ", ";
+  result += "\"roots\": " + iterable_to_string(structure.roots, [](std::vector<lit> const& roots) {
+              return iterable_to_string(roots);
             });
 
   result += "}";
   return result;
 }
 
-/**
- * \brief Returns the maximum variable index occurring in the given gate, or 0
- *        if the gate is empty
- */
-template <typename ClauseHandle>
-auto max_var_index(gate<ClauseHandle> const& gate) -> std::size_t
+template <typename Gate>
+auto gate_max_var_index(Gate const& gate) -> std::size_t
 {
-  std::size_t result = detail::to_var_index(gate.output);
+  std::size_t result = to_var_index(gate.output);
   for (auto const& clause : gate.clauses) {
-    for (auto const& lit : *clause) {
-      result = std::max(result, detail::to_var_index(lit));
+    for (auto const& lit : iterate(clause)) {
+      result = std::max(result, to_var_index(lit));
     }
   }
   return result;
 }
 
-/**
- * \brief Returns the maximum variable index occurring in the given gate
- *        structure, or 0 if the structure is empty.
- */
-template <typename ClauseHandle>
-auto max_var_index(gate_structure<ClauseHandle> const& structure) -> std::size_t
+template <typename GateRange>
+auto gates_max_var_index(GateRange const& gates) -> std::size_t
 {
   std::size_t result = 0;
-  for (auto const& gate : structure.gates) {
-    result = std::max(result, max_var_index(gate));
+  for (auto const& gate : gates) {
+    result = std::max(result, gate_max_var_index(gate));
   }
   return result;
 }
 
-/**
- * \brief Returns the indices of all variables that occur in any gate inputs,
- *        but are not gate outputs. The result is sorted in ascending order.
- */
-template <typename ClauseHandle>
-auto input_var_indices(gate_structure<ClauseHandle> const& structure) -> std::vector<std::size_t>
+template <typename GateRange>
+auto gates_input_var_indices(GateRange const& gates) -> std::vector<std::size_t>
 {
   std::unordered_set<std::size_t> seen_outputs;
   std::unordered_set<std::size_t> seen_vars;
 
-  for (auto const& gate : structure.gates) {
-    seen_outputs.insert(detail::to_var_index(gate.output));
+  for (auto const& gate : gates) {
+    seen_outputs.insert(to_var_index(gate.output));
     for (auto const& input_lit : gate.inputs) {
-      seen_vars.insert(detail::to_var_index(input_lit));
+      seen_vars.insert(to_var_index(input_lit));
     }
   }
 
@@ -198,5 +182,56 @@ auto input_var_indices(gate_structure<ClauseHandle> const& structure) -> std::ve
 
   return result;
 }
+}
+
+
+/**
+ * \brief Returns a JSON object string representation of the given gate
+ */
+template <typename ClauseHandle>
+auto to_string(gate<ClauseHandle> const& gate) -> std::string
+{
+  return detail::gate_to_string(gate);
+}
+
+/**
+ * \brief Returns a JSON object string representation of the given gate
+ *        structure
+ */
+template <typename ClauseHandle>
+auto to_string(gate_structure<ClauseHandle> const& structure) -> std::string
+{
+  return detail::structure_to_string(structure);
+}
+
+/**
+ * \brief Returns the maximum variable index occurring in the given gate, or 0
+ *        if the gate is empty
+ */
+template <typename ClauseHandle>
+auto max_var_index(gate<ClauseHandle> const& gate) -> std::size_t
+{
+  return detail::gate_max_var_index(gate);
+}
+
+/**
+ * \brief Returns the maximum variable index occurring in the given gate
+ *        structure, or 0 if the structure is empty.
+ */
+template <typename ClauseHandle>
+auto max_var_index(gate_structure<ClauseHandle> const& structure) -> std::size_t
+{
+  return detail::gates_max_var_index(structure.gates);
+}
+
+/**
+ * \brief Returns the indices of all variables that occur in any gate inputs,
+ *        but are not gate outputs. The result is sorted in ascending order.
+ */
+template <typename ClauseHandle>
+auto input_var_indices(gate_structure<ClauseHandle> const& structure) -> std::vector<std::size_t>
+{
+  return detail::gates_input_var_indices(structure.gates);
+}
 
 }
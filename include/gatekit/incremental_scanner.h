@@ -0,0 +1,719 @@
+/**
+ * \file
+ *
+ * \brief Gate structure scanner keeping the gate structure up to date while
+ *        clauses are added and removed
+ */
+
+#pragma once
+
+#include <gatekit/detail/clause_utils.h>
+#include <gatekit/detail/collections.h>
+#include <gatekit/detail/occurrence_list.h>
+#include <gatekit/detail/scanner_structure.h>
+#include <gatekit/detail/utils.h>
+
+#include <gatekit/clause.h>
+#include <gatekit/gate.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gatekit {
+
+/**
+ * \brief Gate structure scanner for problem instances that change over time
+ *
+ * Usage example: scan the problem instance for gates before running the
+ *   simplifier, then keep the gate structure current during inprocessing by
+ *   passing each clause addition and removal to the scanner.
+ *
+ * The scanner keeps its occurrence list alive between updates. Gates are
+ * recovered in cones: a cone is the set of gates discovered by a single
+ * search starting at a root (ie. a unary clause) or at a gate input whose
+ * clauses have changed. A clause change only causes the cones containing
+ * gates with clauses affected by the change to be dissolved and scanned
+ * again, and unary clauses and gate inputs occurring in the change to be
+ * scanned. If rescanned cones use outputs of existing gates, the gates behind
+ * the first of these are sorted topologically, keeping the gate structure
+ * reverse-topologically ordered. The scanner counts the polarities in which
+ * each literal is used as a gate input, so after each update, only the nested
+ * monotonicity of gates whose outputs are used differently is recomputed.
+ *
+ * Apart from the scan itself, the work per update is proportional to the
+ * number of changed gates, except that removing or inserting gates moves the
+ * gates behind them in the gate list.
+ *
+ * Changes are applied lazily in get_gate_structure().
+ *
+ * \tparam ClauseHandle   The clause handle type. See clause.h for more information.
+ *                        Clause handles need to be hashable.
+ */
+template <typename ClauseHandle>
+class incremental_scanner {
+public:
+  using lit = typename clause_funcs<ClauseHandle>::lit;
+
+  template <typename ClauseHandleIter>
+  incremental_scanner(ClauseHandleIter begin, ClauseHandleIter end) : m_occs{begin, end}
+  {
+    std::vector<lit> const unaries = m_occs.get_unaries();
+    for (lit unary : unaries) {
+      if (!is_gate_output(detail::to_var_index(unary))) {
+        scan_from(unary, true);
+      }
+      else {
+        add_unused_unary(take_unary(unary));
+      }
+    }
+
+    // The nested monotonicity of the initial gates is computed while scanning
+    m_changed_input_vars.clear();
+  }
+
+  /**
+   * Adds a clause to the problem instance.
+   */
+  void add_clause(ClauseHandle clause)
+  {
+    for (lit literal : detail::iterate(clause)) {
+      std::size_t const var = detail::to_var_index(literal);
+      if (is_gate_output(var)) {
+        mark_dirty(m_cone_by_output_var[var] - 1);
+      }
+      m_touched_vars.push_back(var);
+    }
+
+    m_occs.add(clause);
+  }
+
+  /**
+   * Removes a clause from the problem instance. The clause must still be
+   * accessible via `clause_funcs<ClauseHandle>` while this function is executed.
+   */
+  void remove_clause(ClauseHandle clause)
+  {
+    auto const owner = m_owner_var_by_clause.find(clause);
+    if (owner != m_owner_var_by_clause.end()) {
+      mark_dirty(m_cone_by_output_var[owner->second] - 1);
+      m_owner_var_by_clause.erase(owner);
+      return;
+    }
+
+    if (detail::get_size(clause) == 1 && remove_unused_unary(clause)) {
+      return;
+    }
+
+    for (lit literal : detail::iterate(clause)) {
+      m_touched_vars.push_back(detail::to_var_index(literal));
+    }
+
+    m_occs.remove(clause);
+  }
+
+  /**
+   * Returns the gate structure of the current problem instance, after
+   * applying all clause changes passed to the scanner so far.
+   */
+  auto get_gate_structure() -> gate_structure<ClauseHandle> const&
+  {
+    while (!m_dirty_cones.empty() || !m_touched_vars.empty() || !m_changed_input_vars.empty()) {
+      dissolve_dirty_cones();
+      scan_touched_vars();
+      mark_cones_using_restored_clauses_dirty();
+      update_nested_monotonicity();
+    }
+    return m_structure;
+  }
+
+private:
+  struct cone {
+    lit start = lit{};
+    ClauseHandle root_clause = ClauseHandle{};
+    bool is_root = false;
+    bool is_dirty = false;
+    uint64_t epoch = 0;
+
+    // The index of the root in m_structure.roots, if is_root is true
+    std::size_t root_position = 0;
+
+    std::vector<std::size_t> output_vars;
+  };
+
+  /**
+   * Occurrence list of the clauses of a single gate, which are partitioned
+   * into forward and backward clauses in the gate
+   */
+  class gate_occurrences {
+  public:
+    using lit = typename clause_funcs<ClauseHandle>::lit;
+    using clause_handle = ClauseHandle;
+
+    explicit gate_occurrences(gate<ClauseHandle> const& gate) noexcept : m_gate(&gate) {}
+
+    auto operator[](lit const& literal) const -> detail::span<ClauseHandle>
+    {
+      ClauseHandle const* const begin = m_gate->clauses.data();
+      ClauseHandle const* const fwd_end = begin + m_gate->num_fwd_clauses;
+
+      if (literal == m_gate->output) {
+        return detail::span<ClauseHandle>{fwd_end, begin + m_gate->clauses.size()};
+      }
+
+      if (literal == detail::negate(m_gate->output)) {
+        return detail::span<ClauseHandle>{begin, fwd_end};
+      }
+
+      return detail::span<ClauseHandle>{};
+    }
+
+  private:
+    gate<ClauseHandle> const* m_gate;
+  };
+
+  auto is_gate_output(std::size_t var) const noexcept -> bool
+  {
+    return var < m_cone_by_output_var.size() && m_cone_by_output_var[var] != 0;
+  }
+
+  void mark_dirty(std::size_t cone_id)
+  {
+    if (!m_cones[cone_id].is_dirty) {
+      m_cones[cone_id].is_dirty = true;
+      m_dirty_cones.push_back(cone_id);
+    }
+  }
+
+  auto find_unary(lit literal) const -> ClauseHandle const*
+  {
+    std::vector<ClauseHandle> const& occs = m_occs[literal];
+    auto const unary = std::find_if(occs.begin(), occs.end(), [](ClauseHandle const& clause) {
+      return detail::get_size(clause) == 1;
+    });
+
+    if (unary != occs.end()) {
+      return &*unary;
+    }
+
+    std::size_t const index = detail::to_index(literal);
+    if (index < m_unused_unaries_by_lit.size() && !m_unused_unaries_by_lit[index].empty()) {
+      return &m_unused_unaries_by_lit[index].back();
+    }
+
+    return nullptr;
+  }
+
+  /**
+   * Removes a unary clause of `literal`, which must exist, from m_occs or
+   * from the unused unary clauses, and returns it
+   */
+  auto take_unary(lit literal) -> ClauseHandle
+  {
+    ClauseHandle const result = *find_unary(literal);
+    if (!remove_unused_unary(result)) {
+      m_occs.remove_unary(literal);
+    }
+    return result;
+  }
+
+  /**
+   * Like scan_gates(), the scanner removes unary clauses from the occurrence
+   * list when scanning from them, even if no gates are found. Otherwise, they
+   * would prevent the gates defining their variables from being recognized.
+   */
+  void add_unused_unary(ClauseHandle clause)
+  {
+    std::size_t const index = detail::to_index(detail::get_lit(clause, 0));
+    if (m_unused_unaries_by_lit.size() <= index) {
+      m_unused_unaries_by_lit.resize(index + 1);
+    }
+    m_unused_unaries_by_lit[index].push_back(clause);
+  }
+
+  auto remove_unused_unary(ClauseHandle clause) -> bool
+  {
+    std::size_t const index = detail::to_index(detail::get_lit(clause, 0));
+    if (index >= m_unused_unaries_by_lit.size()) {
+      return false;
+    }
+
+    std::vector<ClauseHandle>& unaries = m_unused_unaries_by_lit[index];
+    std::size_t const size_before = unaries.size();
+    detail::unstable_erase_first(unaries, clause);
+    return unaries.size() != size_before;
+  }
+
+  void add_inputs(gate<ClauseHandle> const& gate)
+  {
+    // The inputs have already been added to m_inputs by the scanner
+    for (lit input_lit : gate.inputs) {
+      m_changed_input_vars.push_back(detail::to_var_index(input_lit));
+    }
+  }
+
+  void remove_inputs(gate<ClauseHandle> const& gate)
+  {
+    m_inputs.remove_all(gate.inputs);
+
+    if (!gate.is_nested_monotonically) {
+      for (lit input_lit : gate.inputs) {
+        m_inputs.remove(detail::negate(input_lit));
+      }
+    }
+
+    for (lit input_lit : gate.inputs) {
+      m_changed_input_vars.push_back(detail::to_var_index(input_lit));
+    }
+  }
+
+  void dissolve_dirty_cones()
+  {
+    if (m_dirty_cones.empty()) {
+      return;
+    }
+
+    std::vector<std::size_t> removed_gates;
+    std::vector<std::size_t> removed_roots;
+
+    for (std::size_t cone_id : m_dirty_cones) {
+      cone& dissolved = m_cones[cone_id];
+
+      for (std::size_t output_var : dissolved.output_vars) {
+        std::size_t const position = m_position_by_output_var[output_var];
+        gate<ClauseHandle> const& gate = m_structure.gates[position];
+
+        for (ClauseHandle const& clause : gate.clauses) {
+          restore_clause(clause);
+        }
+
+        remove_inputs(gate);
+        m_cone_by_output_var[output_var] = 0;
+        m_touched_vars.push_back(output_var);
+        removed_gates.push_back(position);
+      }
+
+      if (dissolved.is_root) {
+        restore_clause(dissolved.root_clause);
+        removed_roots.push_back(dissolved.root_position);
+      }
+
+      m_touched_vars.push_back(detail::to_var_index(dissolved.start));
+      dissolved = cone{};
+      m_free_cone_ids.push_back(cone_id);
+    }
+
+    m_dirty_cones.clear();
+
+    update_gate_positions(erase_positions(m_structure.gates, removed_gates));
+    update_root_positions(erase_positions(m_structure.roots, removed_roots));
+  }
+
+  void restore_clause(ClauseHandle const& clause)
+  {
+    // Removed clauses have already been dropped from m_owner_var_by_clause
+    auto const owner = m_owner_var_by_clause.find(clause);
+    if (owner != m_owner_var_by_clause.end()) {
+      m_owner_var_by_clause.erase(owner);
+      m_occs.add(clause);
+      m_restored_clauses.push_back(clause);
+    }
+  }
+
+  /**
+   * Gates are only recognized if no other clause in m_occs contains their
+   * output. Restored clauses that have not become part of a gate or root
+   * again can violate this for existing gates, so the cones of these gates
+   * are scanned again.
+   */
+  void mark_cones_using_restored_clauses_dirty()
+  {
+    for (ClauseHandle const& clause : m_restored_clauses) {
+      if (m_owner_var_by_clause.count(clause) != 0) {
+        continue;
+      }
+
+      for (lit literal : detail::iterate(clause)) {
+        std::size_t const var = detail::to_var_index(literal);
+        if (is_gate_output(var)) {
+          mark_dirty(m_cone_by_output_var[var] - 1);
+        }
+      }
+    }
+
+    m_restored_clauses.clear();
+  }
+
+  /**
+   * Removes the elements at the given positions, keeping the order of the
+   * remaining elements. Returns the position of the first element that has
+   * been moved or removed.
+   */
+  template <typename T>
+  static auto erase_positions(std::vector<T>& elements, std::vector<std::size_t>& positions)
+      -> std::size_t
+  {
+    if (positions.empty()) {
+      return elements.size();
+    }
+
+    std::sort(positions.begin(), positions.end());
+
+    std::size_t const first = positions.front();
+    std::size_t target = first;
+    auto next_removed = positions.begin();
+
+    for (std::size_t source = first; source < elements.size(); ++source) {
+      if (next_removed != positions.end() && *next_removed == source) {
+        ++next_removed;
+        continue;
+      }
+
+      elements[target++] = std::move(elements[source]);
+    }
+
+    elements.erase(elements.begin() + target, elements.end());
+    return first;
+  }
+
+  void update_gate_positions(std::size_t first)
+  {
+    for (std::size_t idx = first; idx < m_structure.gates.size(); ++idx) {
+      m_position_by_output_var[detail::to_var_index(m_structure.gates[idx].output)] = idx;
+    }
+  }
+
+  void update_root_positions(std::size_t first)
+  {
+    for (std::size_t idx = first; idx < m_structure.roots.size(); ++idx) {
+      std::size_t const root_var = detail::to_var_index(m_structure.roots[idx].front());
+      m_cones[m_cone_by_output_var[root_var] - 1].root_position = idx;
+    }
+  }
+
+  void scan_touched_vars()
+  {
+    if (m_touched_vars.empty()) {
+      return;
+    }
+
+    std::sort(m_touched_vars.begin(), m_touched_vars.end());
+    m_touched_vars.erase(std::unique(m_touched_vars.begin(), m_touched_vars.end()),
+                         m_touched_vars.end());
+
+    // Root candidates are scanned first, as in scan_gates(). The remaining
+    // touched gate inputs may have become recognizable gate outputs since
+    // the clauses of a gate input were changed.
+    std::vector<lit> root_candidates;
+    std::vector<lit> inner_candidates;
+
+    for (std::size_t var : m_touched_vars) {
+      if (is_gate_output(var)) {
+        continue;
+      }
+
+      lit const pos = detail::to_lit<lit>(var, true);
+      lit const neg = detail::negate(pos);
+
+      bool const has_pos_unary = find_unary(pos) != nullptr;
+      bool const has_neg_unary = find_unary(neg) != nullptr;
+
+      if (has_pos_unary) {
+        root_candidates.push_back(pos);
+      }
+      if (has_neg_unary) {
+        root_candidates.push_back(neg);
+      }
+
+      if (!has_pos_unary && !has_neg_unary && (m_inputs.contains(pos) || m_inputs.contains(neg))) {
+        inner_candidates.push_back(m_inputs.contains(pos) ? pos : neg);
+      }
+    }
+
+    m_touched_vars.clear();
+
+    ++m_epoch;
+    std::size_t const num_old_gates = m_structure.gates.size();
+
+    for (lit candidate : root_candidates) {
+      if (!is_gate_output(detail::to_var_index(candidate)) && find_unary(candidate) != nullptr) {
+        scan_from(candidate, true);
+      }
+    }
+
+    for (lit candidate : inner_candidates) {
+      if (!is_gate_output(detail::to_var_index(candidate))) {
+        scan_from(candidate, false);
+      }
+    }
+
+    insert_new_gates(num_old_gates);
+  }
+
+  /**
+   * Recomputes the nested monotonicity of the gates defining the variables in
+   * m_changed_input_vars, ie. the variables whose polarities in m_inputs have
+   * changed. Like in scan_gates(), a gate is nested monotonically iff the gates
+   * preceding it do not use its output in both polarities. When a gate changes,
+   * the polarities of its inputs change, so the gates defining them are updated
+   * as well. The gates are updated in the order of the gate list, so that all
+   * users of a gate have been updated before the gate.
+   *
+   * Gates that have been recognized only because they were nested
+   * monotonically are not necessarily fully encoded. If such a gate is not
+   * nested monotonically anymore, its cone is marked dirty, so that it is
+   * scanned again.
+   */
+  void update_nested_monotonicity()
+  {
+    std::priority_queue<std::size_t, std::vector<std::size_t>, std::greater<std::size_t>> pending;
+
+    for (std::size_t var : m_changed_input_vars) {
+      if (is_gate_output(var)) {
+        pending.push(m_position_by_output_var[var]);
+      }
+    }
+    m_changed_input_vars.clear();
+
+    std::size_t const no_position = m_structure.gates.size();
+    std::size_t last_position = no_position;
+
+    while (!pending.empty()) {
+      std::size_t const position = pending.top();
+      pending.pop();
+
+      if (position == last_position) {
+        continue;
+      }
+      last_position = position;
+
+      gate<ClauseHandle>& gate = m_structure.gates[position];
+      bool const is_nested_monotonically =
+          !(m_inputs.contains(gate.output) && m_inputs.contains(detail::negate(gate.output)));
+
+      if (gate.is_nested_monotonically == is_nested_monotonically) {
+        continue;
+      }
+
+      if (!is_nested_monotonically && !is_fully_encoded(gate)) {
+        mark_dirty(m_cone_by_output_var[detail::to_var_index(gate.output)] - 1);
+      }
+
+      gate.is_nested_monotonically = is_nested_monotonically;
+
+      for (lit input_lit : gate.inputs) {
+        if (is_nested_monotonically) {
+          m_inputs.remove(detail::negate(input_lit));
+        }
+        else {
+          m_inputs.add(detail::negate(input_lit));
+        }
+
+        std::size_t const input_var = detail::to_var_index(input_lit);
+        if (is_gate_output(input_var)) {
+          pending.push(m_position_by_output_var[input_var]);
+        }
+      }
+    }
+  }
+
+  auto is_fully_encoded(gate<ClauseHandle> const& gate) -> bool
+  {
+    return detail::is_output_of_fully_encoded_gate(
+        gate.output, gate_occurrences{gate}, m_matcher_state);
+  }
+
+  void scan_from(lit start, bool is_root)
+  {
+    std::size_t const num_gates_before = m_structure.gates.size();
+
+    ClauseHandle root_clause = ClauseHandle{};
+    if (is_root) {
+      root_clause = take_unary(start);
+    }
+
+    bool const found_gates = detail::extend_gate_structure_from(
+        m_structure, m_occs, m_inputs, m_matcher_state, start);
+
+    if (!found_gates) {
+      if (is_root) {
+        add_unused_unary(root_clause);
+      }
+      return;
+    }
+
+    std::size_t const cone_id = allocate_cone();
+    cone& new_cone = m_cones[cone_id];
+    new_cone.start = start;
+    new_cone.is_root = is_root;
+    new_cone.epoch = m_epoch;
+
+    if (is_root) {
+      new_cone.root_clause = root_clause;
+      new_cone.root_position = m_structure.roots.size();
+      m_owner_var_by_clause[root_clause] = detail::to_var_index(start);
+      m_structure.roots.push_back({start});
+    }
+
+    for (std::size_t idx = num_gates_before; idx < m_structure.gates.size(); ++idx) {
+      gate<ClauseHandle> const& new_gate = m_structure.gates[idx];
+      std::size_t const output_var = detail::to_var_index(new_gate.output);
+
+      if (m_cone_by_output_var.size() <= output_var) {
+        m_cone_by_output_var.resize(output_var + 1, 0);
+        m_position_by_output_var.resize(output_var + 1, 0);
+      }
+      m_cone_by_output_var[output_var] = cone_id + 1;
+      m_position_by_output_var[output_var] = idx;
+      new_cone.output_vars.push_back(output_var);
+
+      for (ClauseHandle const& clause : new_gate.clauses) {
+        m_owner_var_by_clause[clause] = output_var;
+      }
+
+      add_inputs(new_gate);
+    }
+  }
+
+  auto allocate_cone() -> std::size_t
+  {
+    if (m_free_cone_ids.empty()) {
+      m_cones.emplace_back();
+      return m_cones.size() - 1;
+    }
+
+    std::size_t const result = m_free_cone_ids.back();
+    m_free_cone_ids.pop_back();
+    return result;
+  }
+
+  auto is_old_gate_output(std::size_t var) const noexcept -> bool
+  {
+    return is_gate_output(var) && m_cones[m_cone_by_output_var[var] - 1].epoch != m_epoch;
+  }
+
+  void insert_new_gates(std::size_t num_old_gates)
+  {
+    // New gates are appended to the gate list, so they are ordered after
+    // the existing gates using their outputs. However, cones scanned again
+    // can contain gates using outputs of existing gates, since their clauses
+    // have been restored to the occurrence list. In that case, the gates
+    // starting at the first existing gate defining an input of a new gate are
+    // reordered. The gates in front of it don't define inputs of new gates.
+
+    std::vector<gate<ClauseHandle>> const& gates = m_structure.gates;
+    std::size_t first_definer = num_old_gates;
+
+    for (std::size_t idx = num_old_gates; idx < gates.size(); ++idx) {
+      for (lit input : gates[idx].inputs) {
+        std::size_t const input_var = detail::to_var_index(input);
+        if (is_old_gate_output(input_var)) {
+          first_definer = std::min(first_definer, m_position_by_output_var[input_var]);
+        }
+      }
+    }
+
+    if (first_definer != num_old_gates) {
+      sort_topologically(first_definer);
+    }
+  }
+
+  /**
+   * Reorders the gates starting at `first` such that each gate precedes the
+   * gates defining its inputs. Apart from that, the order of the gates is kept.
+   */
+  void sort_topologically(std::size_t first)
+  {
+    std::vector<gate<ClauseHandle>>& gates = m_structure.gates;
+
+    // For each gate in the range: the number of its uses by gates in the range
+    std::vector<std::size_t> num_users(gates.size() - first, 0);
+    for (std::size_t idx = first; idx < gates.size(); ++idx) {
+      for (lit input : gates[idx].inputs) {
+        std::size_t const definer = get_definer_position(input);
+        if (definer >= first && definer < gates.size()) {
+          ++num_users[definer - first];
+        }
+      }
+    }
+
+    std::priority_queue<std::size_t, std::vector<std::size_t>, std::greater<std::size_t>> ready;
+    for (std::size_t idx = first; idx < gates.size(); ++idx) {
+      if (num_users[idx - first] == 0) {
+        ready.push(idx);
+      }
+    }
+
+    std::vector<gate<ClauseHandle>> sorted;
+    sorted.reserve(gates.size() - first);
+
+    while (!ready.empty()) {
+      std::size_t const position = ready.top();
+      ready.pop();
+
+      for (lit input : gates[position].inputs) {
+        std::size_t const definer = get_definer_position(input);
+        if (definer >= first && definer < gates.size() && --num_users[definer - first] == 0) {
+          ready.push(definer);
+        }
+      }
+
+      sorted.push_back(std::move(gates[position]));
+    }
+
+    std::move(sorted.begin(), sorted.end(), gates.begin() + first);
+    update_gate_positions(first);
+  }
+
+  /**
+   * Returns the position of the gate defining `literal`, or the size of the
+   * gate list if `literal` is not a gate output
+   */
+  auto get_definer_position(lit literal) const -> std::size_t
+  {
+    std::size_t const var = detail::to_var_index(literal);
+    return is_gate_output(var) ? m_position_by_output_var[var] : m_structure.gates.size();
+  }
+
+  detail::occurrence_list<ClauseHandle> m_occs;
+  gate_structure<ClauseHandle> m_structure;
+
+  // Inputs of the gates in m_structure, with both polarities added for
+  // gates that are not nested monotonically
+  detail::literal_multiset<lit> m_inputs;
+
+  detail::gate_matcher_state<lit> m_matcher_state;
+
+  // Clauses of gates and root clauses. These are not contained in m_occs.
+  std::unordered_map<ClauseHandle, std::size_t> m_owner_var_by_clause;
+
+  // Unary clauses from which no gates have been found, by literal index.
+  // These are not contained in m_occs.
+  std::vector<std::vector<ClauseHandle>> m_unused_unaries_by_lit;
+
+  // For each gate output variable: the index of its cone in m_cones plus 1.
+  // 0 for variables that are not gate outputs.
+  std::vector<std::size_t> m_cone_by_output_var;
+
+  // For each gate output variable: the index of its gate in m_structure.gates
+  std::vector<std::size_t> m_position_by_output_var;
+
+  // Clauses of dissolved gates and roots restored to m_occs in the current update
+  std::vector<ClauseHandle> m_restored_clauses;
+
+  // Variables whose polarities in m_inputs have changed since the last update
+  // of the nested monotonicity
+  std::vector<std::size_t> m_changed_input_vars;
+
+  std::vector<cone> m_cones;
+  std::vector<std::size_t> m_free_cone_ids;
+  std::vector<std::size_t> m_dirty_cones;
+  std::vector<std::size_t> m_touched_vars;
+  uint64_t m_epoch = 0;
+};
+
+}
@@ -1,19 +1,25 @@
 #pragma once
 
+#include <gatekit/flat_gate_structure.h>
 #include <gatekit/gate.h>
 
 #include <gatekit/detail/bitvector.h>
 #include <gatekit/detail/bitvector_partition.h>
 #include <gatekit/detail/bitvector_prop.h>
 #include <gatekit/detail/bitvector_rand.h>
+#include <gatekit/detail/simulation_refinement.h>
+#include <gatekit/detail/simulation_tape.h>
+#include <gatekit/detail/threads.h>
+#include <gatekit/detail/var_compaction.h>
 
 namespace gatekit {
 
 namespace detail {
-inline void randomize(bitvector_map& assignments,
-                      bitvector_randomizer& randomizer,
-                      std::vector<std::size_t> const& input_var_indices,
-                      uint64_t step)
+template <std::size_t Width>
+void randomize(basic_bitvector_map<Width>& assignments,
+               basic_bitvector_randomizer<Width>& randomizer,
+               std::vector<std::size_t> const& input_var_indices,
+               uint64_t step)
 {
   if (step % 2 == 0) {
     for (std::size_t var : input_var_indices) {
@@ -22,12 +28,14 @@ inline void randomize(bitvector_map& assignments,
   }
   else {
     for (std::size_t var : input_var_indices) {
-      assignments[var] = ~assignments[var];
+      assignments[var].invert();
     }
   }
 }
 
-inline void randomize_all(bitvector_map& assignments, bitvector_randomizer& randomizer)
+template <std::size_t Width>
+void randomize_all(basic_bitvector_map<Width>& assignments,
+                   basic_bitvector_randomizer<Width>& randomizer)
 {
   for (std::size_t idx = 0; idx < assignments.size(); ++idx) {
     randomizer.randomize(assignments[idx], 1);
@@ -35,37 +43,198 @@ inline void randomize_all(bitvector_map& assignments, bitvector_randomizer& rand
 }
 }
 
-template <typename ClauseHandle>
-auto random_simulation(gate_structure<ClauseHandle> const& structure, uint64_t max_num_rounds)
-    -> lit_partitioning<typename clause_funcs<ClauseHandle>::lit>
+namespace detail {
+template <typename Lit, std::size_t Width, typename Structure>
+auto random_simulation_impl(Structure const& structure,
+                            uint64_t max_num_rounds,
+                            std::size_t num_threads,
+                            uint64_t max_num_stable_rounds,
+                            refinement_options<Lit> const* refinement = nullptr)
+    -> lit_partitioning<Lit>
 {
-  using namespace gatekit::detail;
-
-  using lit_t = typename clause_funcs<ClauseHandle>::lit;
+  // Only the variables occurring in the structure are simulated, renumbered
+  // to a dense index range. Instances can have orders of magnitude more
+  // variables than their recovered gate structures.
+  var_compaction const compaction{structure.gates};
+  std::vector<std::size_t> const inputs = compaction.compact(input_var_indices(structure));
 
-  std::size_t const max_var = max_var_index(structure);
-  std::vector<std::size_t> const inputs = input_var_indices(structure);
-
-  bitvector_map assignments{max_var + 1};
-  bitvector_sequence_partition var_partition{max_var + 1};
-  bitvector_randomizer randomizer;
+  basic_bitvector_map<Width> assignments{compaction.size()};
+  basic_bitvector_exact_partition<Width> var_partition{compaction.size()};
+  basic_bitvector_randomizer<Width> randomizer;
 
   // Randomize all variable assignments to eliminate spurious backbone/equivalence
-  // conjectures for variables not occurring in the gate structure. Sorting these
-  // out later would diminish the performance of the bitvector_sequence_partition
-  // update/compression routines.
+  // conjectures for variables that are not assigned by propagation.
   randomize_all(assignments, randomizer);
 
+  // The structure is compiled once and then propagated on the tape in each round
+  simulation_tape const tape{structure, compaction};
+
+  propagation_schedule schedule;
+  std::size_t num_propagation_threads = 1;
+  if (num_threads > 1) {
+    schedule = propagation_schedule{structure};
+    num_propagation_threads = get_num_propagation_threads(schedule, num_threads);
+  }
+
+  // The propagation threads are started once and reused in all rounds
+  worker_pool workers{num_propagation_threads};
+
   uint64_t max_num_bitparallel_rounds =
-      (max_num_rounds % 2048 == 0 ? max_num_rounds / 2048 : (max_num_rounds / 2048 + 1));
+      (max_num_rounds % Width == 0 ? max_num_rounds / Width : (max_num_rounds / Width + 1));
+
+  auto const propagate = [&]() {
+    if (workers.size() > 1) {
+      run_tape(assignments, tape, schedule, workers);
+    }
+    else {
+      run_tape(assignments, tape);
+    }
+  };
 
+  // Singletons are dropped from the partition after each round, since they
+  // would be sorted and compared in all subsequent rounds otherwise. If
+  // max_num_stable_rounds is not 0, the simulation stops early once the
+  // partitioning has not been refined for max_num_stable_rounds rounds.
+  uint64_t num_stable_rounds = 0;
   for (uint64_t idx = 0; idx < max_num_bitparallel_rounds; ++idx) {
     randomize(assignments, randomizer, inputs, idx);
-    propagate_structure(assignments, structure);
+    propagate();
     var_partition.add(assignments);
+
+    num_stable_rounds = var_partition.compress() ? 0 : num_stable_rounds + 1;
+    if (max_num_stable_rounds != 0 && num_stable_rounds == max_num_stable_rounds) {
+      break;
+    }
+  }
+
+  if (refinement != nullptr) {
+    partition_refiner<Lit, Width, decltype(var_partition), decltype(propagate)> refiner{
+        assignments, var_partition, tape, compaction, *refinement, propagate};
+    refiner.run();
   }
 
-  return var_partition.get_current_partitions<lit_t>();
+  return compaction.restore(var_partition.template get_current_partitions<Lit>());
+}
+}
+
+
+/**
+ * \brief Partitions the variables of a gate structure into conjectured
+ *        backbones and equivalence classes by simulating the structure on
+ *        random input assignments
+ *
+ * The simulation is carried out bit-parallel on `Width` input assignments at
+ * once, so `max_num_rounds` is rounded up to a multiple of `Width`. Wider
+ * bitvectors amortize the per-gate overhead better, while narrower ones keep
+ * the assignments of large structures in the CPU caches.
+ *
+ * \tparam Width   The number of assignments simulated in parallel. Must be a
+ *                 positive multiple of 512.
+ *
+ * \param max_num_stable_rounds   If not 0, the simulation stops before
+ *                                `max_num_rounds` assignments have been simulated
+ *                                once the partitioning has not been refined for
+ *                                `max_num_stable_rounds` consecutive bit-parallel
+ *                                rounds. The input biases cycle every 14 rounds,
+ *                                so e.g. 28 covers two cycles. If 0, exactly
+ *                                `max_num_rounds` (rounded up) assignments are
+ *                                simulated.
+ */
+template <std::size_t Width = detail::default_simulation_width, typename ClauseHandle>
+auto random_simulation(gate_structure<ClauseHandle> const& structure,
+                       uint64_t max_num_rounds,
+                       uint64_t max_num_stable_rounds = 0)
+    -> lit_partitioning<typename clause_funcs<ClauseHandle>::lit>
+{
+  using lit_t = typename clause_funcs<ClauseHandle>::lit;
+  return detail::random_simulation_impl<lit_t, Width>(
+      structure, max_num_rounds, 1, max_num_stable_rounds);
+}
+
+template <std::size_t Width = detail::default_simulation_width, typename ClauseHandle>
+auto random_simulation(flat_gate_structure<ClauseHandle> const& structure,
+                       uint64_t max_num_rounds,
+                       uint64_t max_num_stable_rounds = 0)
+    -> lit_partitioning<typename clause_funcs<ClauseHandle>::lit>
+{
+  using lit_t = typename clause_funcs<ClauseHandle>::lit;
+  return detail::random_simulation_impl<lit_t, Width>(
+      structure, max_num_rounds, 1, max_num_stable_rounds);
+}
+
+
+/**
+ * \brief Like random_simulation(), but refining the partitioning with
+ *        targeted input patterns after the random rounds
+ *
+ * Equivalence candidates returned by random simulation usually need to be
+ * checked with a SAT solver, so telling spurious candidates apart by
+ * simulation saves expensive solver calls. See refinement_options for how the
+ * patterns are generated. With a pattern database, the patterns that have
+ * split candidates in previous simulations are replayed first.
+ */
+template <std::size_t Width = detail::default_simulation_width, typename ClauseHandle>
+auto random_simulation(
+    gate_structure<ClauseHandle> const& structure,
+    uint64_t max_num_rounds,
+    refinement_options<typename clause_funcs<ClauseHandle>::lit> const& refinement,
+    uint64_t max_num_stable_rounds = 0)
+    -> lit_partitioning<typename clause_funcs<ClauseHandle>::lit>
+{
+  using lit_t = typename clause_funcs<ClauseHandle>::lit;
+  return detail::random_simulation_impl<lit_t, Width>(
+      structure, max_num_rounds, 1, max_num_stable_rounds, &refinement);
+}
+
+template <std::size_t Width = detail::default_simulation_width, typename ClauseHandle>
+auto random_simulation(
+    flat_gate_structure<ClauseHandle> const& structure,
+    uint64_t max_num_rounds,
+    refinement_options<typename clause_funcs<ClauseHandle>::lit> const& refinement,
+    uint64_t max_num_stable_rounds = 0)
+    -> lit_partitioning<typename clause_funcs<ClauseHandle>::lit>
+{
+  using lit_t = typename clause_funcs<ClauseHandle>::lit;
+  return detail::random_simulation_impl<lit_t, Width>(
+      structure, max_num_rounds, 1, max_num_stable_rounds, &refinement);
+}
+
+/**
+ * \brief Like random_simulation(), but propagating independent gates in
+ *        parallel
+ *
+ * The result is the same as the result of random_simulation(). The threads
+ * are started once per call. Since the threads synchronize after each
+ * topological level of each round, parallel propagation can only pay off for
+ * structures with many gates per level, and only with as many cores as
+ * threads. Fewer threads are used if the largest level has few gates. See the
+ * random_simulation_threads benchmark for measuring the speedup.
+ *
+ * \param num_threads     The maximum number of threads used for propagation. If
+ *                        `num_threads` is 0, the number of hardware threads is used.
+ */
+template <std::size_t Width = detail::default_simulation_width, typename ClauseHandle>
+auto random_simulation_parallel(gate_structure<ClauseHandle> const& structure,
+                                uint64_t max_num_rounds,
+                                std::size_t num_threads = 0,
+                                uint64_t max_num_stable_rounds = 0)
+    -> lit_partitioning<typename clause_funcs<ClauseHandle>::lit>
+{
+  using lit_t = typename clause_funcs<ClauseHandle>::lit;
+  return detail::random_simulation_impl<lit_t, Width>(
+      structure, max_num_rounds, detail::get_num_threads(num_threads), max_num_stable_rounds);
+}
+
+template <std::size_t Width = detail::default_simulation_width, typename ClauseHandle>
+auto random_simulation_parallel(flat_gate_structure<ClauseHandle> const& structure,
+                                uint64_t max_num_rounds,
+                                std::size_t num_threads = 0,
+                                uint64_t max_num_stable_rounds = 0)
+    -> lit_partitioning<typename clause_funcs<ClauseHandle>::lit>
+{
+  using lit_t = typename clause_funcs<ClauseHandle>::lit;
+  return detail::random_simulation_impl<lit_t, Width>(
+      structure, max_num_rounds, detail::get_num_threads(num_threads), max_num_stable_rounds);
 }
 
 }
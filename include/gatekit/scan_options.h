@@ -0,0 +1,191 @@
+/**
+ * \file
+ *
+ * \brief Options, statistics and results for `scan_gates()`
+ */
+
+#pragma once
+
+#include <gatekit/gate.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace gatekit {
+
+/**
+ * Memory layouts of the occurrence lists used by the scanner
+ */
+enum class occurrence_list_layout {
+  /**
+   * One vector of clause handles per literal, with removed clauses being
+   * erased lazily in batches
+   */
+  per_literal,
+
+  /**
+   * Compressed-sparse-row layout: the occurrences of all literals are stored
+   * in a single array. Removed clauses are marked in a per-clause bitmap and
+   * lazily dropped from the occurrences of a literal when these are accessed.
+   * Needs less memory and fewer allocations than `per_literal`.
+   */
+  compressed
+};
+
+
+/**
+ * Kinds of clauses from which the scanner starts searching for gates
+ */
+enum class root_selection {
+  /**
+   * Only unary clauses
+   */
+  unaries,
+
+  /**
+   * Unary clauses first, then non-unary clauses in which each literal could
+   * be a gate output, ordered by the estimated cost of the search. This also
+   * finds the gate structure of instances without unary root constraints, e.g.
+   * when the outputs of a circuit are joined in a single clause. Clauses from
+   * which gates have been found are added to the roots of the gate structure.
+   */
+  unaries_and_clauses
+};
+
+
+/**
+ * \brief Statistics collected by `scan_gates()`
+ *
+ * The scanner adds to the values of this object, so statistics accumulate
+ * when the object is passed to multiple scans.
+ */
+struct scan_stats {
+  /**
+   * The number of gate recognition attempts
+   */
+  uint64_t num_try_get_gate_calls = 0;
+
+  /**
+   * The number of failed gate recognition attempts where the candidate
+   * output did not occur negated in any clause
+   */
+  uint64_t num_failed_empty_fwd = 0;
+
+  /**
+   * The number of failed gate recognition attempts where the candidate
+   * output was not blocked
+   */
+  uint64_t num_failed_blockedness = 0;
+
+  /**
+   * The number of failed gate recognition attempts where the forward and
+   * backward clauses had different variables
+   */
+  uint64_t num_failed_input_mismatch = 0;
+
+  /**
+   * The number of failed gate recognition attempts where the clauses did
+   * not match any gate pattern
+   */
+  uint64_t num_failed_pattern = 0;
+
+  /**
+   * The number of batches of removed clauses erased lazily from the
+   * occurrences of single literals, and their total and maximum size
+   */
+  uint64_t num_erase_batches = 0;
+  uint64_t total_erase_batch_size = 0;
+  uint64_t max_erase_batch_size = 0;
+
+  /**
+   * Time spent erasing batches of removed clauses. Since clauses are erased
+   * when the occurrence lists are accessed, this time is also included in
+   * `blockedness_time` and `matcher_time`.
+   */
+  std::chrono::nanoseconds erase_time{0};
+
+  /**
+   * Time spent checking candidate outputs for blockedness
+   */
+  std::chrono::nanoseconds blockedness_time{0};
+
+  /**
+   * Time spent matching gate patterns, including the computation of inputs
+   */
+  std::chrono::nanoseconds matcher_time{0};
+
+  /**
+   * For each root candidate, the number of rounds of the breadth-first
+   * search for gates started from it
+   */
+  std::vector<std::size_t> num_bfs_rounds_per_root;
+};
+
+
+/**
+ * \brief Options for `scan_gates()`
+ */
+struct scan_options {
+  /**
+   * The memory layout of the occurrence lists. The recognized gates do not
+   * depend on the layout, but their order and the order of their clauses
+   * can differ between layouts.
+   */
+  occurrence_list_layout layout = occurrence_list_layout::per_literal;
+
+  /**
+   * The clauses from which the scanner starts searching for gates
+   */
+  root_selection roots = root_selection::unaries;
+
+  /**
+   * The maximum number of steps performed by the scanner. Each step is an
+   * attempt to recognize a single gate.
+   */
+  uint64_t max_steps = std::numeric_limits<uint64_t>::max();
+
+  /**
+   * The point in time after which the scanner stops.
+   */
+  std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+  /**
+   * If set, the scanner stops when this function returns true. The function
+   * is called periodically from the thread running the scanner.
+   */
+  std::function<bool()> is_cancelled;
+
+  /**
+   * If not null, the scanner collects statistics in this object. Otherwise,
+   * no statistics are collected, and the instrumentation is compiled out.
+   */
+  scan_stats* stats = nullptr;
+};
+
+
+/**
+ * \brief Result of `scan_gates()` with options
+ *
+ * \tparam Structure      The type of the gate structure, `gate_structure<ClauseHandle>`
+ *                        or `flat_gate_structure<ClauseHandle>`
+ */
+template <typename ClauseHandle, typename Structure = gate_structure<ClauseHandle>>
+struct scan_result {
+  /**
+   * The gate structure found by the scanner. If the scanner has been stopped
+   * early, this is a valid (reverse-topologically ordered) part of the gate
+   * structure that would have been found otherwise.
+   */
+  Structure structure;
+
+  /**
+   * `true` iff the scanner has not been stopped early.
+   */
+  bool is_finished = false;
+};
+
+}
@@ -6,8 +6,13 @@
 
 #pragma once
 
+#include <gatekit/detail/scanner_parallel.h>
 #include <gatekit/detail/scanner_structure.h>
+#include <gatekit/flat_gate_structure.h>
 #include <gatekit/gate.h>
+#include <gatekit/scan_options.h>
+
+#include <cstddef>
 
 namespace gatekit {
 
@@ -30,4 +35,123 @@ auto scan_gates(ClauseHandleIter begin, ClauseHandleIter end) -> gate_structure<
   return detail::scan_gates_impl<ClauseHandle, ClauseHandleIter>(begin, end);
 }
 
+
+/**
+ * Scans the given clauses for gate constraints, with limits on the effort
+ * spent by the scanner and optional collection of statistics.
+ *
+ * The deadline and the cancellation callback are only checked every few
+ * steps, so the scanner can take slightly longer than `options.deadline`.
+ *
+ * \tparam ClauseHandle   See `scan_gates(ClauseHandleIter, ClauseHandleIter)`.
+ *
+ * \tparam ClauseHandleIter Iterator over ClauseHandle objects.
+ */
+template <typename ClauseHandle, typename ClauseHandleIter>
+auto scan_gates(ClauseHandleIter begin, ClauseHandleIter end, scan_options const& options)
+    -> scan_result<ClauseHandle>
+{
+  return detail::scan_gates_with_options_impl<ClauseHandle>(begin, end, options);
+}
+
+
+/**
+ * Scans the given clauses for gate constraints, using occurrence lists
+ * with the given memory layout. The recognized gates and roots are the same
+ * for all layouts up to ordering: the layouts can return the occurrences of
+ * a literal in different orders, so the order of the gates in the structure
+ * and the order of the clauses within a gate can differ.
+ */
+template <typename ClauseHandle, typename ClauseHandleIter>
+auto scan_gates(ClauseHandleIter begin, ClauseHandleIter end, occurrence_list_layout layout)
+    -> gate_structure<ClauseHandle>
+{
+  scan_options options;
+  options.layout = layout;
+  return scan_gates<ClauseHandle>(begin, end, options).structure;
+}
+
+
+/**
+ * Like `scan_gates(ClauseHandleIter, ClauseHandleIter)`, but stores the gates
+ * directly in a `flat_gate_list`. This avoids the allocations for the clauses
+ * and inputs of each gate that are required for `flatten(scan_gates(...))`.
+ */
+template <typename ClauseHandle, typename ClauseHandleIter>
+auto scan_gates_flat(ClauseHandleIter begin, ClauseHandleIter end)
+    -> flat_gate_structure<ClauseHandle>
+{
+  detail::unlimited_scan_budget budget;
+  return detail::scan_gates_with_layout_impl<ClauseHandle, flat_gate_structure<ClauseHandle>>(
+      begin, end, scan_options{}, budget, detail::null_stats_recorder{});
+}
+
+
+/**
+ * Like `scan_gates(ClauseHandleIter, ClauseHandleIter, scan_options const&)`, but
+ * stores the gates directly in a `flat_gate_list`.
+ */
+template <typename ClauseHandle, typename ClauseHandleIter>
+auto scan_gates_flat(ClauseHandleIter begin, ClauseHandleIter end, scan_options const& options)
+    -> scan_result<ClauseHandle, flat_gate_structure<ClauseHandle>>
+{
+  return detail::scan_gates_with_options_impl<ClauseHandle, flat_gate_structure<ClauseHandle>>(
+      begin, end, options);
+}
+
+/**
+ * Scans the given clauses for gate constraints, scanning variable-disjoint
+ * parts of the problem instance concurrently.
+ *
+ * The result contains the same gates and roots as the result of `scan_gates()`,
+ * grouped by connected component. Components are ordered by the position of
+ * their first clause in `[begin, end)`, so the result does not depend on
+ * `num_threads`.
+ *
+ * Only distinct connected components of the problem instance are scanned
+ * concurrently, and each component is scanned by a single thread. Instances
+ * consisting of a single large component are therefore scanned sequentially.
+ *
+ * \tparam ClauseHandle   The clause handle type. Clause handles are accessed
+ *                        concurrently via `clause_funcs<ClauseHandle>`, so
+ *                        reading clauses needs to be thread-safe.
+ *
+ * \tparam ClauseHandleIter Iterator over ClauseHandle objects.
+ *
+ * \param num_threads     The maximum number of threads used for scanning. If
+ *                        `num_threads` is 0, the number of hardware threads is used.
+ */
+template <typename ClauseHandle, typename ClauseHandleIter>
+auto scan_gates_parallel(ClauseHandleIter begin, ClauseHandleIter end, std::size_t num_threads = 0)
+    -> gate_structure<ClauseHandle>
+{
+  return detail::scan_gates_parallel_impl<ClauseHandle>(begin, end, scan_options{}, num_threads)
+      .structure;
+}
+
+
+/**
+ * Like `scan_gates_parallel(ClauseHandleIter, ClauseHandleIter, std::size_t)`,
+ * with the options of `scan_gates(ClauseHandleIter, ClauseHandleIter, scan_options const&)`.
+ *
+ * All options are applied to the scan as a whole:
+ *  - `max_steps` limits the total number of steps of all threads. If the scan
+ *    is stopped early, the components contain parts of their gate structure
+ *    depending on the progress of the individual threads, so the result can
+ *    depend on `num_threads` and on timing.
+ *  - `is_cancelled` is called from the scanning threads, but never
+ *    concurrently.
+ *  - The statistics are collected per thread and added to `*options.stats`
+ *    when the scan has finished. Times are summed over all threads, and
+ *    `num_bfs_rounds_per_root` is ordered by thread.
+ */
+template <typename ClauseHandle, typename ClauseHandleIter>
+auto scan_gates_parallel(ClauseHandleIter begin,
+                         ClauseHandleIter end,
+                         scan_options const& options,
+                         std::size_t num_threads = 0) -> scan_result<ClauseHandle>
+{
+  return detail::scan_gates_parallel_impl<ClauseHandle>(begin, end, options, num_threads);
+}
+
 }
@@ -0,0 +1,233 @@
+#include <gatekit/aig.h>
+#include <gatekit/aiger.h>
+
+#include <gatekit/clause_arena.h>
+#include <gatekit/detail/bitvector.h>
+#include <gatekit/detail/bitvector_prop.h>
+#include <gatekit/detail/bitvector_rand.h>
+#include <gatekit/detail/scanner_structure.h>
+#include <gatekit/flat_gate_structure.h>
+#include <gatekit/gate.h>
+#include <gatekit/scanner.h>
+
+#include "helpers/circuit_generator.h"
+#include "helpers/gate_factory.h"
+#include "helpers/gate_utils.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::Ne;
+
+namespace gatekit {
+
+namespace {
+// Evaluates the graph on 64 input assignments at once, returning the value
+// of each node
+auto evaluate(aig const& graph, std::vector<uint64_t> const& input_values)
+    -> std::vector<uint64_t>
+{
+  std::vector<uint64_t> result(graph.num_nodes(), 0);
+  for (std::size_t idx = 0; idx < input_values.size(); ++idx) {
+    result[aig_node_index(graph.get_inputs()[idx])] = input_values[idx];
+  }
+
+  auto const value = [&result](aig_lit lit) -> uint64_t {
+    uint64_t const node_value = result[aig_node_index(lit)];
+    return aig_is_negated(lit) ? ~node_value : node_value;
+  };
+
+  for (std::size_t node = 1; node < graph.num_nodes(); ++node) {
+    if (graph.is_and(node)) {
+      result[node] = value(graph.get_and(node).lhs) & value(graph.get_and(node).rhs);
+    }
+  }
+
+  return result;
+}
+
+auto get_value(std::vector<uint64_t> const& node_values, aig_lit lit) -> uint64_t
+{
+  uint64_t const node_value = node_values[aig_node_index(lit)];
+  return aig_is_negated(lit) ? ~node_value : node_value;
+}
+
+auto majority_gate(int lhs, int mid, int rhs, int output) -> gate<ClauseHandle>
+{
+  gate<ClauseHandle> result;
+  result.output = output;
+
+  ClauseList const clauses = {{-output, lhs, mid},
+                              {-output, lhs, rhs},
+                              {-output, mid, rhs},
+                              {output, -lhs, -mid},
+                              {output, -lhs, -rhs},
+                              {output, -mid, -rhs}};
+  for (Clause const& clause : clauses) {
+    result.clauses.push_back(std::make_shared<Clause>(clause));
+  }
+  result.num_fwd_clauses = 3;
+  result.inputs = detail::get_inputs(result);
+  return result;
+}
+
+// Checks that the AIG computes the same gate output values as propagating
+// the structure
+template <typename ClauseHandle>
+void expect_same_values_as_propagation(gate_structure<ClauseHandle> const& structure)
+{
+  gate_structure_aig const under_test = to_aig(structure);
+
+  std::size_t const num_vars = max_var_index(structure) + 1;
+  detail::bitvector_map assignment{num_vars};
+  detail::bitvector_randomizer randomizer;
+  for (std::size_t var = 0; var < num_vars; ++var) {
+    randomizer.randomize(assignment[var], 1);
+  }
+
+  std::vector<uint64_t> input_values;
+  for (std::size_t var : under_test.input_vars) {
+    input_values.push_back(assignment[var].get_words()[0]);
+  }
+
+  detail::propagate_structure(assignment, structure);
+  std::vector<uint64_t> const node_values = evaluate(under_test.graph, input_values);
+
+  for (auto const& gate : structure.gates) {
+    std::size_t const out_var = detail::to_var_index(gate.output);
+    ASSERT_THAT(under_test.lits_by_var[out_var], Ne(aig_undefined));
+    EXPECT_THAT(get_value(node_values, under_test.lits_by_var[out_var]),
+                Eq(assignment[out_var].get_words()[0]))
+        << "mismatch for var " << out_var;
+  }
+}
+}
+
+
+TEST(aig_tests, and_nodes_are_structurally_hashed)
+{
+  aig under_test;
+  aig_lit const lhs = under_test.add_input();
+  aig_lit const rhs = under_test.add_input();
+
+  aig_lit const conjunction = under_test.add_and(lhs, aig_negate(rhs));
+  EXPECT_THAT(under_test.add_and(aig_negate(rhs), lhs), Eq(conjunction));
+  EXPECT_THAT(under_test.num_ands(), Eq(1));
+
+  EXPECT_THAT(under_test.add_or(lhs, rhs), Ne(conjunction));
+  EXPECT_THAT(under_test.num_ands(), Eq(2));
+  EXPECT_THAT(under_test.num_nodes(), Eq(5));
+}
+
+TEST(aig_tests, trivial_conjunctions_are_simplified)
+{
+  aig under_test;
+  aig_lit const input = under_test.add_input();
+
+  EXPECT_THAT(under_test.add_and(input, input), Eq(input));
+  EXPECT_THAT(under_test.add_and(input, aig_negate(input)), Eq(aig_false));
+  EXPECT_THAT(under_test.add_and(input, aig_true), Eq(input));
+  EXPECT_THAT(under_test.add_and(aig_false, input), Eq(aig_false));
+
+  std::vector<aig_lit> no_operands;
+  EXPECT_THAT(under_test.add_and(no_operands), Eq(aig_true));
+  EXPECT_THAT(under_test.num_ands(), Eq(0));
+}
+
+TEST(aig_tests, duplicate_gates_are_merged)
+{
+  gate_structure<ClauseHandle> const structure =
+      to_structure<ClauseHandle>({or_gate({3, 4}, 1), and_gate({5, 6}, 3), and_gate({6, 5}, 4)},
+                                 {{1}});
+
+  gate_structure_aig const under_test = to_aig(structure);
+
+  EXPECT_THAT(under_test.lits_by_var[2], Eq(under_test.lits_by_var[3]));
+  EXPECT_THAT(under_test.lits_by_var[0], Eq(under_test.lits_by_var[2]));
+  EXPECT_THAT(under_test.graph.num_ands(), Eq(1));
+  EXPECT_THAT(under_test.input_vars, ElementsAre(4, 5));
+  EXPECT_THAT(under_test.graph.get_outputs(), ElementsAre(under_test.lits_by_var[0]));
+}
+
+TEST(aig_tests, gates_have_same_values_as_propagated_gates)
+{
+  expect_same_values_as_propagation(
+      to_structure<ClauseHandle>({and_gate({2, -3, 4}, 1),
+                                  xor_gate(5, -6, 2),
+                                  majority_gate(-7, 8, 9, 3),
+                                  ite_gate(10, -11, 12, 4),
+                                  monotonic(or_gate({-13, 14, 15}, 5)),
+                                  with_flipped_output_sign(and_gate({16, 17}, 6))},
+                                 {{1}}));
+}
+
+TEST(aig_tests, recovered_structure_has_same_values_as_propagated_structure)
+{
+  for (encoding enc : {encoding::full, encoding::opt}) {
+    clause_arena const clauses = multiplier_miter(6, enc).clauses;
+    expect_same_values_as_propagation(scan_gates<arena_clause>(clauses.begin(), clauses.end()));
+  }
+}
+
+TEST(aig_tests, flat_structure_yields_same_aig)
+{
+  clause_arena const clauses = multiplier_miter(4, encoding::full).clauses;
+  gate_structure<arena_clause> const structure =
+      scan_gates<arena_clause>(clauses.begin(), clauses.end());
+
+  gate_structure_aig const expected = to_aig(structure);
+  gate_structure_aig const result = to_aig(flatten(structure));
+
+  EXPECT_THAT(result.lits_by_var, Eq(expected.lits_by_var));
+  EXPECT_THAT(result.graph.num_ands(), Eq(expected.graph.num_ands()));
+}
+
+
+TEST(aiger_tests, and_gate_is_written_in_binary_format)
+{
+  aig graph;
+  aig_lit const lhs = graph.add_input();
+  aig_lit const rhs = graph.add_input();
+  graph.add_output(aig_negate(graph.add_and(lhs, aig_negate(rhs))));
+
+  std::ostringstream output;
+  write_aiger(output, graph);
+
+  // lhs 6 = 2 * 3, rhs0 5, rhs1 2: deltas 1 and 3
+  EXPECT_THAT(output.str(), Eq(std::string{"aig 3 2 0 1 1\n7\n\x01\x03", 18}));
+}
+
+TEST(aiger_tests, inputs_added_after_and_nodes_are_renumbered)
+{
+  aig graph;
+  aig_lit const first = graph.add_input();
+  aig_lit const second = graph.add_input();
+  aig_lit const conjunction = graph.add_and(first, second);
+  aig_lit const third = graph.add_input();
+  graph.add_output(graph.add_and(conjunction, third));
+
+  std::ostringstream output;
+  write_aiger(output, graph);
+
+  // AIGER variables: inputs 1, 2, 3, ANDs 4 = 1 & 2 and 5 = 4 & 3
+  EXPECT_THAT(output.str(), Eq(std::string{"aig 5 3 0 1 2\n10\n\x04\x02\x02\x02", 21}));
+}
+
+TEST(aiger_tests, large_deltas_are_written_in_several_bytes)
+{
+  std::ostringstream output;
+  detail::write_aiger_delta(output, 0x80);
+  detail::write_aiger_delta(output, 0x3fff);
+  detail::write_aiger_delta(output, 0x4000);
+
+  EXPECT_THAT(output.str(), Eq(std::string{"\x80\x01\xff\x7f\x80\x80\x01", 7}));
+}
+
+}
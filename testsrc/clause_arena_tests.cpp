@@ -0,0 +1,79 @@
+#include <gatekit/clause_arena.h>
+
+#include <gatekit/scanner.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::IsEmpty;
+
+namespace gatekit {
+
+namespace {
+auto to_vectors(clause_arena const& arena) -> std::vector<std::vector<int>>
+{
+  std::vector<std::vector<int>> result;
+  for (arena_clause clause : arena) {
+    result.emplace_back(clause.begin(), clause.end());
+  }
+  return result;
+}
+}
+
+TEST(clause_arena_tests, empty_after_construction)
+{
+  clause_arena under_test;
+
+  EXPECT_TRUE(under_test.empty());
+  EXPECT_THAT(under_test.size(), Eq(0));
+  EXPECT_THAT(under_test.get_num_vars(), Eq(0));
+  EXPECT_THAT(to_vectors(under_test), IsEmpty());
+}
+
+TEST(clause_arena_tests, contains_added_clauses_in_order)
+{
+  clause_arena under_test;
+  under_test.add_clause({1, -2, 3});
+  under_test.add_clause({});
+  under_test.add_clause({-7});
+
+  EXPECT_THAT(under_test.size(), Eq(3));
+  EXPECT_THAT(under_test.get_num_vars(), Eq(7));
+  EXPECT_THAT(to_vectors(under_test),
+              ElementsAre(std::vector<int>{1, -2, 3}, std::vector<int>{}, std::vector<int>{-7}));
+}
+
+TEST(clause_arena_tests, clause_funcs_access_arena_clauses)
+{
+  clause_arena under_test;
+  under_test.add_clause({4, -5});
+
+  arena_clause const clause = *under_test.begin();
+
+  EXPECT_THAT(detail::get_size(clause), Eq(2));
+  EXPECT_THAT(detail::get_lit(clause, 0), Eq(4));
+  EXPECT_THAT(detail::get_lit(clause, 1), Eq(-5));
+  EXPECT_THAT(under_test.get_handles(), ElementsAre(clause));
+}
+
+TEST(clause_arena_tests, gates_can_be_scanned_directly_from_arena)
+{
+  clause_arena under_test;
+  under_test.add_clause({-1, 2});
+  under_test.add_clause({-1, 3});
+  under_test.add_clause({1, -2, -3});
+  under_test.add_clause({1});
+
+  gate_structure<arena_clause> const result =
+      scan_gates<arena_clause>(under_test.begin(), under_test.end());
+
+  ASSERT_THAT(result.gates.size(), Eq(1));
+  EXPECT_THAT(result.gates[0].output, Eq(1));
+  EXPECT_THAT(result.gates[0].clauses.size(), Eq(3));
+  EXPECT_THAT(result.roots, ElementsAre(std::vector<int>{1}));
+}
+}
@@ -0,0 +1,171 @@
+#include <gatekit/detail/bitvector_kernels.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace gatekit {
+namespace detail {
+
+namespace {
+using words = std::array<uint64_t, 32>;
+
+auto random_words(std::mt19937_64& rng) -> words
+{
+  words result;
+  for (uint64_t& word : result) {
+    word = rng();
+  }
+  return result;
+}
+}
+
+
+class bitvector_kernels_tests : public ::testing::TestWithParam<simd_isa> {
+protected:
+  void SetUp() override
+  {
+    if (!is_supported(GetParam())) {
+      GTEST_SKIP() << "instruction set not supported by this CPU";
+    }
+  }
+
+  bitvector_kernels const reference = get_bitvector_kernels<32>(simd_isa::portable);
+  std::mt19937_64 rng{1};
+};
+
+TEST_P(bitvector_kernels_tests, kernels_have_requested_isa)
+{
+  EXPECT_THAT(get_bitvector_kernels<32>(GetParam()).isa, ::testing::Eq(GetParam()));
+}
+
+TEST_P(bitvector_kernels_tests, bitwise_operators_match_portable_kernels)
+{
+  bitvector_kernels const under_test = get_bitvector_kernels<32>(GetParam());
+
+  using binary_kernel = void (*)(uint64_t*, uint64_t const*);
+  std::vector<std::pair<binary_kernel, binary_kernel>> const kernel_pairs = {
+      {under_test.and_assign, reference.and_assign},
+      {under_test.or_assign, reference.or_assign},
+      {under_test.xor_assign, reference.xor_assign}};
+
+  for (auto const& kernels : kernel_pairs) {
+    words const lhs = random_words(rng);
+    words const rhs = random_words(rng);
+
+    words result = lhs;
+    words expected = lhs;
+    kernels.first(result.data(), rhs.data());
+    kernels.second(expected.data(), rhs.data());
+    EXPECT_THAT(result, ::testing::Eq(expected));
+  }
+
+  words inverted = random_words(rng);
+  words inverted_expected = inverted;
+  under_test.invert(inverted.data());
+  reference.invert(inverted_expected.data());
+  EXPECT_THAT(inverted, ::testing::Eq(inverted_expected));
+}
+
+TEST_P(bitvector_kernels_tests, clause_kernels_match_portable_kernels)
+{
+  bitvector_kernels const under_test = get_bitvector_kernels<32>(GetParam());
+
+  for (std::size_t num_operands = 0; num_operands < 6; ++num_operands) {
+    std::vector<words> operand_words;
+    std::vector<bitvector_operand> operands;
+    for (std::size_t idx = 0; idx < num_operands; ++idx) {
+      operand_words.push_back(random_words(rng));
+    }
+    for (std::size_t idx = 0; idx < num_operands; ++idx) {
+      bitvector_operand operand;
+      operand.words = operand_words[idx].data();
+      operand.flip = (idx % 2 == 0) ? 0 : ~uint64_t{0};
+      operands.push_back(operand);
+    }
+
+    words const start = random_words(rng);
+
+    words and_result = start;
+    words and_expected = start;
+    under_test.and_clause(and_result.data(), operands.data(), num_operands);
+    reference.and_clause(and_expected.data(), operands.data(), num_operands);
+    EXPECT_THAT(and_result, ::testing::Eq(and_expected));
+
+    words or_result = start;
+    words or_expected = start;
+    under_test.or_operands(or_result.data(), operands.data(), num_operands);
+    reference.or_operands(or_expected.data(), operands.data(), num_operands);
+    EXPECT_THAT(or_result, ::testing::Eq(or_expected));
+  }
+}
+
+TEST_P(bitvector_kernels_tests, random_kernels_match_portable_kernels)
+{
+  bitvector_kernels const under_test = get_bitvector_kernels<32>(GetParam());
+
+  words const start = random_words(rng);
+  uint64_t const additional = rng();
+
+  words randomized = start;
+  words randomized_expected = start;
+  under_test.randomize(randomized.data(), additional);
+  reference.randomize(randomized_expected.data(), additional);
+  EXPECT_THAT(randomized, ::testing::Eq(randomized_expected));
+
+  words thickened = start;
+  words thickened_expected = start;
+  under_test.thicken(thickened.data(), additional);
+  reference.thicken(thickened_expected.data(), additional);
+  EXPECT_THAT(thickened, ::testing::Eq(thickened_expected));
+}
+
+TEST_P(bitvector_kernels_tests, hash_kernel_matches_portable_kernel)
+{
+  bitvector_kernels const under_test = get_bitvector_kernels<32>(GetParam());
+
+  words const input = random_words(rng);
+  uint64_t const state = rng();
+
+  EXPECT_THAT(under_test.hash(state, input.data(), 0),
+              ::testing::Eq(reference.hash(state, input.data(), 0)));
+  EXPECT_THAT(under_test.hash(state, input.data(), ~uint64_t{0}),
+              ::testing::Eq(reference.hash(state, input.data(), ~uint64_t{0})));
+}
+
+INSTANTIATE_TEST_SUITE_P(bitvector_kernels_tests,
+                         bitvector_kernels_tests,
+                         ::testing::Values(simd_isa::portable,
+                                           simd_isa::sse2,
+                                           simd_isa::avx2,
+                                           simd_isa::avx512));
+
+
+TEST(bitvector_kernels_dispatch_tests, best_isa_is_supported)
+{
+  EXPECT_TRUE(is_supported(get_best_simd_isa()));
+  EXPECT_THAT(get_bitvector_kernels<32>().isa, ::testing::Eq(get_best_simd_isa()));
+}
+
+TEST(bitvector_kernels_dispatch_tests, negated_hash_equals_hash_of_negated_words)
+{
+  bitvector_kernels const& under_test = get_bitvector_kernels<32>();
+
+  std::mt19937_64 rng{2};
+  words const input = random_words(rng);
+  words negated;
+  for (std::size_t idx = 0; idx < negated.size(); ++idx) {
+    negated[idx] = ~input[idx];
+  }
+
+  EXPECT_THAT(under_test.hash(5, input.data(), ~uint64_t{0}),
+              ::testing::Eq(under_test.hash(5, negated.data(), 0)));
+  EXPECT_THAT(under_test.hash(5, input.data(), 0),
+              ::testing::Ne(under_test.hash(5, negated.data(), 0)));
+}
+}
+}
@@ -82,10 +82,18 @@ auto create_bitvector_map_with_distinct_signatures() -> bitvector_map
 }
 }
 
-TEST(bitvector_partition_tests, initially_all_positive_backbones)
+template <typename Partition>
+class bitvector_partition_tests : public ::testing::Test {
+};
+
+using partition_types =
+    ::testing::Types<bitvector_sequence_partition, bitvector_exact_partition>;
+TYPED_TEST_SUITE(bitvector_partition_tests, partition_types);
+
+TYPED_TEST(bitvector_partition_tests, initially_all_positive_backbones)
 {
-  bitvector_sequence_partition under_test{8};
-  lit_partitioning<int> result = under_test.get_current_partitions<int>();
+  TypeParam under_test{8};
+  lit_partitioning<int> result = under_test.template get_current_partitions<int>();
 
   std::vector<int> expected_backbones(8);
   std::iota(expected_backbones.begin(), expected_backbones.end(), 1);
@@ -94,20 +102,20 @@ TEST(bitvector_partition_tests, initially_all_positive_backbones)
   EXPECT_THAT(result.equivalences, IsEmpty());
 }
 
-TEST(bitvector_partition_tests, when_all_signatures_are_different_then_partitions_are_empty)
+TYPED_TEST(bitvector_partition_tests, when_all_signatures_are_different_then_partitions_are_empty)
 {
-  bitvector_sequence_partition under_test{8};
+  TypeParam under_test{8};
 
   under_test.add(create_bitvector_map_with_distinct_signatures());
 
-  lit_partitioning<int> result = under_test.get_current_partitions<int>();
+  lit_partitioning<int> result = under_test.template get_current_partitions<int>();
   EXPECT_THAT(result.backbones, IsEmpty());
   EXPECT_THAT(result.equivalences, IsEmpty());
 }
 
-TEST(bitvector_partition_tests, when_signatures_are_equivalent_partitions_are_created)
+TYPED_TEST(bitvector_partition_tests, when_signatures_are_equivalent_partitions_are_created)
 {
-  bitvector_sequence_partition under_test{8};
+  TypeParam under_test{8};
 
   bitvector_map input = create_bitvector_map_with_distinct_signatures();
   input[0].fill(123ull);
@@ -130,11 +138,106 @@ TEST(bitvector_partition_tests, when_signatures_are_equivalent_partitions_are_cr
 
   under_test.add(input);
 
-  lit_partitioning<int> result = under_test.get_current_partitions<int>();
+  lit_partitioning<int> result = under_test.template get_current_partitions<int>();
 
   EXPECT_THAT(result.backbones, IsEmpty());
   EXPECT_THAT(result, HasEquivalencies(std::vector<std::vector<int>>{{2, -5, 7}, {4, 8}}));
 }
 
+TYPED_TEST(bitvector_partition_tests, compress_drops_singletons_and_reports_refinement)
+{
+  TypeParam under_test{4};
+  EXPECT_TRUE(under_test.compress());
+  EXPECT_FALSE(under_test.compress());
+
+  bitvector_map input{4};
+  input[0].fill(1ull);
+  input[1].fill(1ull);
+  input[2].fill(~1ull);
+  input[3].fill(2ull);
+
+  under_test.add(input);
+  EXPECT_TRUE(under_test.compress());
+  EXPECT_THAT(under_test.num_candidates(), Eq(3));
+
+  under_test.add(input);
+  EXPECT_FALSE(under_test.compress());
+  EXPECT_THAT(under_test.num_candidates(), Eq(3));
+
+  // Splitting {1, 2, -3} into {1, -3} and {2}
+  input[1].fill(4ull);
+  under_test.add(input);
+  EXPECT_TRUE(under_test.compress());
+  EXPECT_THAT(under_test.num_candidates(), Eq(2));
+
+  lit_partitioning<int> const result = under_test.template get_current_partitions<int>();
+  EXPECT_THAT(result.backbones, IsEmpty());
+  EXPECT_THAT(result, HasEquivalencies(std::vector<std::vector<int>>{{1, -3}}));
+}
+
+TYPED_TEST(bitvector_partition_tests, compress_reports_backbones_becoming_equivalences)
+{
+  TypeParam under_test{2};
+
+  bitvector_map input{2};
+  input[0].fill(~0ull);
+  input[1].fill(~0ull);
+  under_test.add(input);
+  EXPECT_TRUE(under_test.compress());
+
+  input[0].fill(1ull);
+  input[1].fill(1ull);
+  under_test.add(input);
+  EXPECT_TRUE(under_test.compress());
+  EXPECT_FALSE(under_test.compress());
+}
+
+TEST(bitvector_exact_partition_tests, bitvectors_differing_only_in_later_words_are_split)
+{
+  bitvector_exact_partition under_test{6};
+
+  bitvector_map input{6};
+  for (std::size_t idx = 0; idx < input.size(); ++idx) {
+    input[idx].fill(0x10ull);
+  }
+  input[1].get_words()[5] = 0x11ull;
+  input[2].get_words()[5] = 0x11ull;
+  input[3].get_words()[bitvector::num_words - 1] = 0x12ull;
+  input[4] = ~input[0];
+  input[5] = ~input[1];
+
+  under_test.add(input);
+
+  lit_partitioning<int> const result = under_test.get_current_partitions<int>();
+  EXPECT_THAT(result.backbones, IsEmpty());
+  EXPECT_THAT(result.equivalences,
+              ::testing::UnorderedElementsAre(::testing::ElementsAre(1, -5),
+                                              ::testing::ElementsAre(2, 3, -6)));
+}
+
+TEST(bitvector_exact_partition_tests, classes_are_refined_across_rounds)
+{
+  bitvector_exact_partition under_test{4};
+
+  bitvector_map input{4};
+  input[0].fill(0x20ull);
+  input[1].fill(0x20ull);
+  input[2].fill(~0x20ull);
+  input[3].fill(0x20ull);
+  under_test.add(input);
+
+  input[3].fill(0x21ull);
+  under_test.add(input);
+  EXPECT_TRUE(under_test.compress());
+  EXPECT_THAT(under_test.num_candidates(), Eq(3));
+
+  // Values having been equal in an earlier round don't merge the classes again
+  input[3].fill(0x20ull);
+  under_test.add(input);
+  EXPECT_FALSE(under_test.compress());
+
+  lit_partitioning<int> const result = under_test.get_current_partitions<int>();
+  EXPECT_THAT(result.equivalences, ::testing::ElementsAre(::testing::ElementsAre(1, 2, -3)));
+}
 }
 }
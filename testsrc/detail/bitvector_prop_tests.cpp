@@ -1,22 +1,31 @@
 #include <gatekit/detail/bitvector_prop.h>
 
+#include <gatekit/clause_arena.h>
 #include <gatekit/detail/bitvector.h>
+#include <gatekit/detail/bitvector_rand.h>
 #include <gatekit/detail/clause_utils.h>
 #include <gatekit/gate.h>
+#include <gatekit/scanner.h>
 
+#include "../helpers/circuit_generator.h"
 #include "../helpers/gate_factory.h"
 #include "../helpers/gate_utils.h"
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <bitset>
 #include <cstdint>
 #include <limits>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <utility>
 
+using ::testing::ElementsAre;
+using ::testing::Eq;
+
 namespace gatekit {
 namespace detail {
 
@@ -87,6 +96,112 @@ TEST_P(propagate_structure_tests, suite)
   bitvector_map assignment = get_start_assignment_as_bvmap();
   propagate_structure(assignment, structure);
   EXPECT_THAT(assignment, bitvector_map_matches(get_expected_assignment()));
+
+  bitvector_map scheduled_assignment = get_start_assignment_as_bvmap();
+  propagate_structure(scheduled_assignment, structure, propagation_schedule{structure}, 1);
+  EXPECT_THAT(scheduled_assignment, bitvector_map_matches(get_expected_assignment()));
+}
+
+
+TEST(propagation_schedule_tests, gates_are_sorted_by_level)
+{
+  gate_structure<ClauseHandle> const structure =
+      to_structure<ClauseHandle>({monotonic(xor_gate(10, 103, 1)),
+                                  monotonic(or_gate({11, 12}, 2)),
+                                  monotonic(and_gate({10, 103}, 11)),
+                                  monotonic(and_gate({101, 102}, 12)),
+                                  xor_gate(101, 102, 10)},
+                                 {{1}, {2}});
+
+  propagation_schedule const under_test{structure};
+
+  ASSERT_THAT(under_test.num_levels(), Eq(3));
+  EXPECT_THAT(under_test.get_level(0), ElementsAre(4, 3));
+  EXPECT_THAT(under_test.get_level(1), ElementsAre(2, 0));
+  EXPECT_THAT(under_test.get_level(2), ElementsAre(1));
+  EXPECT_THAT(under_test.get_max_level_size(), Eq(2));
+}
+
+TEST(propagation_schedule_tests, empty_structure_has_no_levels)
+{
+  propagation_schedule const under_test{to_structure<ClauseHandle>({}, {})};
+  EXPECT_THAT(under_test.num_levels(), Eq(0));
+}
+
+TEST(propagate_structure_parallel_tests, result_is_same_as_for_sequential_propagation)
+{
+  clause_arena const clauses = multiplier_miter(16, encoding::full).clauses;
+  gate_structure<arena_clause> const structure =
+      scan_gates<arena_clause>(clauses.begin(), clauses.end());
+
+  std::size_t const num_vars = max_var_index(structure) + 1;
+  propagation_schedule const schedule{structure};
+
+  // Otherwise, propagate_structure() would fall back to propagating on a single thread
+  ASSERT_THAT(schedule.get_max_level_size(), ::testing::Ge(4 * 64));
+
+  bitvector_map start_assignment{num_vars};
+  bitvector_randomizer randomizer;
+  for (std::size_t var = 0; var < num_vars; ++var) {
+    randomizer.randomize(start_assignment[var], 1);
+  }
+
+  bitvector_map expected{num_vars};
+  for (std::size_t var = 0; var < num_vars; ++var) {
+    expected[var] = start_assignment[var];
+  }
+  propagate_structure(expected, structure);
+
+  for (std::size_t num_threads : {1, 2, 3, 4}) {
+    bitvector_map result{num_vars};
+    for (std::size_t var = 0; var < num_vars; ++var) {
+      result[var] = start_assignment[var];
+    }
+
+    propagate_structure(result, structure, schedule, num_threads);
+
+    for (std::size_t var = 0; var < num_vars; ++var) {
+      ASSERT_TRUE(result[var] == expected[var]) << "mismatch for var " << var
+                                                << " with " << num_threads << " threads";
+    }
+  }
+}
+
+TEST(propagate_structure_parallel_tests, exceptions_from_propagation_are_rethrown)
+{
+  clause_arena const clauses = multiplier_miter(16, encoding::full).clauses;
+  gate_structure<arena_clause> const structure =
+      scan_gates<arena_clause>(clauses.begin(), clauses.end());
+  propagation_schedule const schedule{structure};
+
+  std::size_t largest_level = 0;
+  for (std::size_t level = 0; level < schedule.num_levels(); ++level) {
+    if (schedule.get_level(level).size() == schedule.get_max_level_size()) {
+      largest_level = level;
+    }
+  }
+
+  std::size_t const num_threads = 3;
+  worker_pool workers{num_threads};
+  span<std::size_t> const level_gates = schedule.get_level(largest_level);
+
+  // Each thread throws in turn, while the other threads wait for it at the
+  // barrier of the level
+  for (std::size_t thread_index = 0; thread_index < num_threads; ++thread_index) {
+    std::size_t const throwing_gate = level_gates[level_gates.size() * thread_index / num_threads];
+    auto const propagate = [throwing_gate](std::size_t gate_index) {
+      if (gate_index == throwing_gate) {
+        throw std::runtime_error{"propagation failed"};
+      }
+    };
+
+    EXPECT_THROW(run_schedule(schedule, workers, propagate), std::runtime_error)
+        << "thread " << thread_index;
+  }
+
+  std::atomic<std::size_t> num_propagated{0};
+  run_schedule(schedule, workers, [&num_propagated](std::size_t) { ++num_propagated; });
+  EXPECT_THAT(num_propagated.load(), Eq(structure.gates.size()));
 }
 
 
@@ -18,5 +18,30 @@ TEST(bitvector_tests, bitvector_map_alignment)
   ASSERT_THAT(reinterpret_cast<uintptr_t>(&under_test[0]) % 32, ::testing::Eq(0));
 }
 
+TEST(bitvector_tests, operators_on_narrow_bitvector)
+{
+  using narrow_bitvector = basic_bitvector<512>;
+  ASSERT_THAT(narrow_bitvector::num_words, ::testing::Eq(8));
+
+  narrow_bitvector lhs = narrow_bitvector::zeros();
+  narrow_bitvector rhs = narrow_bitvector::ones();
+  lhs.get_words()[7] = 0xf0;
+
+  EXPECT_THAT(lhs & rhs, ::testing::Eq(lhs));
+  EXPECT_THAT(lhs | rhs, ::testing::Eq(rhs));
+  EXPECT_THAT((lhs ^ rhs).get_words()[7], ::testing::Eq(~uint64_t{0xf0}));
+  EXPECT_THAT(~rhs, ::testing::Eq(narrow_bitvector::zeros()));
+
+  lhs.invert();
+  EXPECT_THAT(lhs.get_words()[7], ::testing::Eq(~uint64_t{0xf0}));
+  EXPECT_THAT(lhs.get_words()[0], ::testing::Eq(~uint64_t{0}));
+}
+
+TEST(bitvector_tests, narrow_bitvector_map_alignment)
+{
+  basic_bitvector_map<512> under_test{2};
+  ASSERT_THAT(reinterpret_cast<uintptr_t>(&under_test[1]) % 32, ::testing::Eq(0));
+}
+
 }
 }
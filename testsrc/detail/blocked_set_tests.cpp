@@ -7,6 +7,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <random>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -42,6 +43,74 @@ TEST_P(blocked_set_tests, test_for_blockedness)
               ::testing::Eq(std::get<3>(test_param)));
 }
 
+TEST_P(blocked_set_tests, test_for_blockedness_with_checker)
+{
+  blocked_set_test_param const& test_param = GetParam();
+
+  std::vector<ClauseHandle> clauses;
+  for (auto const& clause : std::get<1>(test_param)) {
+    clauses.push_back(&clause);
+  }
+
+  occurrence_list<ClauseHandle> occurrences{clauses.begin(), clauses.end()};
+  blocked_set_checker<int> under_test;
+
+  EXPECT_THAT(under_test.is_blocked(std::get<2>(test_param), occurrences),
+              ::testing::Eq(std::get<3>(test_param)));
+
+  // Checking again with the same checker, since stamps must not leak between checks
+  EXPECT_THAT(under_test.is_blocked(std::get<2>(test_param), occurrences),
+              ::testing::Eq(std::get<3>(test_param)));
+}
+
+TEST(blocked_set_checker_tests, checker_agrees_with_is_blocked_on_random_clauses)
+{
+  std::mt19937 rng{1};
+  std::uniform_int_distribution<int> var_dist{1, 6};
+  std::uniform_int_distribution<std::size_t> size_dist{1, 4};
+  std::uniform_int_distribution<std::size_t> num_clauses_dist{0, 8};
+
+  blocked_set_checker<int> under_test;
+
+  for (int round = 0; round < 500; ++round) {
+    ClauseVec clauses(num_clauses_dist(rng));
+    for (Clause& clause : clauses) {
+      std::size_t const size = size_dist(rng);
+      for (std::size_t idx = 0; idx < size; ++idx) {
+        int const var = var_dist(rng);
+        clause.push_back(rng() % 2 == 0 ? var : -var);
+      }
+    }
+
+    std::vector<ClauseHandle> handles;
+    for (Clause const& clause : clauses) {
+      handles.push_back(&clause);
+    }
+
+    occurrence_list<ClauseHandle> occurrences{handles.begin(), handles.end()};
+
+    for (int lit = -6; lit <= 6; ++lit) {
+      if (lit != 0) {
+        EXPECT_THAT(under_test.is_blocked(lit, occurrences),
+                    ::testing::Eq(is_blocked(lit, occurrences)));
+
+        for (ClauseHandle const& excluded : occurrences[lit]) {
+          std::vector<ClauseHandle> remaining;
+          for (ClauseHandle const& clause : occurrences[lit]) {
+            if (clause != excluded) {
+              remaining.push_back(clause);
+            }
+          }
+
+          EXPECT_THAT(
+              under_test.is_blocked_without(lit, occurrences[-lit], occurrences[lit], excluded),
+              ::testing::Eq(under_test.is_blocked(lit, occurrences[-lit], remaining)));
+        }
+      }
+    }
+  }
+}
+
 // clang-format off
 INSTANTIATE_TEST_SUITE_P(blocked_set_tests, blocked_set_tests,
   ::testing::Values(
@@ -50,7 +119,12 @@ INSTANTIATE_TEST_SUITE_P(blocked_set_tests, blocked_set_tests,
     std::make_tuple("pure literal in lone binary clause is blocked", ClauseVec{{2, -3}}, 2, true),
     std::make_tuple("pure literal in multiple clauses is blocked", ClauseVec{{2, -3}, {2, 5, 6, -3}}, 2, true),
     std::make_tuple("non-pure literal in non-blocked set is not blocked", ClauseVec{{2, -3}, {-2, 4}}, 2, false),
-    std::make_tuple("non-pure literal in blocked set is blocked", ClauseVec{{2, -3}, {-2, 3}}, 2, true)
+    std::make_tuple("non-pure literal in blocked set is blocked", ClauseVec{{2, -3}, {-2, 3}}, 2, true),
+    std::make_tuple("non-pure literal with unary is not blocked", ClauseVec{{2}, {-2, 3}}, 2, false),
+    std::make_tuple("AND gate output is blocked", ClauseVec{{-1, 2}, {-1, 3}, {1, -2, -3}}, 1, true),
+    std::make_tuple("AND gate with extra clause is not blocked", ClauseVec{{-1, 2}, {-1, 3}, {1, -2, -3}, {1, 2}}, 1, false),
+    std::make_tuple("XOR gate output is blocked", ClauseVec{{-1, 2, 3}, {-1, -2, -3}, {1, -2, 3}, {1, 2, -3}}, 1, true),
+    std::make_tuple("tautologic clause is handled", ClauseVec{{-1, 2, -2}, {1, 2}}, 1, true)
 ));
 // clang-format on
 }
@@ -0,0 +1,49 @@
+#include <gatekit/detail/clause_utils.h>
+
+#include "../helpers/unsigned_lits.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+using ::testing::Eq;
+
+namespace gatekit {
+namespace detail {
+
+TEST(clause_utils_tests, dimacs_literals_are_mapped_to_indices)
+{
+  EXPECT_THAT(to_index(1), Eq(0));
+  EXPECT_THAT(to_index(-1), Eq(1));
+  EXPECT_THAT(to_index(5), Eq(8));
+  EXPECT_THAT(to_index(-5), Eq(9));
+
+  EXPECT_THAT(to_var_index(-5), Eq(4));
+  EXPECT_THAT(max_index(5), Eq(9));
+  EXPECT_THAT(max_index(-5), Eq(9));
+
+  EXPECT_TRUE(is_positive(5));
+  EXPECT_FALSE(is_positive(-5));
+  EXPECT_THAT(negate(5), Eq(-5));
+  EXPECT_THAT(to_lit<int>(4, false), Eq(-5));
+}
+
+TEST(clause_utils_tests, unsigned_literals_are_their_own_indices)
+{
+  uint32_t const pos_lit = 8;
+  uint32_t const neg_lit = 9;
+
+  EXPECT_THAT(to_index(pos_lit), Eq(8));
+  EXPECT_THAT(to_index(neg_lit), Eq(9));
+  EXPECT_THAT(to_var_index(neg_lit), Eq(4));
+  EXPECT_THAT(max_index(pos_lit), Eq(9));
+
+  EXPECT_TRUE(is_positive(pos_lit));
+  EXPECT_FALSE(is_positive(neg_lit));
+  EXPECT_THAT(negate(pos_lit), Eq(neg_lit));
+  EXPECT_THAT(negate(neg_lit), Eq(pos_lit));
+  EXPECT_THAT(to_lit<uint32_t>(4, false), Eq(neg_lit));
+}
+}
+}
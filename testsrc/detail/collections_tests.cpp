@@ -52,5 +52,44 @@ TEST(literal_set_tests, literals_beyond_max_index_are_not_contained)
   literal_set<int> under_test{100};
   EXPECT_FALSE(under_test.contains(-10000));
 }
+
+TEST(literal_set_tests, grown_set_keeps_elements)
+{
+  literal_set<int> under_test;
+  under_test.grow(gatekit::detail::to_index(3));
+  under_test.add(3);
+  under_test.grow(gatekit::detail::to_index(-40));
+  under_test.add(-40);
+
+  EXPECT_THAT(under_test.literals(), UnorderedElementsAre(3, -40));
+  EXPECT_TRUE(under_test.contains(3));
+  EXPECT_TRUE(under_test.contains(-40));
+}
+
+TEST(index_marks_tests, indices_are_marked_once)
+{
+  index_marks under_test;
+  EXPECT_FALSE(under_test.is_marked(3));
+
+  EXPECT_TRUE(under_test.mark(3));
+  EXPECT_FALSE(under_test.mark(3));
+  EXPECT_TRUE(under_test.mark(1000));
+
+  EXPECT_TRUE(under_test.is_marked(3));
+  EXPECT_TRUE(under_test.is_marked(1000));
+  EXPECT_FALSE(under_test.is_marked(4));
+}
+
+TEST(index_marks_tests, indices_are_unmarked_after_clear)
+{
+  index_marks under_test;
+  under_test.mark(3);
+  under_test.mark(7);
+  under_test.clear();
+
+  EXPECT_FALSE(under_test.is_marked(3));
+  EXPECT_FALSE(under_test.is_marked(7));
+  EXPECT_TRUE(under_test.mark(7));
+}
 }
 }
@@ -0,0 +1,149 @@
+#include <gatekit/detail/csr_occurrence_list.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using ::testing::Eq;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+namespace gatekit {
+namespace detail {
+
+using Clause = std::vector<int>;
+using ClauseHandle = Clause const*;
+
+auto create_csr_occurrence_list(std::vector<ClauseHandle> clauses)
+    -> csr_occurrence_list<ClauseHandle>
+{
+  return csr_occurrence_list<ClauseHandle>{clauses.begin(), clauses.end()};
+}
+
+TEST(csr_occurrence_list_tests, empty)
+{
+  auto under_test = create_csr_occurrence_list({});
+
+  EXPECT_THAT(under_test.get_unaries(), IsEmpty());
+  EXPECT_THAT(under_test.get_max_lit_index(), Eq(0));
+  EXPECT_TRUE(under_test.empty());
+}
+
+TEST(csr_occurrence_list_tests, three_clauses)
+{
+  Clause const input1 = {1, -2, 3};
+  Clause const input2 = {2, -1, 5, -10};
+  Clause const input3 = {-2, -1, 5};
+
+  auto under_test = create_csr_occurrence_list({&input1, &input2, &input3});
+
+  EXPECT_THAT(under_test.get_unaries(), IsEmpty());
+
+  EXPECT_THAT(under_test[1], UnorderedElementsAre(&input1));
+  EXPECT_THAT(under_test[2], UnorderedElementsAre(&input2));
+  EXPECT_THAT(under_test[3], UnorderedElementsAre(&input1));
+  EXPECT_THAT(under_test[4], IsEmpty());
+  EXPECT_THAT(under_test[5], UnorderedElementsAre(&input2, &input3));
+  EXPECT_THAT(under_test[10], IsEmpty());
+
+  EXPECT_THAT(under_test[-1], UnorderedElementsAre(&input2, &input3));
+  EXPECT_THAT(under_test[-2], UnorderedElementsAre(&input1, &input3));
+  EXPECT_THAT(under_test[-3], IsEmpty());
+
+  EXPECT_THAT(under_test.get_max_lit_index(), Eq(19));
+}
+
+TEST(csr_occurrence_list_tests, unaries)
+{
+  Clause const input1 = {10};
+  Clause const input2 = {-20};
+
+  auto under_test = create_csr_occurrence_list({&input1, &input2});
+
+  EXPECT_THAT(under_test.get_unaries(), UnorderedElementsAre(10, -20));
+  EXPECT_THAT(under_test[10], UnorderedElementsAre(&input1));
+  EXPECT_THAT(under_test[-20], UnorderedElementsAre(&input2));
+
+  EXPECT_THAT(under_test.get_max_lit_index(), Eq(39));
+}
+
+TEST(csr_occurrence_list_tests, remove_gate_root)
+{
+  Clause const input1 = {-1, 2};
+  Clause const input2 = {-1, 3};
+  Clause const input3 = {1, -2, -3};
+  Clause const input4 = {2, 4};
+  Clause const input5 = {1};
+
+  auto under_test = create_csr_occurrence_list({&input1, &input2, &input3, &input4, &input5});
+
+  EXPECT_THAT(under_test.get_estimated_lookup_cost(2), Eq(0));
+
+  under_test.remove_gate_root(1);
+
+  EXPECT_THAT(under_test[1], IsEmpty());
+  EXPECT_THAT(under_test[-1], IsEmpty());
+  EXPECT_THAT(under_test.get_unaries(), IsEmpty());
+  EXPECT_THAT(under_test.get_estimated_lookup_cost(2), Eq(2));
+
+  EXPECT_THAT(under_test[2], UnorderedElementsAre(&input4));
+  EXPECT_THAT(under_test[-2], IsEmpty());
+  EXPECT_THAT(under_test[3], IsEmpty());
+  EXPECT_THAT(under_test[4], UnorderedElementsAre(&input4));
+  EXPECT_THAT(under_test.get_estimated_lookup_cost(2), Eq(0));
+
+  EXPECT_FALSE(under_test.empty());
+}
+
+TEST(csr_occurrence_list_tests, remove_unary)
+{
+  Clause const input1 = {5};
+  Clause const input2 = {6};
+  Clause const input3 = {-7};
+  Clause const input4 = {6, -7};
+
+  auto under_test = create_csr_occurrence_list({&input1, &input2, &input3, &input4});
+
+  under_test.remove_unary(6);
+
+  EXPECT_THAT(under_test[6], UnorderedElementsAre(&input4));
+  EXPECT_THAT(under_test.get_unaries(), UnorderedElementsAre(5, -7));
+  EXPECT_FALSE(under_test.empty());
+}
+
+TEST(csr_occurrence_list_tests, remove_and_add_clause)
+{
+  Clause const input1 = {1, -2, 3};
+  Clause const input2 = {-2, 3};
+  Clause const input3 = {3};
+
+  auto under_test = create_csr_occurrence_list({&input1, &input2, &input3});
+
+  under_test.remove(&input1);
+  under_test.remove(&input3);
+
+  EXPECT_THAT(under_test[-2], UnorderedElementsAre(&input2));
+  EXPECT_THAT(under_test.get_unaries(), IsEmpty());
+
+  // Adding back clauses before and after their occurrences have been compacted
+  under_test.add(&input1);
+  under_test.add(&input3);
+
+  EXPECT_THAT(under_test[1], UnorderedElementsAre(&input1));
+  EXPECT_THAT(under_test[-2], UnorderedElementsAre(&input1, &input2));
+  EXPECT_THAT(under_test[3], UnorderedElementsAre(&input1, &input2, &input3));
+  EXPECT_THAT(under_test.get_unaries(), UnorderedElementsAre(3));
+
+  under_test.remove_gate_root(3);
+  EXPECT_TRUE(under_test.empty());
+}
+
+TEST(csr_occurrence_list_tests, unknown_literals_do_not_occur)
+{
+  auto under_test = create_csr_occurrence_list({});
+  EXPECT_THAT(under_test[6], IsEmpty());
+}
+
+}
+}
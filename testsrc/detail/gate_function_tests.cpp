@@ -0,0 +1,103 @@
+#include <gatekit/detail/gate_function.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using ::testing::Eq;
+using ::testing::Ne;
+
+namespace gatekit {
+namespace detail {
+
+using masks = std::vector<clause_bitmask>;
+
+// o = ITE(s, a, b) with inputs (s, a, b) ~> bits (0x1, 0x2, 0x4)
+masks const ite_fwd = {{0x2, 0x1}, {0x5, 0x0}}; // (-s, a, -o), (s, b, -o)
+masks const ite_bwd = {{0x0, 0x3}, {0x1, 0x4}}; // (-s, -a, o), (s, -b, o)
+
+// ITE gate with additional consensus clauses (a, b, -o), (-a, -b, o)
+masks const consensus_fwd = {{0x2, 0x1}, {0x5, 0x0}, {0x6, 0x0}};
+masks const consensus_bwd = {{0x0, 0x3}, {0x1, 0x4}, {0x0, 0x6}};
+
+TEST(gate_function_tests, and_gate_is_total_function)
+{
+  // o = a & b & c, encoded as (a, -o), (b, -o), (c, -o), (-a, -b, -c, o)
+  masks const fwd = {{0x1, 0x0}, {0x2, 0x0}, {0x4, 0x0}};
+  masks const bwd = {{0x0, 0x7}};
+
+  EXPECT_TRUE(is_total_function(fwd, bwd, 3));
+
+  masks const incomplete_fwd = {{0x1, 0x0}, {0x2, 0x0}};
+  EXPECT_FALSE(is_total_function(incomplete_fwd, bwd, 3));
+}
+
+TEST(gate_function_tests, ite_gate_is_total_function)
+{
+  EXPECT_TRUE(is_total_function(ite_fwd, ite_bwd, 3));
+  EXPECT_TRUE(is_total_function(consensus_fwd, consensus_bwd, 3));
+}
+
+TEST(gate_function_tests, partial_function_is_not_total_function)
+{
+  masks const partial_bwd = {{0x0, 0x3}};
+  EXPECT_FALSE(is_total_function(ite_fwd, partial_bwd, 3));
+}
+
+TEST(gate_function_tests, function_of_many_inputs)
+{
+  // Parity of 8 inputs, encoded with all 256 full clauses
+  masks fwd;
+  masks bwd;
+  for (uint64_t assignment = 0; assignment < 256; ++assignment) {
+    clause_bitmask const clause = {~assignment & 0xFF, assignment};
+    bool const is_odd = (popcount(assignment) % 2) == 1;
+    (is_odd ? bwd : fwd).push_back(clause);
+  }
+
+  EXPECT_TRUE(is_total_function(fwd, bwd, 8));
+
+  bwd.pop_back();
+  EXPECT_FALSE(is_total_function(fwd, bwd, 8));
+}
+
+TEST(gate_function_tests, npn_equivalent_encodings_have_equal_keys)
+{
+  // Swapping fwd and bwd (output negation)
+  EXPECT_THAT(get_npn_key({{0x1, 0x0}}, {{0x0, 0x1}, {0x2, 0x0}}, 2),
+              Eq(get_npn_key({{0x0, 0x1}, {0x2, 0x0}}, {{0x1, 0x0}}, 2)));
+
+  // Negating input 0
+  EXPECT_THAT(get_npn_key({{0x3, 0x0}, {0x1, 0x0}}, {{0x0, 0x3}}, 2),
+              Eq(get_npn_key({{0x2, 0x1}, {0x0, 0x1}}, {{0x1, 0x2}}, 2)));
+
+  // Permuting inputs
+  EXPECT_THAT(get_npn_key({{0x1, 0x0}, {0x1, 0x2}}, {{0x0, 0x3}}, 2),
+              Eq(get_npn_key({{0x2, 0x0}, {0x2, 0x1}}, {{0x0, 0x3}}, 2)));
+}
+
+TEST(gate_function_tests, distinct_encodings_have_distinct_keys)
+{
+  EXPECT_THAT(get_npn_key(ite_fwd, ite_bwd, 3), Ne(get_npn_key(consensus_fwd, consensus_bwd, 3)));
+  EXPECT_THAT(get_npn_key({{0x1, 0x0}}, {{0x0, 0x1}}, 1),
+              Ne(get_npn_key({{0x1, 0x0}}, {{0x0, 0x1}}, 2)));
+}
+
+TEST(gate_function_tests, cache_answers_repeated_encodings)
+{
+  gate_function_cache under_test;
+
+  EXPECT_TRUE(under_test.is_total_function(ite_fwd, ite_bwd, 3));
+  EXPECT_THAT(under_test.size(), Eq(1));
+
+  // ITE gate with negated output
+  EXPECT_TRUE(under_test.is_total_function(ite_bwd, ite_fwd, 3));
+  EXPECT_THAT(under_test.size(), Eq(1));
+
+  EXPECT_FALSE(under_test.is_total_function(ite_fwd, {{0x0, 0x3}}, 3));
+  EXPECT_THAT(under_test.size(), Eq(2));
+}
+
+}
+}
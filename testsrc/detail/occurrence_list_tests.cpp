@@ -113,6 +113,21 @@ TEST(occurrence_list_tests, remove_nonunary_clauses)
   EXPECT_THAT(under_test.get_unaries(), IsEmpty());
 }
 
+TEST(occurrence_list_tests, add_removed_clause)
+{
+  Clause const input1 = {1, -2, 3};
+  Clause const input2 = {-2, 3};
+
+  auto under_test = create_occurrence_list({&input1, &input2});
+
+  under_test.remove(&input1);
+  under_test.add(&input1);
+
+  EXPECT_THAT(under_test[1], UnorderedElementsAre(&input1));
+  EXPECT_THAT(under_test[-2], UnorderedElementsAre(&input1, &input2));
+  EXPECT_THAT(under_test[3], UnorderedElementsAre(&input1, &input2));
+}
+
 TEST(occurrence_list_tests, remove_unary_clauses)
 {
   Clause const input1 = {5};
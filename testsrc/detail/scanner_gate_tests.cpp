@@ -73,8 +73,136 @@ INSTANTIATE_TEST_SUITE_P(is_gate_output_tests, is_gate_output_tests,
       ClauseList{{-1, -2, 3}, {-1, 2, -3}, {1, -2, 3}, {1, 2, -3}},
       3, false, is_gate::yes),
 
-    std::make_tuple("half a gate is not gate", ClauseList{{1, -2, -3}, {-1, -2, 3}}, 3, false, is_gate::no)
+    std::make_tuple("half a gate is not gate", ClauseList{{1, -2, -3}, {-1, -2, 3}}, 3, false, is_gate::no),
+
+    std::make_tuple("ternary XOR gate is gate",
+      ClauseList{{-1, -2, -3, -4}, {-1, -2, 3, 4}, {-1, 2, -3, 4}, {-1, 2, 3, -4},
+                 {1, 2, 3, 4}, {1, 2, -3, -4}, {1, -2, 3, -4}, {1, -2, -3, 4}},
+      4, false, is_gate::yes),
+
+    std::make_tuple("if-then-else gate with consensus clauses is gate",
+      ClauseList{{-1, 2, -4}, {1, 3, -4}, {2, 3, -4}, {-1, -2, 4}, {1, -3, 4}, {-2, -3, 4}},
+      4, false, is_gate::yes),
+
+    std::make_tuple("if-then-else gate with consensus clauses, but missing a clause is not gate",
+      ClauseList{{-1, 2, -4}, {2, 3, -4}, {-1, -2, 4}, {1, -3, 4}, {-2, -3, 4}},
+      4, false, is_gate::no),
+
+    std::make_tuple("ternary XOR gate with overlapping clauses is not gate",
+      ClauseList{{-1, -2, -3, -4}, {-1, -2, 3, 4}, {-1, 2, -3, 4}, {-1, 2, 3, -4},
+                 {1, 2, 3, 4}, {1, 2, -3, -4}, {1, -2, 3, -4}, {1, -2, 4}},
+      4, false, is_gate::no)
 ));
 // clang-format on
+
+TEST(clause_bitmask_tests, clauses_are_represented_relative_to_sorted_inputs)
+{
+  Clause const clause1 = {-3, 7, -9};
+  Clause const clause2 = {9, 2};
+  std::vector<ClauseHandle> const clauses = {&clause1, &clause2};
+  std::vector<std::size_t> const inputs = {1, 2, 6};
+
+  std::vector<clause_bitmask> result;
+  ASSERT_TRUE(try_get_clause_bitmasks(clauses, 9, inputs, result));
+  ASSERT_THAT(result.size(), ::testing::Eq(2));
+
+  EXPECT_THAT(result[0].positive, ::testing::Eq(0x4));
+  EXPECT_THAT(result[0].negative, ::testing::Eq(0x2));
+  EXPECT_THAT(result[1].positive, ::testing::Eq(0x1));
+  EXPECT_THAT(result[1].negative, ::testing::Eq(0x0));
+}
+
+TEST(clause_bitmask_tests, clauses_with_repeated_variables_are_not_represented)
+{
+  Clause const clause1 = {-3, 3, -9};
+  Clause const clause2 = {-3, -3, -9};
+  std::vector<std::size_t> const inputs = {2};
+
+  std::vector<clause_bitmask> result;
+  EXPECT_FALSE(try_get_clause_bitmasks(std::vector<ClauseHandle>{&clause1}, 9, inputs, result));
+  EXPECT_FALSE(try_get_clause_bitmasks(std::vector<ClauseHandle>{&clause2}, 9, inputs, result));
+}
+
+TEST(clause_bitmask_tests, clauses_with_noninputs_are_not_represented)
+{
+  Clause const clause = {-3, 4, -9};
+  std::vector<std::size_t> const inputs = {2};
+
+  std::vector<clause_bitmask> result;
+  EXPECT_FALSE(try_get_clause_bitmasks(std::vector<ClauseHandle>{&clause}, 9, inputs, result));
+}
+
+TEST(clause_bitmask_tests, clauses_without_single_output_literal_are_not_represented)
+{
+  // The repeated input makes the size match the number of inputs plus one
+  Clause const clause1 = {3, 3, 7};
+  Clause const clause2 = {3, 7};
+  Clause const clause3 = {-9, 3, 9};
+  std::vector<std::size_t> const inputs = {2, 6};
+
+  std::vector<clause_bitmask> result;
+  EXPECT_FALSE(try_get_clause_bitmasks(std::vector<ClauseHandle>{&clause1}, 9, inputs, result));
+  EXPECT_FALSE(try_get_clause_bitmasks(std::vector<ClauseHandle>{&clause2}, 9, inputs, result));
+  EXPECT_FALSE(try_get_clause_bitmasks(std::vector<ClauseHandle>{&clause3}, 9, inputs, result));
+}
+
+TEST(clause_bitmask_tests, pairwise_tautology_check)
+{
+  // (a, b), (-a, b), (-b) over inputs a, b
+  std::vector<clause_bitmask> const taut = {{0x3, 0x0}, {0x2, 0x1}, {0x0, 0x2}};
+  EXPECT_TRUE(are_pairwise_joined_clauses_all_taut(taut, 2));
+  EXPECT_THAT(get_num_covered_input_combinations(taut, 2), ::testing::Eq(4));
+
+  // (a), (b)
+  std::vector<clause_bitmask> const nontaut = {{0x1, 0x0}, {0x2, 0x0}};
+  EXPECT_FALSE(are_pairwise_joined_clauses_all_taut(nontaut, 2));
+  EXPECT_THAT(get_num_covered_input_combinations(nontaut, 2), ::testing::Eq(4));
+}
+TEST(gate_inputs_tests, workspace_is_reusable_across_candidates)
+{
+  // AND gate 1 = 2 & 3, and a non-gate 4 whose bwd clauses contain variable 6
+  // that does not occur in its fwd clauses
+  ClauseList const input_clauses = {{1, -2, -3}, {-1, 2}, {-1, 3}, {4, -5}, {-4, 5, 6}};
+  std::vector<ClauseHandle> handles;
+  for (Clause const& clause : input_clauses) {
+    handles.push_back(&clause);
+  }
+  occurrence_list<ClauseHandle> clauses{handles.begin(), handles.end()};
+
+  gate_matcher_workspace<int> workspace;
+
+  ASSERT_TRUE(try_get_gate_inputs(1, clauses, workspace));
+  EXPECT_THAT(workspace.inputs, ::testing::ElementsAre(1, 2));
+
+  EXPECT_FALSE(try_get_gate_inputs(4, clauses, workspace));
+  EXPECT_FALSE(try_get_gate_inputs(-4, clauses, workspace));
+
+  ASSERT_TRUE(try_get_gate_inputs(-1, clauses, workspace));
+  EXPECT_THAT(workspace.inputs, ::testing::ElementsAre(1, 2));
+}
+
+TEST(gate_inputs_tests, matcher_state_is_reusable_across_candidates)
+{
+  // XOR gate 1 = 2 ^ 3 and AND gate 4 = 5 & 6
+  ClauseList const input_clauses = {{-1, 2, 3},
+                                    {-1, -2, -3},
+                                    {1, -2, 3},
+                                    {1, 2, -3},
+                                    {4, -5, -6},
+                                    {-4, 5},
+                                    {-4, 6}};
+  std::vector<ClauseHandle> handles;
+  for (Clause const& clause : input_clauses) {
+    handles.push_back(&clause);
+  }
+  occurrence_list<ClauseHandle> clauses{handles.begin(), handles.end()};
+
+  gate_matcher_state<int> state;
+  for (int round = 0; round < 2; ++round) {
+    EXPECT_TRUE(is_gate_output(1, clauses, false, state));
+    EXPECT_TRUE(is_gate_output(4, clauses, false, state));
+    EXPECT_FALSE(is_gate_output(5, clauses, false, state));
+  }
+}
 }
 }
@@ -0,0 +1,59 @@
+#include <gatekit/detail/simulation_refinement.h>
+
+#include <gatekit/detail/simulation_tape.h>
+#include <gatekit/detail/var_compaction.h>
+#include <gatekit/gate.h>
+
+#include "../helpers/gate_factory.h"
+#include "../helpers/gate_utils.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+namespace gatekit {
+namespace detail {
+
+TEST(fanin_cones_tests, inputs_of_cone_are_collected)
+{
+  gate_structure<ClauseHandle> const structure = to_structure<ClauseHandle>(
+      {and_gate({2, -3}, 1), or_gate({4, 5}, 2), xor_gate(5, -6, 3), and_gate({7, 8}, 9)},
+      {{1, 9}});
+  simulation_tape const tape{structure};
+  fanin_cones under_test{tape, max_var_index(structure) + 1};
+
+  std::vector<std::size_t> result;
+  under_test.collect_inputs(tape, 0, 100, result);
+  EXPECT_THAT(result, ElementsAre(3, 4, 5));
+
+  under_test.collect_inputs(tape, 1, 100, result);
+  EXPECT_THAT(result, ElementsAre(3, 4));
+
+  under_test.collect_inputs(tape, 8, 100, result);
+  EXPECT_THAT(result, ElementsAre(6, 7));
+
+  under_test.collect_inputs(tape, 4, 100, result);
+  EXPECT_THAT(result, ElementsAre(4));
+}
+
+TEST(fanin_cones_tests, collection_stops_at_max_size)
+{
+  gate_structure<ClauseHandle> const structure =
+      to_structure<ClauseHandle>({and_gate({2, 3}, 1), and_gate({4, 5}, 2)}, {{1}});
+  simulation_tape const tape{structure};
+  fanin_cones under_test{tape, max_var_index(structure) + 1};
+
+  std::vector<std::size_t> result;
+  under_test.collect_inputs(tape, 0, 1, result);
+  EXPECT_THAT(result, ElementsAre(2));
+
+  under_test.collect_inputs(tape, 0, 0, result);
+  EXPECT_THAT(result, IsEmpty());
+}
+
+}
+}
@@ -0,0 +1,147 @@
+#include <gatekit/detail/simulation_tape.h>
+
+#include <gatekit/clause_arena.h>
+#include <gatekit/detail/bitvector.h>
+#include <gatekit/detail/bitvector_prop.h>
+#include <gatekit/detail/bitvector_rand.h>
+#include <gatekit/detail/var_compaction.h>
+#include <gatekit/flat_gate_structure.h>
+#include <gatekit/gate.h>
+#include <gatekit/scanner.h>
+
+#include "../helpers/circuit_generator.h"
+#include "../helpers/gate_factory.h"
+#include "../helpers/gate_utils.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+
+namespace gatekit {
+namespace detail {
+
+namespace {
+auto random_assignment(std::size_t num_vars) -> bitvector_map
+{
+  bitvector_map result{num_vars};
+  bitvector_randomizer randomizer;
+  for (std::size_t var = 0; var < num_vars; ++var) {
+    randomizer.randomize(result[var], 1);
+  }
+  return result;
+}
+
+auto copy_assignment(bitvector_map const& assignment) -> bitvector_map
+{
+  bitvector_map result{assignment.size()};
+  for (std::size_t var = 0; var < assignment.size(); ++var) {
+    result[var] = assignment[var];
+  }
+  return result;
+}
+
+template <typename ClauseHandle>
+void expect_same_result_as_propagate_structure(gate_structure<ClauseHandle> const& structure)
+{
+  bitvector_map const start_assignment = random_assignment(max_var_index(structure) + 1);
+
+  bitvector_map expected = copy_assignment(start_assignment);
+  propagate_structure(expected, structure);
+
+  bitvector_map result = copy_assignment(start_assignment);
+  run_tape(result, simulation_tape{structure});
+
+  bitvector_map flat_result = copy_assignment(start_assignment);
+  run_tape(flat_result, simulation_tape{flatten(structure)});
+
+  for (std::size_t var = 0; var < expected.size(); ++var) {
+    ASSERT_TRUE(result[var] == expected[var]) << "mismatch for var " << var;
+    ASSERT_TRUE(flat_result[var] == expected[var]) << "mismatch for var " << var << " (flat)";
+  }
+}
+}
+
+
+TEST(simulation_tape_tests, gate_is_compiled_to_operand_runs)
+{
+  // AND gates are propagated via their fwd clauses (-2 1) and (-2 -3)
+  gate_structure<ClauseHandle> const structure =
+      to_structure<ClauseHandle>({and_gate({1, -3}, 2)}, {{2}});
+
+  simulation_tape const under_test{structure};
+
+  ASSERT_THAT(under_test.num_gates(), Eq(1));
+  simulation_tape::tape_gate const& gate = under_test.get_gate(0);
+  EXPECT_THAT(gate.output_var, Eq(1));
+  EXPECT_FALSE(gate.invert_output);
+
+  ASSERT_THAT(gate.clauses_end - gate.clauses_begin, Eq(2));
+  EXPECT_THAT(under_test.get_operands(gate.clauses_begin), ElementsAre(0));
+  EXPECT_THAT(under_test.get_operands(gate.clauses_begin + 1), ElementsAre(5));
+}
+
+TEST(simulation_tape_tests, operand_vars_are_mapped)
+{
+  gate_structure<ClauseHandle> const structure =
+      to_structure<ClauseHandle>({and_gate({100, -300}, 200)}, {{200}});
+  var_compaction const compaction{structure.gates};
+
+  simulation_tape const under_test{structure, compaction};
+
+  simulation_tape::tape_gate const& gate = under_test.get_gate(0);
+  EXPECT_THAT(gate.output_var, Eq(1));
+  EXPECT_THAT(under_test.get_operands(gate.clauses_begin), ElementsAre(0));
+  EXPECT_THAT(under_test.get_operands(gate.clauses_begin + 1), ElementsAre(5));
+}
+
+TEST(simulation_tape_tests, result_is_same_as_for_propagate_structure)
+{
+  clause_arena const clauses = multiplier_miter(8, encoding::full).clauses;
+  expect_same_result_as_propagate_structure(
+      scan_gates<arena_clause>(clauses.begin(), clauses.end()));
+}
+
+TEST(simulation_tape_tests, long_clauses_are_propagated)
+{
+  // The fwd clause of the monotonically nested OR gate has more operands than
+  // the clause kernel processes at once
+  std::vector<int> inputs;
+  for (int input = 10; input < 50; ++input) {
+    inputs.push_back(input % 3 == 0 ? -input : input);
+  }
+
+  expect_same_result_as_propagate_structure(to_structure<ClauseHandle>(
+      {monotonic(or_gate(inputs, 1)), xor_gate(-2, 3, 10), and_gate({4, 5}, 11)}, {{1}}));
+}
+
+TEST(simulation_tape_tests, scheduled_result_is_same_as_for_sequential_propagation)
+{
+  clause_arena const clauses = multiplier_miter(16, encoding::full).clauses;
+  gate_structure<arena_clause> const structure =
+      scan_gates<arena_clause>(clauses.begin(), clauses.end());
+
+  simulation_tape const tape{structure};
+  propagation_schedule const schedule{structure};
+  bitvector_map const start_assignment = random_assignment(max_var_index(structure) + 1);
+
+  bitvector_map expected = copy_assignment(start_assignment);
+  run_tape(expected, tape);
+
+  for (std::size_t num_threads : {1, 2, 4}) {
+    bitvector_map result = copy_assignment(start_assignment);
+    run_tape(result, tape, schedule, num_threads);
+
+    for (std::size_t var = 0; var < expected.size(); ++var) {
+      ASSERT_TRUE(result[var] == expected[var]) << "mismatch for var " << var
+                                                << " with " << num_threads << " threads";
+    }
+  }
+}
+
+}
+}
@@ -0,0 +1,93 @@
+#include <gatekit/detail/threads.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace gatekit {
+namespace detail {
+
+TEST(run_in_parallel_tests, each_task_is_run_once)
+{
+  std::vector<std::atomic<int>> num_calls(5);
+  for (std::atomic<int>& count : num_calls) {
+    count = 0;
+  }
+
+  run_in_parallel(num_calls.size(), [&num_calls](std::size_t index) { ++num_calls[index]; });
+
+  for (std::atomic<int> const& count : num_calls) {
+    EXPECT_THAT(count.load(), ::testing::Eq(1));
+  }
+}
+
+TEST(worker_pool_tests, each_task_is_run_once_per_job)
+{
+  worker_pool under_test{4};
+  ASSERT_THAT(under_test.size(), ::testing::Eq(4));
+
+  std::vector<std::atomic<int>> num_calls(4);
+  for (std::atomic<int>& count : num_calls) {
+    count = 0;
+  }
+
+  for (int job = 0; job < 100; ++job) {
+    under_test.run([&num_calls](std::size_t index) { ++num_calls[index]; });
+  }
+
+  for (std::atomic<int> const& count : num_calls) {
+    EXPECT_THAT(count.load(), ::testing::Eq(100));
+  }
+}
+
+TEST(worker_pool_tests, tasks_can_synchronize_with_barrier)
+{
+  worker_pool under_test{3};
+  barrier phase_done{under_test.size()};
+  std::atomic<int> num_first_phase_done{0};
+  std::atomic<int> num_incomplete_first_phases_seen{0};
+
+  under_test.run([&](std::size_t) {
+    ++num_first_phase_done;
+    phase_done.arrive_and_wait();
+    if (num_first_phase_done.load() != 3) {
+      ++num_incomplete_first_phases_seen;
+    }
+  });
+
+  EXPECT_THAT(num_incomplete_first_phases_seen.load(), ::testing::Eq(0));
+}
+
+TEST(worker_pool_tests, exceptions_are_rethrown_and_pool_stays_usable)
+{
+  worker_pool under_test{2};
+
+  auto const throwing_task = [](std::size_t index) {
+    if (index == 1) {
+      throw std::runtime_error{"test"};
+    }
+  };
+  EXPECT_THROW(under_test.run(throwing_task), std::runtime_error);
+
+  std::atomic<int> num_calls{0};
+  EXPECT_NO_THROW(under_test.run([&num_calls](std::size_t) { ++num_calls; }));
+  EXPECT_THAT(num_calls.load(), ::testing::Eq(2));
+}
+
+TEST(worker_pool_tests, single_thread_pool_runs_task_on_calling_thread)
+{
+  worker_pool under_test{0};
+  ASSERT_THAT(under_test.size(), ::testing::Eq(1));
+
+  std::thread::id task_thread;
+  under_test.run([&task_thread](std::size_t) { task_thread = std::this_thread::get_id(); });
+  EXPECT_THAT(task_thread, ::testing::Eq(std::this_thread::get_id()));
+}
+
+}
+}
@@ -0,0 +1,61 @@
+#include <gatekit/detail/var_compaction.h>
+
+#include <gatekit/gate.h>
+
+#include "../helpers/gate_factory.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+
+namespace gatekit {
+namespace detail {
+
+TEST(var_compaction_tests, occurring_vars_are_numbered_densely_in_ascending_order)
+{
+  std::vector<gate<ClauseHandle>> const gates = {and_gate({100, -7}, 3000), or_gate({7, 3000}, 42)};
+
+  var_compaction const under_test{gates};
+
+  // The variable index of literal x is |x| - 1
+  ASSERT_THAT(under_test.size(), Eq(4));
+  EXPECT_THAT(under_test(6), Eq(0));
+  EXPECT_THAT(under_test(41), Eq(1));
+  EXPECT_THAT(under_test(99), Eq(2));
+  EXPECT_THAT(under_test(2999), Eq(3));
+
+  EXPECT_THAT(under_test.to_original(2), Eq(99));
+  EXPECT_TRUE(under_test.contains(2999));
+  EXPECT_FALSE(under_test.contains(7));
+  EXPECT_FALSE(under_test.contains(3000));
+
+  EXPECT_THAT(under_test.compact({2999, 6}), ElementsAre(3, 0));
+}
+
+TEST(var_compaction_tests, empty_structure_has_no_vars)
+{
+  var_compaction const under_test{std::vector<gate<ClauseHandle>>{}};
+  EXPECT_THAT(under_test.size(), Eq(0));
+  EXPECT_FALSE(under_test.contains(0));
+}
+
+TEST(var_compaction_tests, partitioning_is_restored_to_original_literals)
+{
+  std::vector<gate<ClauseHandle>> const gates = {and_gate({100, 200}, 300)};
+  var_compaction const under_test{gates};
+
+  lit_partitioning<int> compacted;
+  compacted.backbones = {-2};
+  compacted.equivalences = {{1, -3}};
+
+  lit_partitioning<int> const result = under_test.restore(compacted);
+  EXPECT_THAT(result.backbones, ElementsAre(-200));
+  EXPECT_THAT(result.equivalences, ElementsAre(ElementsAre(100, -300)));
+}
+
+}
+}
@@ -0,0 +1,141 @@
+#include <gatekit/dimacs.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::IsEmpty;
+
+namespace gatekit {
+
+namespace {
+auto to_vectors(clause_arena const& arena) -> std::vector<std::vector<int>>
+{
+  std::vector<std::vector<int>> result;
+  for (arena_clause clause : arena) {
+    result.emplace_back(clause.begin(), clause.end());
+  }
+  return result;
+}
+
+auto parse(std::string const& input, std::size_t num_chunks) -> clause_arena
+{
+  return detail::parse_dimacs_chunked(input.data(), input.data() + input.size(), num_chunks);
+}
+}
+
+TEST(dimacs_tests, empty_input_yields_empty_arena)
+{
+  clause_arena const result = parse("", 1);
+  EXPECT_TRUE(result.empty());
+}
+
+TEST(dimacs_tests, header_and_comments_are_skipped)
+{
+  std::string const input = "c comment 1 0\np cnf 10 2\n1 -2 0\nc another -3 0\n-3 4 0\n";
+  clause_arena const result = parse(input, 1);
+
+  EXPECT_THAT(to_vectors(result), ElementsAre(std::vector<int>{1, -2}, std::vector<int>{-3, 4}));
+  EXPECT_THAT(result.size(), Eq(2));
+  EXPECT_THAT(result.get_num_vars(), Eq(10));
+}
+
+TEST(dimacs_tests, clauses_may_span_lines)
+{
+  clause_arena const result = parse("1 2\n3\n0 -4\n0\n0", 1);
+
+  EXPECT_THAT(to_vectors(result),
+              ElementsAre(std::vector<int>{1, 2, 3}, std::vector<int>{-4}, std::vector<int>{}));
+}
+
+TEST(dimacs_tests, missing_terminator_of_last_clause_is_tolerated)
+{
+  clause_arena const result = parse("1 2 0\n3 -4", 1);
+  EXPECT_THAT(to_vectors(result), ElementsAre(std::vector<int>{1, 2}, std::vector<int>{3, -4}));
+}
+
+TEST(dimacs_tests, parsing_stops_at_end_marker)
+{
+  clause_arena const result = parse("p cnf 3 2\n1 2 0\n-3 0\n%\n0\n", 1);
+  EXPECT_THAT(to_vectors(result), ElementsAre(std::vector<int>{1, 2}, std::vector<int>{-3}));
+}
+
+TEST(dimacs_tests, input_after_end_marker_is_ignored_when_chunked)
+{
+  // Large enough to be split into several chunks by parse_dimacs()
+  std::string input = "p cnf 2 0\n";
+  while (input.size() < (1 << 21)) {
+    input += "1 -2 0\n";
+  }
+  std::size_t const num_clauses = (input.size() - 10) / 7;
+
+  input += "%\n0\n";
+  while (input.size() < (1 << 23)) {
+    input += "garbage\n";
+  }
+
+  clause_arena const result = parse_dimacs(input.data(), input.data() + input.size(), 8);
+  EXPECT_THAT(result.size(), Eq(num_clauses));
+  EXPECT_THAT(result.get_num_vars(), Eq(2));
+
+  for (std::size_t num_chunks = 1; num_chunks < 8; ++num_chunks) {
+    EXPECT_NO_THROW(parse("1 2 0\n%\n0\nx y\n-1 z 0\n", num_chunks))
+        << "num_chunks=" << num_chunks;
+  }
+}
+
+TEST(dimacs_tests, invalid_tokens_are_rejected)
+{
+  EXPECT_THROW(parse("1 x 0\n", 1), std::runtime_error);
+  EXPECT_THROW(parse("1 2a 0\n", 1), std::runtime_error);
+  EXPECT_THROW(parse("1 - 0\n", 1), std::runtime_error);
+  EXPECT_THROW(parse("1 99999999999 0\n", 1), std::runtime_error);
+}
+
+TEST(dimacs_tests, result_is_independent_of_chunk_count)
+{
+  std::string input = "c generated\np cnf 40 0\n";
+  for (int var = 1; var <= 40; ++var) {
+    input += std::to_string(var) + " -" + std::to_string((var % 40) + 1) + "\n";
+    if (var % 3 == 0) {
+      input += "c comment 5 0\n";
+    }
+    input += std::to_string(-var) + " 0\n";
+  }
+
+  std::vector<std::vector<int>> const expected = to_vectors(parse(input, 1));
+  ASSERT_THAT(expected.size(), Eq(40));
+
+  for (std::size_t num_chunks = 2; num_chunks < 40; ++num_chunks) {
+    EXPECT_THAT(to_vectors(parse(input, num_chunks)), Eq(expected))
+        << "num_chunks=" << num_chunks;
+  }
+}
+
+TEST(dimacs_tests, read_dimacs_reads_file)
+{
+  std::string const path = ::testing::TempDir() + "gatekit_dimacs_tests.cnf";
+  {
+    std::ofstream file{path};
+    file << "p cnf 3 2\n1 -2 0\n2 3 0\n";
+  }
+
+  clause_arena const result = read_dimacs(path, 2);
+  std::remove(path.c_str());
+
+  EXPECT_THAT(to_vectors(result), ElementsAre(std::vector<int>{1, -2}, std::vector<int>{2, 3}));
+}
+
+TEST(dimacs_tests, read_dimacs_throws_for_missing_file)
+{
+  EXPECT_THROW(read_dimacs(::testing::TempDir() + "gatekit_does_not_exist.cnf"),
+               std::runtime_error);
+}
+}
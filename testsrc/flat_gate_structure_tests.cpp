@@ -0,0 +1,129 @@
+#include <gatekit/flat_gate_structure.h>
+
+#include <gatekit/gate.h>
+
+#include "helpers/gate_factory.h"
+#include "helpers/gate_utils.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+using ::testing::Eq;
+using ::testing::IsEmpty;
+
+namespace gatekit {
+
+namespace {
+auto make_structure() -> gate_structure<ClauseHandle>
+{
+  return to_structure<ClauseHandle>({and_gate({2, 3}, 1),
+                                     monotonic(or_gate({4, -5}, 2)),
+                                     xor_gate(6, 7, 3)},
+                                    {{1}, {-4, 6}});
+}
+}
+
+TEST(flat_gate_structure_tests, empty_after_construction)
+{
+  flat_gate_structure<ClauseHandle> under_test;
+  EXPECT_TRUE(under_test.gates.empty());
+  EXPECT_THAT(under_test.gates.size(), Eq(0));
+  EXPECT_TRUE(under_test.gates.begin() == under_test.gates.end());
+  EXPECT_THAT(under_test.roots, IsEmpty());
+}
+
+TEST(flat_gate_structure_tests, views_have_members_of_gates)
+{
+  gate_structure<ClauseHandle> const structure = make_structure();
+  flat_gate_structure<ClauseHandle> const under_test = flatten(structure);
+
+  ASSERT_THAT(under_test.gates.size(), Eq(structure.gates.size()));
+  EXPECT_THAT(under_test.gates.get_outputs(), ElementsAre(1, 2, 3));
+  EXPECT_THAT(under_test.roots, Eq(structure.roots));
+
+  for (std::size_t index = 0; index < structure.gates.size(); ++index) {
+    gate<ClauseHandle> const& expected = structure.gates[index];
+    gate_view<ClauseHandle> const view = under_test.gates[index];
+
+    EXPECT_THAT(view.clauses, ElementsAreArray(expected.clauses));
+    EXPECT_THAT(view.inputs, ElementsAreArray(expected.inputs));
+    EXPECT_THAT(view.output, Eq(expected.output));
+    EXPECT_THAT(view.num_fwd_clauses, Eq(expected.num_fwd_clauses));
+    EXPECT_THAT(view.is_nested_monotonically, Eq(expected.is_nested_monotonically));
+  }
+}
+
+TEST(flat_gate_structure_tests, iterators_visit_gates_in_order)
+{
+  flat_gate_structure<ClauseHandle> const under_test = flatten(make_structure());
+
+  std::vector<int> outputs;
+  for (gate_view<ClauseHandle> const& view : under_test.gates) {
+    outputs.push_back(view.output);
+  }
+  EXPECT_THAT(outputs, ElementsAre(1, 2, 3));
+
+  auto const begin = under_test.gates.begin();
+  auto const end = under_test.gates.end();
+  EXPECT_THAT(end - begin, Eq(3));
+  EXPECT_THAT((*(end - 1)).output, Eq(3));
+  EXPECT_THAT(begin[1].output, Eq(2));
+  EXPECT_TRUE(begin < end);
+}
+
+TEST(flat_gate_structure_tests, conversion_roundtrip_yields_original_structure)
+{
+  gate_structure<ClauseHandle> const structure = make_structure();
+  EXPECT_THAT(to_gate_structure(flatten(structure)), Eq(structure));
+}
+
+TEST(flat_gate_structure_tests, gates_can_be_appended)
+{
+  gate_structure<ClauseHandle> const structure = make_structure();
+  flat_gate_structure<ClauseHandle> const source = flatten(structure);
+
+  flat_gate_structure<ClauseHandle> under_test;
+  under_test.gates.push_back(source.gates[2]);
+  under_test.gates.push_back(structure.gates[0]);
+
+  ASSERT_THAT(under_test.gates.size(), Eq(2));
+  EXPECT_THAT(to_gate(under_test.gates[0]), Eq(structure.gates[2]));
+  EXPECT_THAT(to_gate(under_test.gates[1]), Eq(structure.gates[0]));
+
+  under_test.gates.clear();
+  EXPECT_TRUE(under_test.gates.empty());
+}
+
+TEST(flat_gate_structure_tests, full_range_of_forward_clause_counts_is_kept)
+{
+  // Only the stored count is checked, so the clauses need not be consistent
+  // with it
+  gate<ClauseHandle> large_gate = make_structure().gates[0];
+  large_gate.num_fwd_clauses = 0x80000001u;
+  large_gate.is_nested_monotonically = false;
+
+  flat_gate_list<ClauseHandle> under_test;
+  under_test.push_back(large_gate);
+  large_gate.is_nested_monotonically = true;
+  under_test.push_back(large_gate);
+
+  EXPECT_THAT(under_test[0].num_fwd_clauses, Eq(0x80000001u));
+  EXPECT_FALSE(under_test[0].is_nested_monotonically);
+  EXPECT_THAT(under_test[1].num_fwd_clauses, Eq(0x80000001u));
+  EXPECT_TRUE(under_test[1].is_nested_monotonically);
+}
+
+TEST(flat_gate_structure_tests, queries_match_gate_structure)
+{
+  gate_structure<ClauseHandle> const structure = make_structure();
+  flat_gate_structure<ClauseHandle> const under_test = flatten(structure);
+
+  EXPECT_THAT(max_var_index(under_test), Eq(max_var_index(structure)));
+  EXPECT_THAT(input_var_indices(under_test), Eq(input_var_indices(structure)));
+  EXPECT_THAT(to_string(under_test), Eq(to_string(structure)));
+}
+}
@@ -0,0 +1,394 @@
+#include "circuit_generator.h"
+
+#include <gatekit/detail/scanner_structure.h>
+
+#include <cassert>
+#include <cstdlib>
+#include <random>
+#include <utility>
+
+namespace gatekit {
+
+auto circuit_builder::add_input() -> int
+{
+  return add_node(node_kind::input, {});
+}
+
+auto circuit_builder::add_inputs(std::size_t num_inputs) -> std::vector<int>
+{
+  std::vector<int> result;
+  for (std::size_t idx = 0; idx < num_inputs; ++idx) {
+    result.push_back(add_input());
+  }
+  return result;
+}
+
+auto circuit_builder::add_and(std::vector<int> const& inputs) -> int
+{
+  return add_node(node_kind::and_gate, inputs);
+}
+
+auto circuit_builder::add_or(std::vector<int> const& inputs) -> int
+{
+  return add_node(node_kind::or_gate, inputs);
+}
+
+auto circuit_builder::add_xor(int lhs, int rhs) -> int
+{
+  return add_node(node_kind::xor_gate, {lhs, rhs});
+}
+
+auto circuit_builder::add_ite(int select, int then_lit, int else_lit) -> int
+{
+  return add_node(node_kind::ite_gate, {select, then_lit, else_lit});
+}
+
+void circuit_builder::add_root(int literal)
+{
+  m_roots.push_back(literal);
+}
+
+auto circuit_builder::add_node(node_kind kind, std::vector<int> const& operands) -> int
+{
+  for (int operand : operands) {
+    assert(operand != 0 && static_cast<std::size_t>(std::abs(operand)) <= m_nodes.size());
+    (void)operand;
+  }
+
+  node const new_node = {kind, m_operands.size(), operands.size()};
+  m_nodes.push_back(new_node);
+  m_operands.insert(m_operands.end(), operands.begin(), operands.end());
+  return static_cast<int>(m_nodes.size());
+}
+
+auto circuit_builder::get_clauses(int output) const -> gate_clauses
+{
+  node const& gate_node = m_nodes[static_cast<std::size_t>(output) - 1];
+  int const* operands = m_operands.data() + gate_node.first_operand;
+
+  switch (gate_node.kind) {
+  case node_kind::and_gate:
+    return and_gate_clauses({operands, operands + gate_node.num_operands}, output);
+  case node_kind::or_gate:
+    return or_gate_clauses({operands, operands + gate_node.num_operands}, output);
+  case node_kind::xor_gate:
+    return xor_gate_clauses(operands[0], operands[1], output);
+  case node_kind::ite_gate:
+    return ite_gate_clauses(operands[0], operands[1], operands[2], output);
+  case node_kind::input:
+    break;
+  }
+
+  assert(false && "inputs have no clauses");
+  return gate_clauses{};
+}
+
+auto circuit_builder::encode(encoding enc) const -> generated_circuit
+{
+  // Usage flags per node, which are complete when the node is visited since
+  // nodes are visited in reverse order of their creation
+  uint8_t const used_positively = 1;
+  uint8_t const used_negatively = 2;
+  std::vector<uint8_t> usage(m_nodes.size(), 0);
+
+  auto mark_used = [&usage](int literal) {
+    usage[static_cast<std::size_t>(std::abs(literal)) - 1] |=
+        literal > 0 ? used_positively : used_negatively;
+  };
+
+  // The gates are stored as clause indices until all clauses have been added,
+  // since adding clauses to the arena invalidates its clause handles
+  struct encoded_gate {
+    int output;
+    bool is_nested_monotonically;
+    std::size_t first_clause;
+    std::size_t num_fwd_clauses;
+    std::size_t num_clauses;
+  };
+  std::vector<encoded_gate> gates;
+
+  generated_circuit result;
+  std::size_t num_clauses = 0;
+
+  auto add_clauses = [&result, &num_clauses](ClauseList const& clauses) {
+    for (Clause const& clause : clauses) {
+      result.clauses.add_clause(clause.begin(), clause.end());
+      ++num_clauses;
+    }
+  };
+
+  for (int root : m_roots) {
+    mark_used(root);
+    result.clauses.add_clause({root});
+    result.expected.roots.push_back({root});
+    ++num_clauses;
+  }
+
+  for (std::size_t idx = m_nodes.size(); idx-- > 0;) {
+    if (m_nodes[idx].kind == node_kind::input || usage[idx] == 0) {
+      continue;
+    }
+
+    int const var = static_cast<int>(idx) + 1;
+    bool const is_used_positively = (usage[idx] & used_positively) != 0;
+    bool const is_monotonic = usage[idx] != (used_positively | used_negatively);
+
+    // Like the scanner, using the output polarity in which the gate is used
+    gate_clauses const clauses = get_clauses(var);
+    ClauseList const& fwd = is_used_positively ? clauses.fwd : clauses.bwd;
+    ClauseList const& bwd = is_used_positively ? clauses.bwd : clauses.fwd;
+
+    for (Clause const& clause : fwd) {
+      for (int literal : clause) {
+        if (std::abs(literal) != var) {
+          mark_used(literal);
+          if (!is_monotonic) {
+            mark_used(-literal);
+          }
+        }
+      }
+    }
+
+    encoded_gate gate_info = {is_used_positively ? var : -var, is_monotonic, num_clauses, 0, 0};
+
+    add_clauses(fwd);
+    gate_info.num_fwd_clauses = num_clauses - gate_info.first_clause;
+
+    if (enc == encoding::full || !is_monotonic) {
+      add_clauses(bwd);
+    }
+    gate_info.num_clauses = num_clauses - gate_info.first_clause;
+
+    gates.push_back(gate_info);
+  }
+
+  std::vector<arena_clause> const handles = result.clauses.get_handles();
+
+  result.expected.gates.reserve(gates.size());
+  for (encoded_gate const& gate_info : gates) {
+    gate<arena_clause> expected_gate;
+    expected_gate.output = gate_info.output;
+    expected_gate.is_nested_monotonically = gate_info.is_nested_monotonically;
+    expected_gate.num_fwd_clauses = gate_info.num_fwd_clauses;
+    expected_gate.clauses.assign(handles.begin() + gate_info.first_clause,
+                                 handles.begin() + gate_info.first_clause + gate_info.num_clauses);
+    expected_gate.inputs = detail::get_inputs(expected_gate);
+
+    result.expected.gates.push_back(std::move(expected_gate));
+  }
+
+  return result;
+}
+
+
+namespace {
+// Adds the given bits, returning the sum and the carry bit. Absent bits are
+// represented by 0.
+auto add_bits(circuit_builder& builder, int lhs, int rhs, int carry) -> std::pair<int, int>
+{
+  std::vector<int> present;
+  for (int bit : {lhs, rhs, carry}) {
+    if (bit != 0) {
+      present.push_back(bit);
+    }
+  }
+
+  if (present.size() < 2) {
+    return {present.empty() ? 0 : present.front(), 0};
+  }
+
+  int const half_sum = builder.add_xor(present[0], present[1]);
+  int const half_carry = builder.add_and({present[0], present[1]});
+
+  if (present.size() == 2) {
+    return {half_sum, half_carry};
+  }
+
+  int const sum = builder.add_xor(half_sum, present[2]);
+  int const carry_out = builder.add_or({half_carry, builder.add_and({half_sum, present[2]})});
+  return {sum, carry_out};
+}
+
+auto multiply(circuit_builder& builder, std::vector<int> const& lhs, std::vector<int> const& rhs)
+    -> std::vector<int>
+{
+  std::vector<int> result;
+
+  // Bits of the partial sum that have not been shifted out yet
+  std::vector<int> partial_sum;
+  for (int lhs_bit : lhs) {
+    partial_sum.push_back(builder.add_and({lhs_bit, rhs[0]}));
+  }
+
+  for (std::size_t row = 1; row < rhs.size(); ++row) {
+    result.push_back(partial_sum.front());
+
+    std::vector<int> next_partial_sum;
+    int carry = 0;
+
+    for (std::size_t col = 0; col < lhs.size(); ++col) {
+      int const product = builder.add_and({lhs[col], rhs[row]});
+      int const previous = col + 1 < partial_sum.size() ? partial_sum[col + 1] : 0;
+
+      std::pair<int, int> const sum = add_bits(builder, product, previous, carry);
+      next_partial_sum.push_back(sum.first);
+      carry = sum.second;
+    }
+
+    if (carry != 0) {
+      next_partial_sum.push_back(carry);
+    }
+
+    partial_sum = std::move(next_partial_sum);
+  }
+
+  result.insert(result.end(), partial_sum.begin(), partial_sum.end());
+  return result;
+}
+
+auto finish_with_root(circuit_builder& builder, std::vector<int> const& outputs, encoding enc)
+    -> generated_circuit
+{
+  builder.add_root(outputs.size() == 1 ? outputs.front() : builder.add_or(outputs));
+  return builder.encode(enc);
+}
+}
+
+
+auto multiplier_miter(std::size_t num_bits, encoding enc) -> generated_circuit
+{
+  assert(num_bits > 0);
+
+  circuit_builder builder;
+  std::vector<int> const lhs = builder.add_inputs(num_bits);
+  std::vector<int> const rhs = builder.add_inputs(num_bits);
+
+  std::vector<int> const product = multiply(builder, lhs, rhs);
+  std::vector<int> const swapped_product = multiply(builder, rhs, lhs);
+  assert(product.size() == swapped_product.size());
+
+  std::vector<int> differences;
+  for (std::size_t idx = 0; idx < product.size(); ++idx) {
+    differences.push_back(builder.add_xor(product[idx], swapped_product[idx]));
+  }
+
+  return finish_with_root(builder, differences, enc);
+}
+
+auto adder_chain(std::size_t num_bits, std::size_t num_operands, encoding enc)
+    -> generated_circuit
+{
+  assert(num_bits > 0 && num_operands > 1);
+
+  circuit_builder builder;
+  std::vector<int> sum = builder.add_inputs(num_bits);
+
+  for (std::size_t operand_idx = 1; operand_idx < num_operands; ++operand_idx) {
+    std::vector<int> const operand = builder.add_inputs(num_bits);
+
+    int carry = 0;
+    for (std::size_t bit = 0; bit < num_bits; ++bit) {
+      std::pair<int, int> const bit_sum = add_bits(builder, sum[bit], operand[bit], carry);
+      sum[bit] = bit_sum.first;
+      carry = bit_sum.second;
+    }
+  }
+
+  return finish_with_root(builder, sum, enc);
+}
+
+auto xor_tree(std::size_t num_inputs, encoding enc) -> generated_circuit
+{
+  assert(num_inputs > 1);
+
+  circuit_builder builder;
+  std::vector<int> level = builder.add_inputs(num_inputs);
+
+  while (level.size() > 1) {
+    std::vector<int> next_level;
+    for (std::size_t idx = 0; idx + 1 < level.size(); idx += 2) {
+      next_level.push_back(builder.add_xor(level[idx], level[idx + 1]));
+    }
+    if (level.size() % 2 != 0) {
+      next_level.push_back(level.back());
+    }
+    level = std::move(next_level);
+  }
+
+  return finish_with_root(builder, level, enc);
+}
+
+auto mux_tree(std::size_t num_select_bits, encoding enc) -> generated_circuit
+{
+  assert(num_select_bits > 0);
+
+  circuit_builder builder;
+  std::vector<int> const select = builder.add_inputs(num_select_bits);
+  std::vector<int> level = builder.add_inputs(std::size_t{1} << num_select_bits);
+
+  for (int select_bit : select) {
+    std::vector<int> next_level;
+    for (std::size_t idx = 0; idx < level.size(); idx += 2) {
+      next_level.push_back(builder.add_ite(select_bit, level[idx + 1], level[idx]));
+    }
+    level = std::move(next_level);
+  }
+
+  return finish_with_root(builder, level, enc);
+}
+
+auto cardinality_network(std::size_t num_inputs, std::size_t min_true, encoding enc)
+    -> generated_circuit
+{
+  assert(min_true > 0 && min_true <= num_inputs);
+
+  circuit_builder builder;
+  std::vector<int> wires = builder.add_inputs(num_inputs);
+
+  // Batcher's odd-even merge sort for arbitrary sizes, sorting in descending order
+  for (std::size_t block = 1; block < num_inputs; block *= 2) {
+    for (std::size_t dist = block; dist >= 1; dist /= 2) {
+      for (std::size_t start = dist % block; start + dist < num_inputs; start += 2 * dist) {
+        for (std::size_t idx = 0; idx < dist && start + idx + dist < num_inputs; ++idx) {
+          std::size_t const upper = start + idx;
+          std::size_t const lower = upper + dist;
+
+          if (upper / (2 * block) == lower / (2 * block)) {
+            int const max = builder.add_or({wires[upper], wires[lower]});
+            int const min = builder.add_and({wires[upper], wires[lower]});
+            wires[upper] = max;
+            wires[lower] = min;
+          }
+        }
+      }
+    }
+  }
+
+  builder.add_root(wires[min_true - 1]);
+  return builder.encode(enc);
+}
+
+auto random_aig(std::size_t num_gates, std::size_t num_inputs, uint64_t seed, encoding enc)
+    -> generated_circuit
+{
+  assert(num_gates > 0 && num_inputs > 1);
+
+  std::mt19937_64 rng{seed};
+
+  circuit_builder builder;
+  std::vector<int> nodes = builder.add_inputs(num_inputs);
+
+  for (std::size_t idx = 0; idx < num_gates; ++idx) {
+    // Choosing the other input among all nodes except the previous one
+    int const previous = nodes.back();
+    int const other = nodes[rng() % (nodes.size() - 1)];
+
+    int const lhs = rng() % 2 == 0 ? previous : -previous;
+    int const rhs = rng() % 2 == 0 ? other : -other;
+    nodes.push_back(builder.add_and({lhs, rhs}));
+  }
+
+  builder.add_root(nodes.back());
+  return builder.encode(enc);
+}
+}
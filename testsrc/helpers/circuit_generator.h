@@ -0,0 +1,96 @@
+#pragma once
+
+#include "gate_factory.h"
+
+#include <gatekit/clause_arena.h>
+#include <gatekit/gate.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gatekit {
+
+// CNF encoding of a circuit, together with the gate structure that the
+// scanner is expected to recover from it
+struct generated_circuit {
+  clause_arena clauses;
+
+  // Gates and roots, with clause handles referring to `clauses`. Gates are
+  // ordered reverse-topologically. Gates that are used in both polarities
+  // have positive outputs. If the output of a gate is interchangeable with
+  // one of its inputs (e.g. for XOR gates with otherwise unused inputs), the
+  // scanner may choose a different output.
+  gate_structure<arena_clause> expected;
+};
+
+
+// Builds circuits node by node, with nodes being numbered like DIMACS
+// variables. Inputs of gates may be negated nodes.
+//
+// Only the gates reachable from the roots are encoded. With encoding::opt,
+// each gate is encoded in the polarities it is used in (Plaisted-Greenbaum
+// encoding), so gates used in a single polarity only get the clauses
+// implied by their output.
+class circuit_builder {
+public:
+  auto add_input() -> int;
+  auto add_inputs(std::size_t num_inputs) -> std::vector<int>;
+
+  auto add_and(std::vector<int> const& inputs) -> int;
+  auto add_or(std::vector<int> const& inputs) -> int;
+  auto add_xor(int lhs, int rhs) -> int;
+  auto add_ite(int select, int then_lit, int else_lit) -> int;
+
+  // Constrains `literal` to be true via a unary clause
+  void add_root(int literal);
+
+  auto get_num_nodes() const noexcept -> std::size_t { return m_nodes.size(); }
+
+  auto encode(encoding enc) const -> generated_circuit;
+
+private:
+  enum class node_kind : uint8_t { input, and_gate, or_gate, xor_gate, ite_gate };
+
+  struct node {
+    node_kind kind;
+    std::size_t first_operand;
+    std::size_t num_operands;
+  };
+
+  auto add_node(node_kind kind, std::vector<int> const& operands) -> int;
+  auto get_clauses(int output) const -> gate_clauses;
+
+  std::vector<node> m_nodes;
+  std::vector<int> m_operands;
+  std::vector<int> m_roots;
+};
+
+
+// Each of the following functions generates a circuit with a unary root
+// clause. Circuits with multiple outputs are rooted in the disjunction of
+// their outputs.
+
+// Miter of two array multipliers with swapped operands
+auto multiplier_miter(std::size_t num_bits, encoding enc) -> generated_circuit;
+
+// Sum of `num_operands` numbers with ripple-carry adders, modulo 2^num_bits
+auto adder_chain(std::size_t num_bits, std::size_t num_operands, encoding enc)
+    -> generated_circuit;
+
+// Balanced tree of binary XOR gates
+auto xor_tree(std::size_t num_inputs, encoding enc) -> generated_circuit;
+
+// Tree of if-then-else gates selecting one of 2^num_select_bits data inputs
+auto mux_tree(std::size_t num_select_bits, encoding enc) -> generated_circuit;
+
+// Odd-even merge sorting network constraining at least `min_true` of
+// `num_inputs` inputs to be true
+auto cardinality_network(std::size_t num_inputs, std::size_t min_true, encoding enc)
+    -> generated_circuit;
+
+// Random and-inverter graph in which each gate has the previously created
+// gate as an input, so all gates are reachable from the last one
+auto random_aig(std::size_t num_gates, std::size_t num_inputs, uint64_t seed, encoding enc)
+    -> generated_circuit;
+}
@@ -8,20 +8,18 @@
 namespace gatekit {
 namespace {
 
-auto create_gate(std::vector<Clause> const& fwd_clauses,
-                 std::vector<Clause> const& bwd_clauses,
-                 int output) -> gate<ClauseHandle>
+auto create_gate(gate_clauses const& clauses, int output) -> gate<ClauseHandle>
 {
   gate<ClauseHandle> result;
 
-  result.num_fwd_clauses = fwd_clauses.size();
+  result.num_fwd_clauses = clauses.fwd.size();
   result.output = output;
 
-  for (auto const& clause : fwd_clauses) {
+  for (auto const& clause : clauses.fwd) {
     result.clauses.emplace_back(std::make_shared<Clause>(clause));
   }
 
-  for (auto const& clause : bwd_clauses) {
+  for (auto const& clause : clauses.bwd) {
     result.clauses.emplace_back(std::make_shared<Clause>(clause));
   }
 
@@ -31,37 +29,66 @@ auto create_gate(std::vector<Clause> const& fwd_clauses,
 }
 }
 
-auto and_gate(std::vector<int> const& inputs, int output) -> gate<ClauseHandle>
+auto and_gate_clauses(std::vector<int> const& inputs, int output) -> gate_clauses
 {
-  std::vector<int> bwd_clause = {output};
-  std::vector<std::vector<int>> fwd_clauses;
+  gate_clauses result;
+  result.bwd.push_back({output});
 
   for (int input : inputs) {
-    bwd_clause.push_back(-input);
-    fwd_clauses.push_back({input, -output});
+    result.bwd.front().push_back(-input);
+    result.fwd.push_back({input, -output});
   }
 
-  return create_gate(fwd_clauses, {bwd_clause}, output);
+  return result;
 }
 
-auto or_gate(std::vector<int> const& inputs, int output) -> gate<ClauseHandle>
+auto or_gate_clauses(std::vector<int> const& inputs, int output) -> gate_clauses
 {
-  std::vector<int> fwd_clause = {-output};
-  std::vector<std::vector<int>> bwd_clauses;
+  gate_clauses result;
+  result.fwd.push_back({-output});
 
   for (int input : inputs) {
-    fwd_clause.push_back(input);
-    bwd_clauses.push_back({-input, output});
+    result.fwd.front().push_back(input);
+    result.bwd.push_back({-input, output});
   }
 
-  return create_gate({fwd_clause}, bwd_clauses, output);
+  return result;
+}
+
+auto xor_gate_clauses(int lhs, int rhs, int output) -> gate_clauses
+{
+  gate_clauses result;
+  result.fwd = {{-output, -lhs, -rhs}, {-output, lhs, rhs}};
+  result.bwd = {{output, -lhs, rhs}, {output, lhs, -rhs}};
+  return result;
+}
+
+auto ite_gate_clauses(int select, int then_lit, int else_lit, int output) -> gate_clauses
+{
+  gate_clauses result;
+  result.fwd = {{-output, -select, then_lit}, {-output, select, else_lit}};
+  result.bwd = {{output, -select, -then_lit}, {output, select, -else_lit}};
+  return result;
+}
+
+auto and_gate(std::vector<int> const& inputs, int output) -> gate<ClauseHandle>
+{
+  return create_gate(and_gate_clauses(inputs, output), output);
+}
+
+auto or_gate(std::vector<int> const& inputs, int output) -> gate<ClauseHandle>
+{
+  return create_gate(or_gate_clauses(inputs, output), output);
 }
 
 auto xor_gate(int lhs, int rhs, int output) -> gate<ClauseHandle>
 {
-  return create_gate({{-output, -lhs, -rhs}, {-output, lhs, rhs}},
-                     {{output, -lhs, rhs}, {output, lhs, -rhs}},
-                     output);
+  return create_gate(xor_gate_clauses(lhs, rhs, output), output);
+}
+
+auto ite_gate(int select, int then_lit, int else_lit, int output) -> gate<ClauseHandle>
+{
+  return create_gate(ite_gate_clauses(select, then_lit, else_lit, output), output);
 }
 
 auto monotonic(gate<ClauseHandle>&& gate, encoding encoding) -> ::gatekit::gate<ClauseHandle>
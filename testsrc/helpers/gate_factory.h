@@ -12,9 +12,22 @@ using ClauseList = std::vector<Clause>;
 
 enum class encoding { full, opt };
 
+// Clauses of a gate encoding, with `fwd` containing the negated output and
+// `bwd` containing the output
+struct gate_clauses {
+  ClauseList fwd;
+  ClauseList bwd;
+};
+
+auto and_gate_clauses(std::vector<int> const& inputs, int output) -> gate_clauses;
+auto or_gate_clauses(std::vector<int> const& inputs, int output) -> gate_clauses;
+auto xor_gate_clauses(int lhs, int rhs, int output) -> gate_clauses;
+auto ite_gate_clauses(int select, int then_lit, int else_lit, int output) -> gate_clauses;
+
 auto and_gate(std::vector<int> const& inputs, int output) -> gate<ClauseHandle>;
 auto or_gate(std::vector<int> const& inputs, int output) -> gate<ClauseHandle>;
 auto xor_gate(int lhs, int rhs, int output) -> gate<ClauseHandle>;
+auto ite_gate(int select, int then_lit, int else_lit, int output) -> gate<ClauseHandle>;
 
 auto monotonic(gate<ClauseHandle>&& gate, encoding encoding = encoding::opt)
     -> ::gatekit::gate<ClauseHandle>;
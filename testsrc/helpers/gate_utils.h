@@ -1,10 +1,13 @@
 #pragma once
 
+#include "gate_factory.h"
+
 #include <gatekit/detail/clause_utils.h>
 #include <gatekit/detail/scanner_structure.h>
 #include <gatekit/gate.h>
 
 #include <algorithm>
+#include <ostream>
 #include <vector>
 
 namespace gatekit {
@@ -41,4 +44,67 @@ auto with_flipped_output_sign(gate<ClauseHandle> const& to_flip) -> gate<ClauseH
 
   return result;
 }
+
+template <typename ClauseHandle>
+auto operator==(gate<ClauseHandle> const& lhs, gate<ClauseHandle> const& rhs) -> bool
+{
+  if (&lhs == &rhs) {
+    return true;
+  }
+
+  if (!lhs.is_nested_monotonically && !rhs.is_nested_monotonically &&
+      lhs.output == detail::negate(rhs.output)) {
+    return with_flipped_output_sign(lhs) == rhs;
+  }
+
+  if (lhs.output != rhs.output || lhs.num_fwd_clauses != rhs.num_fwd_clauses ||
+      lhs.is_nested_monotonically != rhs.is_nested_monotonically) {
+    return false;
+  }
+
+  if (lhs.inputs.size() != rhs.inputs.size() || lhs.clauses.size() != rhs.clauses.size()) {
+    return false;
+  }
+
+  if (!std::is_permutation(lhs.inputs.begin(), lhs.inputs.end(), rhs.inputs.begin())) {
+    return false;
+  }
+
+  if (!std::is_permutation(lhs.clauses.begin(), lhs.clauses.end(), rhs.clauses.begin())) {
+    return false;
+  }
+
+  return true;
+}
+
+template <typename ClauseHandle>
+auto operator==(gate_structure<ClauseHandle> const& lhs, gate_structure<ClauseHandle> const& rhs)
+    -> bool
+{
+  if (&lhs == &rhs) {
+    return true;
+  }
+
+  if (lhs.roots.size() != rhs.roots.size() || lhs.gates.size() != rhs.gates.size()) {
+    return false;
+  }
+
+  if (!std::is_permutation(lhs.roots.begin(), lhs.roots.end(), rhs.roots.begin())) {
+    return false;
+  }
+
+  if (!std::is_permutation(lhs.gates.begin(), lhs.gates.end(), rhs.gates.begin())) {
+    return false;
+  }
+
+  return true;
+}
+
+
+template <typename ClauseHandle>
+auto operator<<(std::ostream& stream, gate_structure<ClauseHandle> const& to_dump) -> std::ostream&
+{
+  stream << to_string(to_dump);
+  return stream;
+}
 }
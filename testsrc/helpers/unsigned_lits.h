@@ -0,0 +1,14 @@
+#pragma once
+
+#include <gatekit/clause.h>
+
+#include <cstdint>
+
+namespace gatekit {
+
+// Tests using unsigned literals use 2*v + sign literals. This specialization
+// needs to be included wherever uint32_t literals are used.
+template <>
+struct lit_traits<uint32_t> : unsigned_lit_traits<uint32_t> {
+};
+}
@@ -0,0 +1,337 @@
+#include <gatekit/incremental_scanner.h>
+#include <gatekit/scanner.h>
+
+#include "helpers/gate_factory.h"
+#include "helpers/gate_utils.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+
+using ::testing::Eq;
+using ::testing::IsEmpty;
+
+namespace gatekit {
+
+namespace {
+class incremental_scanner_tests : public ::testing::Test {
+public:
+  void add_gate(gate<ClauseHandle> const& gate)
+  {
+    m_clauses.insert(m_clauses.end(), gate.clauses.begin(), gate.clauses.end());
+  }
+
+  auto add_clause(Clause const& clause) -> ClauseHandle
+  {
+    m_clauses.emplace_back(std::make_shared<Clause>(clause));
+    return m_clauses.back();
+  }
+
+  void remove_clause(ClauseHandle const& clause)
+  {
+    m_clauses.erase(std::find(m_clauses.begin(), m_clauses.end(), clause));
+  }
+
+  auto clauses() const -> std::vector<ClauseHandle> const& { return m_clauses; }
+
+  auto scan_from_scratch() const -> gate_structure<ClauseHandle>
+  {
+    return scan_gates<ClauseHandle>(m_clauses.begin(), m_clauses.end());
+  }
+
+private:
+  std::vector<ClauseHandle> m_clauses;
+};
+
+auto is_reverse_topologically_ordered(gate_structure<ClauseHandle> const& structure) -> bool
+{
+  std::vector<gate<ClauseHandle>> const& gates = structure.gates;
+
+  for (std::size_t idx = 0; idx < gates.size(); ++idx) {
+    for (std::size_t later = idx + 1; later < gates.size(); ++later) {
+      for (int input : gates[later].inputs) {
+        if (std::abs(input) == std::abs(gates[idx].output)) {
+          return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Checks the properties of `structure` that don't depend on the order in which
+ * the scanner finds the gates: gate and root clauses are clauses of the problem
+ * instance, no clause belongs to two gates, and the variables of gate outputs
+ * only occur in gate clauses and unary clauses.
+ */
+auto is_consistent(gate_structure<ClauseHandle> const& structure,
+                   std::vector<ClauseHandle> const& clauses) -> bool
+{
+  auto const is_clause = [&clauses](ClauseHandle const& clause) -> bool {
+    return std::find(clauses.begin(), clauses.end(), clause) != clauses.end();
+  };
+
+  std::set<ClauseHandle> gate_clauses;
+  for (gate<ClauseHandle> const& gate : structure.gates) {
+    for (ClauseHandle const& clause : gate.clauses) {
+      if (!is_clause(clause) || !gate_clauses.insert(clause).second) {
+        return false;
+      }
+    }
+  }
+
+  for (std::vector<int> const& root : structure.roots) {
+    bool const has_unary =
+        std::any_of(clauses.begin(), clauses.end(), [&root](ClauseHandle const& clause) {
+          return *clause == Clause{root.front()};
+        });
+    if (root.size() != 1 || !has_unary) {
+      return false;
+    }
+  }
+
+  for (gate<ClauseHandle> const& gate : structure.gates) {
+    int const output_var = std::abs(gate.output);
+
+    for (ClauseHandle const& clause : clauses) {
+      bool const has_output = std::any_of(clause->begin(), clause->end(), [output_var](int lit) {
+        return std::abs(lit) == output_var;
+      });
+      if (!has_output || clause->size() == 1) {
+        continue;
+      }
+
+      if (gate_clauses.count(clause) == 0) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+}
+
+TEST_F(incremental_scanner_tests, initial_structure_matches_scan_gates)
+{
+  add_gate(monotonic(or_gate({-21, 22, 23}, 10), encoding::full));
+  add_gate(monotonic(and_gate({31, -32}, 22)));
+  add_gate(monotonic(xor_gate(41, 42, 23)));
+  add_gate(and_gate({51, 52}, 42));
+  add_clause({10});
+
+  incremental_scanner<ClauseHandle> under_test{clauses().begin(), clauses().end()};
+
+  EXPECT_THAT(under_test.get_gate_structure(), Eq(scan_from_scratch()));
+}
+
+TEST_F(incremental_scanner_tests, adding_root_creates_gates)
+{
+  add_gate(and_gate({2, 3}, 1));
+  add_gate(and_gate({4, 5}, 2));
+
+  incremental_scanner<ClauseHandle> under_test{clauses().begin(), clauses().end()};
+  EXPECT_THAT(under_test.get_gate_structure().gates, IsEmpty());
+
+  under_test.add_clause(add_clause({1}));
+
+  gate_structure<ClauseHandle> const& result = under_test.get_gate_structure();
+  EXPECT_THAT(result.gates.size(), Eq(2));
+  EXPECT_THAT(result, Eq(scan_from_scratch()));
+}
+
+TEST_F(incremental_scanner_tests, removing_root_removes_gates)
+{
+  add_gate(and_gate({2, 3}, 1));
+  ClauseHandle const root = add_clause({1});
+
+  incremental_scanner<ClauseHandle> under_test{clauses().begin(), clauses().end()};
+  EXPECT_THAT(under_test.get_gate_structure().gates.size(), Eq(1));
+
+  under_test.remove_clause(root);
+  remove_clause(root);
+
+  EXPECT_THAT(under_test.get_gate_structure().gates, IsEmpty());
+  EXPECT_THAT(under_test.get_gate_structure().roots, IsEmpty());
+}
+
+TEST_F(incremental_scanner_tests, removing_gate_clause_removes_nested_gates)
+{
+  // Removing the clause (2, -1) from the AND gate leaves the gate 1 <-> 3,
+  // so 2 is not a gate input anymore
+  gate<ClauseHandle> const outer = and_gate({2, 3}, 1);
+  add_gate(outer);
+  add_gate(and_gate({4, 5}, 2));
+  add_clause({1});
+
+  incremental_scanner<ClauseHandle> under_test{clauses().begin(), clauses().end()};
+  EXPECT_THAT(under_test.get_gate_structure().gates.size(), Eq(2));
+
+  under_test.remove_clause(outer.clauses.front());
+  remove_clause(outer.clauses.front());
+
+  gate_structure<ClauseHandle> const& result = under_test.get_gate_structure();
+  EXPECT_THAT(result.gates.size(), Eq(1));
+  EXPECT_THAT(result, Eq(scan_from_scratch()));
+}
+
+TEST_F(incremental_scanner_tests, adding_clause_with_gate_output_removes_gate)
+{
+  add_gate(and_gate({2, 3}, 1));
+  add_gate(and_gate({4, 5}, 2));
+  add_clause({1});
+
+  incremental_scanner<ClauseHandle> under_test{clauses().begin(), clauses().end()};
+  EXPECT_THAT(under_test.get_gate_structure().gates.size(), Eq(2));
+
+  under_test.add_clause(add_clause({-2, 6}));
+
+  gate_structure<ClauseHandle> const& result = under_test.get_gate_structure();
+  EXPECT_THAT(result.gates.size(), Eq(1));
+  EXPECT_THAT(result, Eq(scan_from_scratch()));
+}
+
+TEST_F(incremental_scanner_tests, removing_blocking_clause_reveals_nested_gate)
+{
+  add_gate(and_gate({2, 3}, 1));
+  add_gate(and_gate({4, 5}, 2));
+  add_clause({1});
+  ClauseHandle const blocking = add_clause({-2, 6});
+
+  incremental_scanner<ClauseHandle> under_test{clauses().begin(), clauses().end()};
+  EXPECT_THAT(under_test.get_gate_structure().gates.size(), Eq(1));
+
+  under_test.remove_clause(blocking);
+  remove_clause(blocking);
+
+  gate_structure<ClauseHandle> const& result = under_test.get_gate_structure();
+  EXPECT_THAT(result.gates.size(), Eq(2));
+  EXPECT_THAT(result, Eq(scan_from_scratch()));
+}
+
+TEST_F(incremental_scanner_tests, rescanned_cones_keep_reverse_topological_order)
+{
+  // The gate for 10 is found in the cone of root 2. Changing the cone of
+  // root 1 causes its gates to be scanned again, after the gate for 10.
+  add_gate(and_gate({10, 3}, 1));
+  add_gate(or_gate({10, 4}, 2));
+  add_gate(and_gate({11, 12}, 10));
+  add_gate(and_gate({20, 21}, 3));
+  ClauseHandle const root = add_clause({1});
+  add_clause({2});
+
+  incremental_scanner<ClauseHandle> under_test{clauses().begin(), clauses().end()};
+  EXPECT_TRUE(is_reverse_topologically_ordered(under_test.get_gate_structure()));
+
+  under_test.remove_clause(root);
+  under_test.add_clause(add_clause({1}));
+  remove_clause(root);
+
+  gate_structure<ClauseHandle> const& result = under_test.get_gate_structure();
+  EXPECT_THAT(result, Eq(scan_from_scratch()));
+  EXPECT_TRUE(is_reverse_topologically_ordered(result));
+}
+
+TEST_F(incremental_scanner_tests, nested_monotonicity_is_updated_when_users_are_removed)
+{
+  // 2 is used in both polarities by the XOR gate and positively by the AND
+  // gate for 6. After the gate for 2 has been found in its own cone, the XOR
+  // gate is removed, leaving 2 nested monotonically.
+  gate<ClauseHandle> const xor_user = xor_gate(2, 3, 1);
+  add_gate(xor_user);
+  add_gate(and_gate({2, 7}, 6));
+  ClauseHandle const root = add_clause({1});
+  add_clause({6});
+
+  incremental_scanner<ClauseHandle> under_test{clauses().begin(), clauses().end()};
+
+  for (ClauseHandle const& clause : and_gate({4, 5}, 2).clauses) {
+    under_test.add_clause(add_clause(*clause));
+  }
+
+  gate_structure<ClauseHandle> const& before_removal = under_test.get_gate_structure();
+  ASSERT_THAT(before_removal.gates.size(), Eq(3));
+  EXPECT_FALSE(before_removal.gates.back().is_nested_monotonically);
+
+  under_test.remove_clause(root);
+  remove_clause(root);
+  for (ClauseHandle const& clause : xor_user.clauses) {
+    under_test.remove_clause(clause);
+    remove_clause(clause);
+  }
+
+  gate_structure<ClauseHandle> const& result = under_test.get_gate_structure();
+  ASSERT_THAT(result.gates.size(), Eq(2));
+  EXPECT_TRUE(result.gates.back().is_nested_monotonically);
+  EXPECT_THAT(result, Eq(scan_from_scratch()));
+}
+
+TEST_F(incremental_scanner_tests, random_updates_keep_gate_structure_consistent)
+{
+  // Random circuit with gates 1 to 30 having inputs with greater indices
+  std::mt19937 rng{1};
+  std::uniform_int_distribution<int> kind_dist{0, 2};
+
+  for (int output = 1; output <= 30; ++output) {
+    std::uniform_int_distribution<int> input_dist{output + 1, 45};
+    int const lhs = input_dist(rng);
+    int rhs = input_dist(rng);
+    while (rhs == lhs) {
+      rhs = input_dist(rng);
+    }
+
+    switch (kind_dist(rng)) {
+    case 0:
+      add_gate(and_gate({lhs, -rhs}, output));
+      break;
+    case 1:
+      add_gate(or_gate({lhs, rhs}, output));
+      break;
+    default:
+      add_gate(xor_gate(lhs, rhs, output));
+    }
+  }
+
+  for (int root : {1, 2, 3, -5, 8}) {
+    add_clause({root});
+  }
+
+  incremental_scanner<ClauseHandle> under_test{clauses().begin(), clauses().end()};
+  ASSERT_THAT(under_test.get_gate_structure(), Eq(scan_from_scratch()));
+
+  std::vector<Clause> removed;
+  std::bernoulli_distribution remove_dist{0.5};
+
+  for (int step = 0; step < 300; ++step) {
+    if (removed.empty() || (remove_dist(rng) && !clauses().empty())) {
+      std::uniform_int_distribution<std::size_t> clause_dist{0, clauses().size() - 1};
+      ClauseHandle const clause = clauses()[clause_dist(rng)];
+      removed.push_back(*clause);
+      under_test.remove_clause(clause);
+      remove_clause(clause);
+    }
+    else {
+      std::uniform_int_distribution<std::size_t> clause_dist{0, removed.size() - 1};
+      std::size_t const idx = clause_dist(rng);
+      under_test.add_clause(add_clause(removed[idx]));
+      removed.erase(removed.begin() + idx);
+    }
+
+    // The result is not compared to scan_gates() here, since the gates found
+    // by scan_gates() depend on the order of the unary clauses
+    if (step % 3 == 0) {
+      gate_structure<ClauseHandle> const& result = under_test.get_gate_structure();
+      ASSERT_TRUE(is_consistent(result, clauses())) << "step " << step;
+      ASSERT_TRUE(is_reverse_topologically_ordered(result)) << "step " << step;
+    }
+  }
+}
+}
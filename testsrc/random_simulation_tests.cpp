@@ -1,14 +1,20 @@
 #include <gatekit/random_simulation.h>
 
+#include <gatekit/clause_arena.h>
 #include <gatekit/detail/utils.h>
+#include <gatekit/flat_gate_structure.h>
 #include <gatekit/gate.h>
+#include <gatekit/scanner.h>
 
+#include "helpers/circuit_generator.h"
 #include "helpers/gate_factory.h"
 #include "helpers/gate_utils.h"
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <cstdint>
+#include <limits>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -79,10 +85,170 @@ TEST_P(random_simulation_tests, suite)
   lit_partitioning<int> const& expected = std::get<2>(GetParam());
 
   lit_partitioning<int> result = random_simulation(input, 5000);
+  EXPECT_THAT(result, is_equivalent_partitioning(expected));
+
+  lit_partitioning<int> flat_result = random_simulation(flatten(input), 5000);
+  EXPECT_THAT(flat_result, is_equivalent_partitioning(expected));
+
+  lit_partitioning<int> parallel_result = random_simulation_parallel(input, 5000, 2);
+  EXPECT_THAT(parallel_result, is_equivalent_partitioning(expected));
+
+  lit_partitioning<int> narrow_result = random_simulation<512>(input, 5000);
+  EXPECT_THAT(narrow_result, is_equivalent_partitioning(expected));
+
+  lit_partitioning<int> wide_result = random_simulation<4096>(flatten(input), 5000);
+  EXPECT_THAT(wide_result, is_equivalent_partitioning(expected));
+}
+
+TEST(random_simulation_parallel_tests, result_is_same_as_for_sequential_simulation)
+{
+  clause_arena const clauses = multiplier_miter(16, encoding::full).clauses;
+  gate_structure<arena_clause> const structure =
+      scan_gates<arena_clause>(clauses.begin(), clauses.end());
+
+  lit_partitioning<int> const expected = random_simulation(structure, 4096);
+
+  for (std::size_t num_threads : {2, 4}) {
+    lit_partitioning<int> const result = random_simulation_parallel(structure, 4096, num_threads);
+    EXPECT_THAT(result.backbones, ::testing::Eq(expected.backbones));
+    EXPECT_THAT(result.equivalences, ::testing::Eq(expected.equivalences));
+
+    lit_partitioning<int> const flat_result =
+        random_simulation_parallel(flatten(structure), 4096, num_threads);
+    EXPECT_THAT(flat_result.backbones, ::testing::Eq(expected.backbones));
+    EXPECT_THAT(flat_result.equivalences, ::testing::Eq(expected.equivalences));
+  }
+}
+
+TEST(random_simulation_convergence_tests, simulation_stops_when_partitioning_has_converged)
+{
+  gate_structure<ClauseHandle> const structure = to_structure<ClauseHandle>(
+      {and_gate({1, 2}, 3), and_gate({1, 2}, 4), or_gate({-1, -2}, 5)}, {{3, 4, 5}});
+
+  // Simulating all rounds would not finish in reasonable time
+  uint64_t const max_num_rounds = std::numeric_limits<uint64_t>::max() / 2;
+
+  lit_partitioning<int> const result = random_simulation(structure, max_num_rounds, 28);
+  EXPECT_THAT(result, is_equivalent_partitioning(lit_partitioning<int>{{}, {{3, 4, -5}}}));
+
+  lit_partitioning<int> const parallel_result =
+      random_simulation_parallel(structure, max_num_rounds, 2, 28);
+  EXPECT_THAT(parallel_result,
+              is_equivalent_partitioning(lit_partitioning<int>{{}, {{3, 4, -5}}}));
+}
+
+namespace {
+// Gates 1 and 3 are equivalent, while gate 2 differs from them only if
+// inputs 10 to 21 are true and inputs 30 and 40 are false. Simulating
+// uniformly random patterns hardly ever tells gate 2 apart.
+auto get_rarely_distinguished_gates() -> gate_structure<ClauseHandle>
+{
+  std::vector<int> and_inputs;
+  for (int input = 10; input < 22; ++input) {
+    and_inputs.push_back(input);
+  }
+  std::vector<int> and_inputs_with_30 = and_inputs;
+  and_inputs_with_30.push_back(30);
+
+  return to_structure<ClauseHandle>({or_gate({40, 5}, 1),
+                                     or_gate({40, 6}, 2),
+                                     or_gate({40, 7}, 3),
+                                     and_gate(and_inputs, 5),
+                                     and_gate(and_inputs_with_30, 6),
+                                     and_gate(and_inputs, 7)},
+                                    {{1, 2, 3}});
+}
+}
+
+TEST(random_simulation_refinement_tests, refinement_splits_rarely_distinguished_candidates)
+{
+  gate_structure<ClauseHandle> const structure = get_rarely_distinguished_gates();
 
+  lit_partitioning<int> const unrefined = random_simulation<512>(structure, 512);
+  ASSERT_THAT(unrefined.equivalences,
+              ::testing::Contains(::testing::UnorderedElementsAre(1, 2, 3, 40)));
+
+  lit_partitioning<int> const result =
+      random_simulation<512>(structure, 512, refinement_options<int>{});
+  EXPECT_THAT(result, is_equivalent_partitioning(lit_partitioning<int>{{}, {{1, 3}, {5, 7}}}));
+
+  lit_partitioning<int> const flat_result =
+      random_simulation<512>(flatten(structure), 512, refinement_options<int>{});
+  EXPECT_THAT(flat_result, is_equivalent_partitioning(result));
+}
+
+TEST(random_simulation_refinement_tests, refinement_keeps_true_equivalences)
+{
+  clause_arena const clauses = multiplier_miter(8, encoding::full).clauses;
+  gate_structure<arena_clause> const structure =
+      scan_gates<arena_clause>(clauses.begin(), clauses.end());
+
+  lit_partitioning<int> const expected = random_simulation(structure, 1 << 16);
+  lit_partitioning<int> const result = random_simulation(structure, 1, refinement_options<int>{});
   EXPECT_THAT(result, is_equivalent_partitioning(expected));
 }
 
+TEST(random_simulation_refinement_tests, patterns_are_replayed)
+{
+  gate_structure<ClauseHandle> const structure = get_rarely_distinguished_gates();
+
+  simulation_patterns<int> patterns;
+  patterns.patterns.push_back({10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, -30, -40});
+
+  refinement_options<int> options;
+  options.max_num_rounds = 1;
+  options.patterns = &patterns;
+
+  lit_partitioning<int> const result = random_simulation<512>(structure, 512, options);
+  // The pattern tells gate 2 apart from gates 1 and 3, but not from input 40
+  EXPECT_THAT(result.equivalences, ::testing::Contains(::testing::UnorderedElementsAre(1, 3)));
+  EXPECT_THAT(result.equivalences, ::testing::Contains(::testing::UnorderedElementsAre(2, 40)));
+  EXPECT_THAT(patterns.patterns.size(), ::testing::Eq(1));
+}
+
+TEST(random_simulation_refinement_tests, distinguishing_patterns_are_recorded)
+{
+  gate_structure<ClauseHandle> const structure = get_rarely_distinguished_gates();
+
+  simulation_patterns<int> patterns;
+  refinement_options<int> options;
+  options.patterns = &patterns;
+
+  lit_partitioning<int> const refined = random_simulation<512>(structure, 512, options);
+  ASSERT_THAT(patterns.patterns, ::testing::Not(::testing::IsEmpty()));
+
+  // Replaying the recorded patterns yields the same partitioning, without
+  // needing any targeted rounds
+  refinement_options<int> replay_options;
+  replay_options.max_num_rounds = 1;
+  replay_options.patterns = &patterns;
+
+  lit_partitioning<int> const result = random_simulation<512>(structure, 512, replay_options);
+  EXPECT_THAT(result, is_equivalent_partitioning(refined));
+}
+
+TEST(random_simulation_refinement_tests, oldest_patterns_are_dropped_when_exceeding_limit)
+{
+  gate_structure<ClauseHandle> const structure = get_rarely_distinguished_gates();
+
+  // Patterns of a variable not occurring in the structure, which don't
+  // split any class
+  std::vector<int> const old_pattern = {99};
+  simulation_patterns<int> patterns;
+  patterns.patterns.assign(10, old_pattern);
+
+  refinement_options<int> options;
+  options.patterns = &patterns;
+  options.max_num_patterns = 2;
+
+  lit_partitioning<int> const result = random_simulation<512>(structure, 512, options);
+  EXPECT_THAT(result, is_equivalent_partitioning(lit_partitioning<int>{{}, {{1, 3}, {5, 7}}}));
+
+  EXPECT_THAT(patterns.patterns, ::testing::SizeIs(::testing::Le(2)));
+  EXPECT_THAT(patterns.patterns, ::testing::Not(::testing::IsEmpty()));
+  EXPECT_THAT(patterns.patterns, ::testing::Each(::testing::Ne(old_pattern)));
+}
+
 // clang-format off
 INSTANTIATE_TEST_SUITE_P(random_simulation_tests, random_simulation_tests,
   ::testing::Values(
@@ -100,7 +266,14 @@ INSTANTIATE_TEST_SUITE_P(random_simulation_tests, random_simulation_tests,
             and_gate({100, 200}, 10),
             or_gate({-100, -200}, 20)},
         {{1}}),
-    lit_partitioning<int>{{-1}, {{10, -20}}})
+    lit_partitioning<int>{{-1}, {{10, -20}}}),
+    std::make_tuple("sparse variables are mapped back to original variables",
+      to_structure<ClauseHandle>({
+          and_gate({1000000, -2000000}, 3000000),
+          and_gate({1000000, -2000000}, 4000000),
+          or_gate({-1000000, 2000000}, 5000000)},
+        {{3000000, 4000000, 5000000}}),
+      lit_partitioning<int>{{}, {{3000000, 4000000, -5000000}}})
 ));
 // clang-format on
 }
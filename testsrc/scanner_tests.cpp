@@ -1,12 +1,21 @@
 #include <gatekit/scanner.h>
 
+#include "helpers/circuit_generator.h"
 #include "helpers/gate_factory.h"
 #include "helpers/gate_utils.h"
+#include "helpers/unsigned_lits.h"
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <limits>
 #include <memory>
 #include <ostream>
 #include <string>
@@ -16,70 +25,6 @@
 namespace gatekit {
 using GateList = std::vector<gate<ClauseHandle>>;
 
-template <typename C>
-std::string to_string(gate<C> const& gate);
-
-auto operator==(gate<ClauseHandle> const& lhs, gate<ClauseHandle> const& rhs) -> bool
-{
-  if (&lhs == &rhs) {
-    return true;
-  }
-
-  if (!lhs.is_nested_monotonically && !rhs.is_nested_monotonically &&
-      lhs.output == detail::negate(rhs.output)) {
-    return with_flipped_output_sign(lhs) == rhs;
-  }
-
-  if (lhs.output != rhs.output || lhs.num_fwd_clauses != rhs.num_fwd_clauses ||
-      lhs.is_nested_monotonically != rhs.is_nested_monotonically) {
-    return false;
-  }
-
-  if (lhs.inputs.size() != rhs.inputs.size() || lhs.clauses.size() != rhs.clauses.size()) {
-    return false;
-  }
-
-  if (!std::is_permutation(lhs.inputs.begin(), lhs.inputs.end(), rhs.inputs.begin())) {
-    return false;
-  }
-
-  if (!std::is_permutation(lhs.clauses.begin(), lhs.clauses.end(), rhs.clauses.begin())) {
-    return false;
-  }
-
-  return true;
-}
-
-auto operator==(gate_structure<ClauseHandle> const& lhs, gate_structure<ClauseHandle> const& rhs)
-    -> bool
-{
-  if (&lhs == &rhs) {
-    return true;
-  }
-
-  if (lhs.roots.size() != rhs.roots.size() || lhs.gates.size() != rhs.gates.size()) {
-    return false;
-  }
-
-  if (!std::is_permutation(lhs.roots.begin(), lhs.roots.end(), rhs.roots.begin())) {
-    return false;
-  }
-
-  if (!std::is_permutation(lhs.gates.begin(), lhs.gates.end(), rhs.gates.begin())) {
-    return false;
-  }
-
-  return true;
-}
-
-
-auto operator<<(std::ostream& stream, gate_structure<ClauseHandle> const& to_dump) -> std::ostream&
-{
-  stream << to_string(to_dump);
-  return stream;
-}
-
-
 using scanner_test_param = std::tuple<
     std::string,                  // Description
     gate_structure<ClauseHandle>, // Test input. Clauses used as scanner input and expected output.
@@ -129,6 +74,51 @@ TEST_P(scanner_tests, suite)
   EXPECT_THAT(actual, ::testing::Eq(expected));
 }
 
+TEST_P(scanner_tests, compressed_occurrence_list_suite)
+{
+  auto const& input_clauses = create_clauses();
+
+  gate_structure<ClauseHandle> actual = scan_gates<ClauseHandle>(
+      input_clauses.begin(), input_clauses.end(), occurrence_list_layout::compressed);
+  gate_structure<ClauseHandle> const& expected = get_expected_gate_structure();
+
+  EXPECT_THAT(actual, ::testing::Eq(expected));
+}
+
+TEST_P(scanner_tests, suite_with_options)
+{
+  auto const& input_clauses = create_clauses();
+
+  scan_result<ClauseHandle> actual =
+      scan_gates<ClauseHandle>(input_clauses.begin(), input_clauses.end(), scan_options{});
+  gate_structure<ClauseHandle> const& expected = get_expected_gate_structure();
+
+  EXPECT_TRUE(actual.is_finished);
+  EXPECT_THAT(actual.structure, ::testing::Eq(expected));
+}
+
+TEST_P(scanner_tests, flat_suite)
+{
+  auto const& input_clauses = create_clauses();
+
+  flat_gate_structure<ClauseHandle> const actual =
+      scan_gates_flat<ClauseHandle>(input_clauses.begin(), input_clauses.end());
+  gate_structure<ClauseHandle> const& expected = get_expected_gate_structure();
+
+  EXPECT_THAT(to_gate_structure(actual), ::testing::Eq(expected));
+}
+
+TEST_P(scanner_tests, parallel_suite)
+{
+  auto const& input_clauses = create_clauses();
+
+  gate_structure<ClauseHandle> actual =
+      scan_gates_parallel<ClauseHandle>(input_clauses.begin(), input_clauses.end(), 3);
+  gate_structure<ClauseHandle> const& expected = get_expected_gate_structure();
+
+  EXPECT_THAT(actual, ::testing::Eq(expected));
+}
+
 // clang-format off
 INSTANTIATE_TEST_SUITE_P(scanner_tests, scanner_tests,
   ::testing::Values(
@@ -184,4 +174,469 @@ INSTANTIATE_TEST_SUITE_P(scanner_tests, scanner_tests,
       ClauseList{})
 ));
 // clang-format on
+
+TEST(scanner_parallel_tests, result_order_is_independent_of_thread_count)
+{
+  GateList const gates = {and_gate({2, 3}, 1),
+                          xor_gate(11, 12, 10),
+                          and_gate({21, 22}, 20),
+                          or_gate({31, 32}, 30),
+                          and_gate({12, 13}, 11)};
+
+  std::vector<ClauseHandle> input_clauses;
+  for (gate<ClauseHandle> const& gate : gates) {
+    input_clauses.insert(input_clauses.end(), gate.clauses.begin(), gate.clauses.end());
+  }
+
+  for (int root : {30, 1, 20, 10}) {
+    input_clauses.emplace_back(std::make_shared<Clause>(Clause{root}));
+  }
+
+  gate_structure<ClauseHandle> const single_threaded =
+      scan_gates_parallel<ClauseHandle>(input_clauses.begin(), input_clauses.end(), 1);
+
+  ASSERT_THAT(single_threaded.gates.size(), ::testing::Eq(5));
+  EXPECT_THAT(single_threaded.roots,
+              ::testing::ElementsAre(std::vector<int>{1},
+                                     std::vector<int>{10},
+                                     std::vector<int>{20},
+                                     std::vector<int>{30}));
+
+  // Within a component, the gates are ordered reverse-topologically: each gate
+  // precedes the gates defining its inputs, so the XOR gate 10 precedes the
+  // AND gate defining its input 11
+  EXPECT_THAT(single_threaded.gates[1].output, ::testing::Eq(10));
+  EXPECT_THAT(std::abs(single_threaded.gates[2].output), ::testing::Eq(11));
+
+  for (std::size_t num_threads : {2, 3, 4, 8}) {
+    gate_structure<ClauseHandle> const multi_threaded = scan_gates_parallel<ClauseHandle>(
+        input_clauses.begin(), input_clauses.end(), num_threads);
+
+    ASSERT_THAT(multi_threaded.roots, ::testing::Eq(single_threaded.roots));
+    ASSERT_THAT(multi_threaded.gates.size(), ::testing::Eq(single_threaded.gates.size()));
+
+    for (std::size_t idx = 0; idx < multi_threaded.gates.size(); ++idx) {
+      EXPECT_THAT(multi_threaded.gates[idx], ::testing::Eq(single_threaded.gates[idx]));
+    }
+  }
+}
+
+namespace {
+// Two variable-disjoint miter-like structures without unary clauses
+auto create_disjoint_miters(GateList& gates) -> std::vector<ClauseHandle>
+{
+  std::vector<ClauseHandle> result;
+
+  for (int offset : {0, 10}) {
+    gates.push_back(monotonic(and_gate({offset + 3, offset + 4}, offset + 1), encoding::full));
+    gates.push_back(monotonic(and_gate({offset + 5, offset + 6}, offset + 2), encoding::full));
+    for (std::size_t idx = gates.size() - 2; idx < gates.size(); ++idx) {
+      result.insert(result.end(), gates[idx].clauses.begin(), gates[idx].clauses.end());
+    }
+    result.emplace_back(std::make_shared<Clause>(Clause{offset + 1, offset + 2}));
+  }
+
+  return result;
+}
+}
+
+TEST(scanner_parallel_tests, options_are_applied)
+{
+  GateList gates;
+  std::vector<ClauseHandle> const input_clauses = create_disjoint_miters(gates);
+
+  for (occurrence_list_layout layout :
+       {occurrence_list_layout::per_literal, occurrence_list_layout::compressed}) {
+    scan_stats sequential_stats;
+    scan_options options;
+    options.layout = layout;
+    options.roots = root_selection::unaries_and_clauses;
+    options.stats = &sequential_stats;
+
+    scan_result<ClauseHandle> const sequential =
+        scan_gates<ClauseHandle>(input_clauses.begin(), input_clauses.end(), options);
+
+    scan_stats parallel_stats;
+    options.stats = &parallel_stats;
+
+    scan_result<ClauseHandle> const parallel =
+        scan_gates_parallel<ClauseHandle>(input_clauses.begin(), input_clauses.end(), options, 2);
+
+    EXPECT_TRUE(parallel.is_finished);
+    EXPECT_THAT(parallel.structure.roots,
+                ::testing::ElementsAre(std::vector<int>{1, 2}, std::vector<int>{11, 12}));
+    EXPECT_THAT(parallel.structure.gates, ::testing::UnorderedElementsAreArray(gates));
+    EXPECT_THAT(parallel.structure.gates,
+                ::testing::UnorderedElementsAreArray(sequential.structure.gates));
+
+    EXPECT_THAT(parallel_stats.num_try_get_gate_calls,
+                ::testing::Eq(sequential_stats.num_try_get_gate_calls));
+    EXPECT_THAT(parallel_stats.num_bfs_rounds_per_root.size(),
+                ::testing::Eq(sequential_stats.num_bfs_rounds_per_root.size()));
+  }
+}
+
+TEST(scanner_parallel_tests, budget_is_shared_by_threads)
+{
+  GateList gates;
+  std::vector<ClauseHandle> const input_clauses = create_disjoint_miters(gates);
+
+  scan_options options;
+  options.roots = root_selection::unaries_and_clauses;
+  options.max_steps = 0;
+
+  scan_result<ClauseHandle> const no_steps =
+      scan_gates_parallel<ClauseHandle>(input_clauses.begin(), input_clauses.end(), options, 2);
+  EXPECT_FALSE(no_steps.is_finished);
+  EXPECT_TRUE(no_steps.structure.gates.empty());
+  EXPECT_TRUE(no_steps.structure.roots.empty());
+
+  // Each component needs 7 steps for checking its root candidates
+  options.max_steps = 13;
+  scan_result<ClauseHandle> const too_few_steps =
+      scan_gates_parallel<ClauseHandle>(input_clauses.begin(), input_clauses.end(), options, 2);
+  EXPECT_FALSE(too_few_steps.is_finished);
+  EXPECT_THAT(too_few_steps.structure.roots.size(), ::testing::Lt(2));
+
+  options.max_steps = 1000;
+  scan_result<ClauseHandle> const enough_steps =
+      scan_gates_parallel<ClauseHandle>(input_clauses.begin(), input_clauses.end(), options, 2);
+  EXPECT_TRUE(enough_steps.is_finished);
+  EXPECT_THAT(enough_steps.structure.gates.size(), ::testing::Eq(4));
+
+  options.max_steps = std::numeric_limits<uint64_t>::max();
+  options.is_cancelled = []() { return true; };
+  scan_result<ClauseHandle> const cancelled =
+      scan_gates_parallel<ClauseHandle>(input_clauses.begin(), input_clauses.end(), options, 2);
+  EXPECT_FALSE(cancelled.is_finished);
+  EXPECT_TRUE(cancelled.structure.gates.empty());
+}
+namespace {
+auto create_and_gate_chain(int length) -> std::vector<ClauseHandle>
+{
+  std::vector<ClauseHandle> result;
+  for (int output = 1; output <= length; ++output) {
+    gate<ClauseHandle> const chain_gate = and_gate({output + 1, 1000 + output}, output);
+    result.insert(result.end(), chain_gate.clauses.begin(), chain_gate.clauses.end());
+  }
+  result.emplace_back(std::make_shared<Clause>(Clause{1}));
+  return result;
+}
+}
+
+TEST(scanner_budget_tests, scan_with_sufficient_budget_is_finished)
+{
+  std::vector<ClauseHandle> const input_clauses = create_and_gate_chain(10);
+
+  scan_options options;
+  options.max_steps = 1000;
+  options.deadline = std::chrono::steady_clock::now() + std::chrono::hours{1};
+  options.is_cancelled = []() { return false; };
+
+  scan_result<ClauseHandle> const result =
+      scan_gates<ClauseHandle>(input_clauses.begin(), input_clauses.end(), options);
+
+  EXPECT_TRUE(result.is_finished);
+  EXPECT_THAT(result.structure.gates.size(), ::testing::Eq(10));
+  EXPECT_THAT(result.structure.roots, ::testing::ElementsAre(std::vector<int>{1}));
+}
+
+TEST(scanner_budget_tests, exhausted_step_budget_yields_partial_structure)
+{
+  std::vector<ClauseHandle> const input_clauses = create_and_gate_chain(10);
+
+  gate_structure<ClauseHandle> const complete =
+      scan_gates<ClauseHandle>(input_clauses.begin(), input_clauses.end());
+  ASSERT_THAT(complete.gates.size(), ::testing::Eq(10));
+
+  for (occurrence_list_layout layout :
+       {occurrence_list_layout::per_literal, occurrence_list_layout::compressed}) {
+    scan_options options;
+    options.layout = layout;
+    options.max_steps = 7;
+
+    scan_result<ClauseHandle> const result =
+        scan_gates<ClauseHandle>(input_clauses.begin(), input_clauses.end(), options);
+
+    EXPECT_FALSE(result.is_finished);
+    EXPECT_THAT(result.structure.roots, ::testing::ElementsAre(std::vector<int>{1}));
+
+    // Each round of the search tries both inputs of the last found gate,
+    // so 7 steps suffice for recovering the first 4 gates
+    ASSERT_THAT(result.structure.gates.size(), ::testing::Eq(4));
+    for (std::size_t idx = 0; idx < result.structure.gates.size(); ++idx) {
+      EXPECT_THAT(result.structure.gates[idx], ::testing::Eq(complete.gates[idx]));
+    }
+  }
+}
+
+TEST(scanner_budget_tests, flat_scan_applies_options)
+{
+  std::vector<ClauseHandle> const input_clauses = create_and_gate_chain(10);
+
+  for (occurrence_list_layout layout :
+       {occurrence_list_layout::per_literal, occurrence_list_layout::compressed}) {
+    scan_options options;
+    options.layout = layout;
+    options.max_steps = 7;
+
+    scan_result<ClauseHandle> const expected =
+        scan_gates<ClauseHandle>(input_clauses.begin(), input_clauses.end(), options);
+    scan_result<ClauseHandle, flat_gate_structure<ClauseHandle>> const result =
+        scan_gates_flat<ClauseHandle>(input_clauses.begin(), input_clauses.end(), options);
+
+    EXPECT_FALSE(result.is_finished);
+    EXPECT_THAT(result.structure.gates.size(), ::testing::Eq(4));
+    EXPECT_THAT(to_gate_structure(result.structure), ::testing::Eq(expected.structure));
+  }
+}
+
+TEST(scanner_budget_tests, zero_step_budget_yields_empty_structure)
+{
+  std::vector<ClauseHandle> const input_clauses = create_and_gate_chain(3);
+
+  scan_options options;
+  options.max_steps = 0;
+
+  scan_result<ClauseHandle> const result =
+      scan_gates<ClauseHandle>(input_clauses.begin(), input_clauses.end(), options);
+
+  EXPECT_FALSE(result.is_finished);
+  EXPECT_TRUE(result.structure.gates.empty());
+  EXPECT_TRUE(result.structure.roots.empty());
+}
+
+TEST(scanner_budget_tests, scan_stops_when_deadline_has_passed)
+{
+  std::vector<ClauseHandle> const input_clauses = create_and_gate_chain(3);
+
+  scan_options options;
+  options.deadline = std::chrono::steady_clock::now() - std::chrono::seconds{1};
+
+  scan_result<ClauseHandle> const result =
+      scan_gates<ClauseHandle>(input_clauses.begin(), input_clauses.end(), options);
+
+  EXPECT_FALSE(result.is_finished);
+  EXPECT_TRUE(result.structure.gates.empty());
+}
+
+TEST(scanner_budget_tests, scan_stops_when_cancelled)
+{
+  std::vector<ClauseHandle> const input_clauses = create_and_gate_chain(200);
+
+  int num_calls = 0;
+  scan_options options;
+  options.is_cancelled = [&num_calls]() { return ++num_calls > 1; };
+
+  scan_result<ClauseHandle> const result =
+      scan_gates<ClauseHandle>(input_clauses.begin(), input_clauses.end(), options);
+
+  EXPECT_FALSE(result.is_finished);
+  EXPECT_THAT(num_calls, ::testing::Eq(2));
+  EXPECT_FALSE(result.structure.gates.empty());
+  EXPECT_THAT(result.structure.gates.size(), ::testing::Lt(200));
+}
+
+TEST(scanner_root_selection_tests, gates_are_found_from_non_unary_root)
+{
+  // Miter-like structure: the outputs of two AND gates are joined in a single clause
+  gate<ClauseHandle> const lhs = monotonic(and_gate({3, 4}, 1), encoding::full);
+  gate<ClauseHandle> const rhs = monotonic(and_gate({5, 6}, 2), encoding::full);
+
+  std::vector<ClauseHandle> input_clauses = lhs.clauses;
+  input_clauses.insert(input_clauses.end(), rhs.clauses.begin(), rhs.clauses.end());
+  input_clauses.emplace_back(std::make_shared<Clause>(Clause{1, 2}));
+
+  for (occurrence_list_layout layout :
+       {occurrence_list_layout::per_literal, occurrence_list_layout::compressed}) {
+    scan_options options;
+    options.layout = layout;
+
+    scan_result<ClauseHandle> const unaries_only =
+        scan_gates<ClauseHandle>(input_clauses.begin(), input_clauses.end(), options);
+    EXPECT_TRUE(unaries_only.structure.gates.empty());
+    EXPECT_TRUE(unaries_only.structure.roots.empty());
+
+    options.roots = root_selection::unaries_and_clauses;
+    scan_result<ClauseHandle> const result =
+        scan_gates<ClauseHandle>(input_clauses.begin(), input_clauses.end(), options);
+
+    EXPECT_TRUE(result.is_finished);
+    EXPECT_THAT(result.structure.roots, ::testing::ElementsAre(std::vector<int>{1, 2}));
+    EXPECT_THAT(result.structure.gates,
+                ::testing::UnorderedElementsAre(lhs, rhs));
+  }
+}
+
+TEST(scanner_root_selection_tests, root_clause_selection_consumes_budget)
+{
+  gate<ClauseHandle> const lhs = monotonic(and_gate({3, 4}, 1), encoding::full);
+  gate<ClauseHandle> const rhs = monotonic(and_gate({5, 6}, 2), encoding::full);
+
+  std::vector<ClauseHandle> input_clauses = lhs.clauses;
+  input_clauses.insert(input_clauses.end(), rhs.clauses.begin(), rhs.clauses.end());
+  input_clauses.emplace_back(std::make_shared<Clause>(Clause{1, 2}));
+
+  for (occurrence_list_layout layout :
+       {occurrence_list_layout::per_literal, occurrence_list_layout::compressed}) {
+    scan_options options;
+    options.layout = layout;
+    options.roots = root_selection::unaries_and_clauses;
+
+    // Checking each of the 7 clauses for being a root candidate takes a step
+    options.max_steps = 6;
+
+    scan_result<ClauseHandle> const result =
+        scan_gates<ClauseHandle>(input_clauses.begin(), input_clauses.end(), options);
+
+    EXPECT_FALSE(result.is_finished);
+    EXPECT_TRUE(result.structure.gates.empty());
+    EXPECT_TRUE(result.structure.roots.empty());
+  }
+}
+
+TEST(scanner_root_selection_tests, clauses_without_gates_are_no_roots)
+{
+  // After recovering the XOR gate, (2, 4) is a root candidate, but 2 and 4
+  // are used non-monotonically and their clauses do not fully define them
+  gate<ClauseHandle> const xor_root = monotonic(xor_gate(2, 4, 1), encoding::full);
+  std::vector<ClauseHandle> input_clauses = xor_root.clauses;
+  for (Clause const& clause : ClauseList{{1}, {2, 4}, {-2, 5}, {-4, 6}}) {
+    input_clauses.emplace_back(std::make_shared<Clause>(clause));
+  }
+
+  for (occurrence_list_layout layout :
+       {occurrence_list_layout::per_literal, occurrence_list_layout::compressed}) {
+    scan_options options;
+    options.layout = layout;
+    options.roots = root_selection::unaries_and_clauses;
+
+    scan_result<ClauseHandle> const result =
+        scan_gates<ClauseHandle>(input_clauses.begin(), input_clauses.end(), options);
+
+    EXPECT_TRUE(result.is_finished);
+    EXPECT_THAT(result.structure.roots, ::testing::ElementsAre(std::vector<int>{1}));
+    EXPECT_THAT(result.structure.gates, ::testing::ElementsAre(xor_root));
+  }
+}
+
+namespace {
+// Gates encoding the same constraints. Unlike operator==, this does not depend
+// on the choice of the output, since e.g. the output of a XOR gate whose inputs
+// are not used elsewhere can't be distinguished from its inputs.
+auto have_same_clauses(gate<arena_clause> const& lhs, gate<arena_clause> const& rhs) -> bool
+{
+  return lhs.is_nested_monotonically == rhs.is_nested_monotonically &&
+         lhs.clauses.size() == rhs.clauses.size() &&
+         std::is_permutation(lhs.clauses.begin(), lhs.clauses.end(), rhs.clauses.begin());
+}
+}
+
+TEST(scanner_generated_circuit_tests, expected_structure_is_recovered)
+{
+  using circuit_factory = std::function<generated_circuit(encoding)>;
+
+  std::vector<std::pair<std::string, circuit_factory>> const circuits = {
+      {"multiplier_miter", [](encoding enc) { return multiplier_miter(4, enc); }},
+      {"adder_chain", [](encoding enc) { return adder_chain(5, 3, enc); }},
+      {"xor_tree", [](encoding enc) { return xor_tree(11, enc); }},
+      {"mux_tree", [](encoding enc) { return mux_tree(3, enc); }},
+      {"cardinality_network", [](encoding enc) { return cardinality_network(7, 3, enc); }},
+      {"random_aig", [](encoding enc) { return random_aig(200, 10, 1, enc); }}};
+
+  for (auto const& circuit : circuits) {
+    for (encoding enc : {encoding::full, encoding::opt}) {
+      SCOPED_TRACE(circuit.first + (enc == encoding::full ? " (full)" : " (opt)"));
+
+      generated_circuit const generated = circuit.second(enc);
+      ASSERT_FALSE(generated.expected.gates.empty());
+
+      for (occurrence_list_layout layout :
+           {occurrence_list_layout::per_literal, occurrence_list_layout::compressed}) {
+        gate_structure<arena_clause> const result = scan_gates<arena_clause>(
+            generated.clauses.begin(), generated.clauses.end(), layout);
+
+        EXPECT_THAT(result.roots, ::testing::Eq(generated.expected.roots));
+        ASSERT_THAT(result.gates.size(), ::testing::Eq(generated.expected.gates.size()));
+        EXPECT_TRUE(std::is_permutation(result.gates.begin(),
+                                        result.gates.end(),
+                                        generated.expected.gates.begin(),
+                                        have_same_clauses));
+      }
+    }
+  }
+}
+
+TEST(scanner_lit_traits_tests, gates_with_unsigned_literals_are_found)
+{
+  generated_circuit const generated = random_aig(50, 5, 1, encoding::full);
+
+  // Converting the clauses to 2*v + sign literals
+  auto to_unsigned = [](int32_t literal) -> uint32_t {
+    return detail::to_lit<uint32_t>(detail::to_var_index(literal), literal > 0);
+  };
+
+  std::vector<std::vector<uint32_t>> clauses;
+  for (arena_clause clause : generated.clauses) {
+    clauses.emplace_back();
+    std::transform(clause.begin(), clause.end(), std::back_inserter(clauses.back()), to_unsigned);
+  }
+
+  std::vector<std::vector<uint32_t> const*> handles;
+  for (std::vector<uint32_t> const& clause : clauses) {
+    handles.push_back(&clause);
+  }
+
+  gate_structure<arena_clause> const expected =
+      scan_gates<arena_clause>(generated.clauses.begin(), generated.clauses.end());
+  gate_structure<std::vector<uint32_t> const*> const result =
+      scan_gates<std::vector<uint32_t> const*>(handles.begin(), handles.end());
+
+  ASSERT_THAT(result.gates.size(), ::testing::Eq(expected.gates.size()));
+  ASSERT_THAT(result.roots.size(), ::testing::Eq(expected.roots.size()));
+  EXPECT_THAT(result.roots[0], ::testing::ElementsAre(to_unsigned(expected.roots[0][0])));
+
+  for (std::size_t index = 0; index < result.gates.size(); ++index) {
+    EXPECT_THAT(result.gates[index].output,
+                ::testing::Eq(to_unsigned(expected.gates[index].output)));
+    EXPECT_THAT(result.gates[index].clauses.size(),
+                ::testing::Eq(expected.gates[index].clauses.size()));
+  }
+}
+
+TEST(scanner_stats_tests, stats_are_collected)
+{
+  std::vector<ClauseHandle> input_clauses = create_and_gate_chain(10);
+
+  // Adding a non-gate to the chain: (11, 1012, 1013) is not blocked
+  input_clauses.emplace_back(std::make_shared<Clause>(Clause{11, 1012, 1013}));
+  input_clauses.emplace_back(std::make_shared<Clause>(Clause{-11, 1012}));
+  input_clauses.emplace_back(std::make_shared<Clause>(Clause{-11, -1012}));
+
+  for (occurrence_list_layout layout :
+       {occurrence_list_layout::per_literal, occurrence_list_layout::compressed}) {
+    scan_stats stats;
+
+    scan_options options;
+    options.layout = layout;
+    options.stats = &stats;
+
+    scan_result<ClauseHandle> const result =
+        scan_gates<ClauseHandle>(input_clauses.begin(), input_clauses.end(), options);
+
+    EXPECT_TRUE(result.is_finished);
+    EXPECT_THAT(result.structure.gates.size(), ::testing::Eq(10));
+
+    // 1 candidate in the first round, 2 candidates in each other round
+    EXPECT_THAT(stats.num_try_get_gate_calls, ::testing::Eq(21));
+    EXPECT_THAT(stats.num_failed_empty_fwd, ::testing::Eq(10));
+    EXPECT_THAT(stats.num_failed_blockedness, ::testing::Eq(1));
+    EXPECT_THAT(stats.num_failed_input_mismatch + stats.num_failed_pattern, ::testing::Eq(0));
+    EXPECT_THAT(stats.num_bfs_rounds_per_root, ::testing::ElementsAre(11));
+
+    EXPECT_THAT(stats.num_erase_batches, ::testing::Gt(0));
+    EXPECT_THAT(stats.max_erase_batch_size, ::testing::Gt(0));
+    EXPECT_THAT(stats.total_erase_batch_size, ::testing::Ge(stats.max_erase_batch_size));
+  }
+}
 }